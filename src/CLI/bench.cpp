@@ -0,0 +1,453 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Distributed under the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file bench.cpp
+//! \brief A benchmark driver that times a set of scenarios with run-epanet3.
+//!
+//! Each scenario listed in a scenario file is run a fixed number of times
+//! as a separate run-epanet3 process, optionally with a shortened duration.
+//! The median wall time, the average number of trials per hydraulic period,
+//! the number of head loss (error norm) evaluations and the peak resident
+//! memory of each scenario are compared against a stored baseline, and the
+//! program returns a non-zero exit code if any of them regress by more than
+//! a given percentage.
+//!
+//! Syntax:  run-bench epanet3Exe scenarioFile baselineFile
+//!                    [-repeat n] [-tolerance pct] [-update]
+//!
+//! Each line of the scenario file contains a scenario name, the name of its
+//! input file (relative to the scenario file) and a duration in hours:minutes
+//! or * to use the input file's own duration. Lines beginning with ; are
+//! comments. The -update flag saves the results as the new baseline.
+//! Since timings depend on the machine, each machine must first create its
+//! own baseline with -update; comparing against a baseline that is missing,
+//! unreadable or lacks one of the scenarios is treated as a failure.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static const char* statsFileName = "bench_stats.csv";
+static const char* resultsFileName = "bench_results.csv";
+
+struct Scenario
+{
+    string name;
+    string inpFile;
+    string duration;
+};
+
+struct BenchResult
+{
+    double wallTime;           // median wall time (sec)
+    double trialsPerPeriod;    // average Newton trials per hydraulic period
+    double hLossEvals;         // head loss (error norm) evaluations
+    double peakMemory;         // peak resident memory (KB)
+};
+
+static const int MetricCount = 4;
+static const char* metricNames[] =
+    {"wall_time", "trials_per_period", "hloss_evals", "peak_rss_kb"};
+
+//-----------------------------------------------------------------------------
+
+static string upperCase(const string& s)
+{
+    string u = s;
+    for (char& c : u) c = (char)toupper((unsigned char)c);
+    return u;
+}
+
+//-----------------------------------------------------------------------------
+
+static double metric(const BenchResult& r, int i)
+{
+    switch (i)
+    {
+    case 0: return r.wallTime;
+    case 1: return r.trialsPerPeriod;
+    case 2: return r.hLossEvals;
+    case 3: return r.peakMemory;
+    }
+    return 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Read the list of scenarios to run.
+
+static bool readScenarios(const string& fname, vector<Scenario>& scenarios)
+{
+    ifstream in(fname);
+    if ( !in.is_open() ) return false;
+
+    // ... input file names are relative to the scenario file's directory
+    string dir = "";
+    size_t pos = fname.find_last_of("/\\");
+    if ( pos != string::npos ) dir = fname.substr(0, pos + 1);
+
+    string line;
+    while ( getline(in, line) )
+    {
+        istringstream ss(line);
+        Scenario s;
+        if ( !(ss >> s.name) || s.name[0] == ';' ) continue;
+        if ( !(ss >> s.inpFile) ) continue;
+        if ( !(ss >> s.duration) ) s.duration = "*";
+        s.inpFile = dir + s.inpFile;
+        scenarios.push_back(s);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write a copy of a scenario's input file with its duration replaced and
+//  with the solver statistics saved to file.
+
+static bool writeBenchInput(const Scenario& s, const string& fname)
+{
+    ifstream in(s.inpFile);
+    if ( !in.is_open() ) return false;
+    ofstream out(fname);
+    if ( !out.is_open() ) return false;
+
+    string line;
+    string section = "";
+    bool hasOptions = false;
+    while ( getline(in, line) )
+    {
+        string token;
+        istringstream ss(line);
+        ss >> token;
+        token = upperCase(token);
+        if ( token.size() > 0 && token[0] == '[' ) section = token;
+
+        // ... skip any existing statistics file option
+        if ( section == "[OPTIONS]" && token == "STATISTICS_FILE" ) continue;
+
+        // ... replace the simulation duration
+        if ( section == "[TIMES]" && token == "DURATION" && s.duration != "*" )
+        {
+            out << " Duration  " << s.duration << "\n";
+            continue;
+        }
+        out << line << "\n";
+
+        if ( token == "[OPTIONS]" )
+        {
+            out << " STATISTICS_FILE  " << statsFileName << "\n";
+            hasOptions = true;
+        }
+    }
+    if ( !hasOptions )
+    {
+        out << "\n[OPTIONS]\n STATISTICS_FILE  " << statsFileName << "\n";
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Read the solver statistics written by a run of run-epanet3.
+
+static bool readStats(map<string, double>& stats)
+{
+    ifstream in(statsFileName);
+    if ( !in.is_open() ) return false;
+    string line;
+    while ( getline(in, line) )
+    {
+        size_t pos = line.find(',');
+        if ( pos == string::npos ) continue;
+        stats[line.substr(0, pos)] = atof(line.substr(pos + 1).c_str());
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Run run-epanet3 as a separate process, returning its peak resident
+//  memory in KB (or -1 if the process could not be run).
+
+static double runProcess(const string& exe, const string& inpFile,
+                         const string& rptFile)
+{
+#ifdef _WIN32
+    string cmd = "\"" + exe + "\" \"" + inpFile + "\" \"" + rptFile + "\"";
+    vector<char> cmdLine(cmd.begin(), cmd.end());
+    cmdLine.push_back(0);
+
+    STARTUPINFOA si;
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    ZeroMemory(&pi, sizeof(pi));
+    if ( !CreateProcessA(NULL, &cmdLine[0], NULL, NULL, FALSE,
+                         CREATE_NO_WINDOW, NULL, NULL, &si, &pi) ) return -1.0;
+    WaitForSingleObject(pi.hProcess, INFINITE);
+
+    PROCESS_MEMORY_COUNTERS pmc;
+    double peak = 0.0;
+    if ( GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof(pmc)) )
+    {
+        peak = pmc.PeakWorkingSetSize / 1024.0;
+    }
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return peak;
+#else
+    cout.flush();
+    fflush(stdout);
+    pid_t pid = fork();
+    if ( pid < 0 ) return -1.0;
+    if ( pid == 0 )
+    {
+        // ... discard the progress messages written to the console
+        if ( freopen("/dev/null", "w", stdout) == nullptr ) _exit(127);
+        execl(exe.c_str(), exe.c_str(), inpFile.c_str(), rptFile.c_str(),
+              (char*)nullptr);
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    if ( wait4(pid, &status, 0, &usage) < 0 ) return -1.0;
+    if ( !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) return -1.0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024.0;     // reported in bytes
+#else
+    return (double)usage.ru_maxrss;      // reported in KB
+#endif
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+//  Run a scenario a number of times and collect its performance measures.
+
+static bool runScenario(const string& exe, const Scenario& s, int repeats,
+                        BenchResult& result)
+{
+    string inpFile = s.name + ".inp";
+    string rptFile = s.name + ".rpt";
+    if ( !writeBenchInput(s, inpFile) )
+    {
+        cout << "\n  cannot open input file " << s.inpFile;
+        return false;
+    }
+
+    vector<double> times;
+    map<string, double> stats;
+    result.peakMemory = 0.0;
+    for (int i = 0; i < repeats; i++)
+    {
+        remove(statsFileName);
+        auto start = chrono::steady_clock::now();
+        double peak = runProcess(exe, inpFile, rptFile);
+        auto end = chrono::steady_clock::now();
+        if ( peak < 0.0 || !readStats(stats) )
+        {
+            cout << "\n  scenario " << s.name << " failed to run";
+            return false;
+        }
+        times.push_back(chrono::duration<double>(end - start).count());
+        result.peakMemory = max(result.peakMemory, peak);
+    }
+
+    sort(times.begin(), times.end());
+    result.wallTime = times[times.size() / 2];
+    result.trialsPerPeriod = 0.0;
+    if ( stats["periods"] > 0.0 )
+    {
+        result.trialsPerPeriod = stats["trials"] / stats["periods"];
+    }
+    result.hLossEvals = stats["error_norm_evals"];
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool readBaseline(const string& fname, map<string, BenchResult>& baseline)
+{
+    ifstream in(fname);
+    if ( !in.is_open() ) return false;
+    string line;
+    getline(in, line);   // header
+    while ( getline(in, line) )
+    {
+        replace(line.begin(), line.end(), ',', ' ');
+        istringstream ss(line);
+        string name;
+        BenchResult r;
+        if ( ss >> name >> r.wallTime >> r.trialsPerPeriod >> r.hLossEvals >>
+             r.peakMemory ) baseline[name] = r;
+    }
+    return baseline.size() > 0;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool writeResults(const string& fname, const vector<Scenario>& scenarios,
+                         map<string, BenchResult>& results)
+{
+    ofstream out(fname);
+    if ( !out.is_open() ) return false;
+    out << "scenario";
+    for (int i = 0; i < MetricCount; i++) out << "," << metricNames[i];
+    out << "\n";
+    for (const Scenario& s : scenarios)
+    {
+        if ( results.count(s.name) == 0 ) continue;
+        out << s.name;
+        for (int i = 0; i < MetricCount; i++)
+        {
+            out << "," << metric(results[s.name], i);
+        }
+        out << "\n";
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    //... check number of command line arguments
+    if (argc < 4)
+    {
+        cout << "\nCorrect syntax is: run-bench epanet3Exe scenarioFile "
+                "baselineFile [-repeat n] [-tolerance pct] [-update]\n";
+        return 1;
+    }
+
+    string exe = argv[1];
+    string scenarioFile = argv[2];
+    string baselineFile = argv[3];
+    int repeats = 3;
+    double tolerance = 10.0;
+    bool update = false;
+    for (int i = 4; i < argc; i++)
+    {
+        string arg = argv[i];
+        if ( arg == "-repeat" && i + 1 < argc ) repeats = atoi(argv[++i]);
+        else if ( arg == "-tolerance" && i + 1 < argc ) tolerance = atof(argv[++i]);
+        else if ( arg == "-update" ) update = true;
+    }
+    repeats = max(repeats, 1);
+
+    vector<Scenario> scenarios;
+    if ( !readScenarios(scenarioFile, scenarios) )
+    {
+        cout << "\nCannot open scenario file " << scenarioFile << "\n";
+        return 1;
+    }
+
+    map<string, BenchResult> baseline;
+    if ( !update && !readBaseline(baselineFile, baseline) )
+    {
+        cout << "\nCannot read a baseline from " << baselineFile << "\n"
+             << "Create one for this machine with the bench-baseline target"
+             << " (or the -update flag).\n";
+        return 1;
+    }
+
+    // ... run each scenario
+
+    cout << "\n... EPANET benchmark (" << repeats << " repetitions, "
+         << tolerance << "% tolerance)\n";
+    cout << "\n  " << left << setw(34) << "Scenario" << right;
+    for (int i = 0; i < MetricCount; i++) cout << setw(20) << metricNames[i];
+    cout << "\n";
+
+    map<string, BenchResult> results;
+    int failures = 0;
+    int missing = 0;
+    int regressions = 0;
+    for (const Scenario& s : scenarios)
+    {
+        BenchResult r;
+        if ( !runScenario(exe, s, repeats, r) )
+        {
+            failures++;
+            continue;
+        }
+        results[s.name] = r;
+
+        cout << "\n  " << left << setw(34) << s.name << right;
+        cout << fixed << setprecision(3);
+        for (int i = 0; i < MetricCount; i++) cout << setw(20) << metric(r, i);
+        cout.unsetf(ios_base::floatfield);
+
+        // ... compare against the baseline
+
+        if ( update ) continue;
+        if ( baseline.count(s.name) == 0 )
+        {
+            cout << "\n  *** NOT IN BASELINE";
+            missing++;
+            continue;
+        }
+        BenchResult& b = baseline[s.name];
+        cout << "\n  " << left << setw(34) << "  change (%)" << right;
+        cout << fixed << setprecision(1);
+        string regressed = "";
+        for (int i = 0; i < MetricCount; i++)
+        {
+            double base = metric(b, i);
+            double change = 0.0;
+            if ( base > 0.0 ) change = 100.0 * (metric(r, i) - base) / base;
+            cout << setw(20) << change;
+            if ( change > tolerance ) regressed += string(" ") + metricNames[i];
+        }
+        cout.unsetf(ios_base::floatfield);
+        if ( regressed.size() > 0 )
+        {
+            cout << "\n  *** REGRESSION in" << regressed;
+            regressions++;
+        }
+    }
+    cout << "\n";
+
+    // ... save results
+
+    writeResults(resultsFileName, scenarios, results);
+    if ( update )
+    {
+        if ( failures > 0 || !writeResults(baselineFile, scenarios, results) )
+        {
+            cout << "\n  Baseline not saved.\n";
+            return 1;
+        }
+        cout << "\n  Baseline saved to " << baselineFile << "\n";
+    }
+
+    if ( failures > 0 ) cout << "\n  " << failures << " scenario(s) failed to run.\n";
+    if ( missing > 0 ) cout << "\n  " << missing << " scenario(s) not in baseline.\n";
+    if ( regressions > 0 ) cout << "\n  " << regressions << " scenario(s) regressed.\n";
+    return (failures > 0 || missing > 0 || regressions > 0) ? 1 : 0;
+}
@@ -12,6 +12,8 @@
 #define CONSTANTS_H_
 
 const int    VERSION = 30000;          //!< current version
+const int    SPARSE_VERSION = 30001;   //!< version of output files with a sparse layout
+const int    SPECIES_VERSION = 30002;  //!< version of sparse output files with species
 const int    MAGICNUMBER = 1236385461; //!< magic number
 const double MISSING = -999999999.9;   //!< missing value
 
@@ -22,6 +22,7 @@
 #include "Elements/tank.h"
 #include "Elements/link.h"
 #include "Elements/pipe.h"
+#include "Elements/pump.h"
 #include "Elements/valve.h"
 #include "Elements/curve.h"
 #include "Elements/pattern.h"
@@ -34,6 +35,8 @@ using namespace std;
 int getTankValue(int param, Node* node, double* value, Network* nw);
 int getQualSourceValue(int param, Node* node, double *value, Network* nw);
 int getPipeValue(int param, Link* link, double* value, Network* nw);
+int getValveValue(int param, Link* link, double* value);
+int setValveValue(int param, Link* link, double value);
 
 //-----------------------------------------------------------------------------
 
@@ -48,13 +51,15 @@ int DataManager::getCount(int element, int* count, Network* nw)
     case EN_PATCOUNT:     *count = nw->count(Element::PATTERN); break;
     case EN_CURVECOUNT:   *count = nw->count(Element::CURVE); break;
     case EN_CONTROLCOUNT: *count = nw->count(Element::CONTROL); break;
-    case EN_RULECOUNT:    break;
+    case EN_RULECOUNT:    *count = nw->count(Element::RULE); break;
     case EN_TANKCOUNT:
-        for (Node* node : nw->nodes) if ( node->type() == Node::TANK ) (*count)++;
+        *count = (int)nw->tanks.size();
         break;
     case EN_RESVCOUNT:
-        for (Node* node : nw->nodes) if ( node->type() == Node::RESERVOIR ) (*count)++;
-         break;
+        *count = (int)nw->reservoirs.size();
+        break;
+    case EN_ZONECOUNT:    *count = nw->waterBalance.zoneCount(); break;
+    case EN_SPECIESCOUNT: *count = nw->speciesModel.width(); break;
     default: err = 203;
     }
     return err;
@@ -265,7 +270,9 @@ int DataManager::getLinkValue(int index, int param, double* value, Network* nw)
     case EN_LEAKAGE:
         *value = link->leakage * nw->ucf(Units::FLOW);
         break;
-    default: return getPipeValue(param, link, value, nw);
+    default:
+        if ( param >= EN_PMTYPE ) return getValveValue(param, link, value);
+        return getPipeValue(param, link, value, nw);
     }
     return 0;
 }
@@ -281,7 +288,7 @@ int DataManager::setLinkValue(int index, int param, double value, Network* nw)
 	case EN_DIAMETER:
 		link->diameter = value / nw->ucf(Units::DIAMETER);
 		link->setLossFactor();
-		link->setResistance(nw);
+		if (nw->headLossModel) link->setResistance(nw);   // else set on init
 		break;
 	case EN_MINORLOSS:
 		link->lossCoeff = value;
@@ -299,12 +306,140 @@ int DataManager::setLinkValue(int index, int param, double value, Network* nw)
 	case EN_STATUS:
 		link->status = value;
 		break;
+	case EN_SETTING:
+		link->setting = link->convertSetting(nw, value);
+		if (link->type() == Link::PUMP) static_cast<Pump*>(link)->speed = value;
+		break;
 	case EN_ENERGY:
 		break;                         // TO BE ADDED
+	default:
+		if (param >= EN_PMTYPE) return setValveValue(param, link, value);
 	}
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+
+int DataManager::getZoneIndex(char* name, int* index, Network* nw)
+{
+    *index = nw->waterBalance.zoneIndex(name);
+    if ( *index < 0 ) return 205;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int DataManager::getZoneId(int index, char* id, Network* nw)
+{
+    if ( index < 0 || index >= nw->waterBalance.zoneCount() )
+    {
+        strcpy(id, "");
+        return 205;
+    }
+    strcpy(id, nw->waterBalance.zoneNames[index].c_str());
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Note: an index of -1 retrieves the water balance for the whole network.
+
+int DataManager::getZoneValue(int index, int param, double* value, Network* nw)
+{
+    *value = 0.0;
+    if ( index < -1 || index >= nw->waterBalance.zoneCount() ) return 205;
+    int n = WaterBalance::MAX_COMPONENTS;
+    if ( param >= EN_SUPPLYVOL && param < EN_SUPPLYVOL + n )
+    {
+        *value = nw->waterBalance.volume(index, param - EN_SUPPLYVOL) *
+                 nw->ucf(Units::VOLUME);
+    }
+    else if ( param >= EN_SUPPLYRATE && param < EN_SUPPLYRATE + n )
+    {
+        *value = nw->waterBalance.rate(index, param - EN_SUPPLYRATE) *
+                 nw->ucf(Units::FLOW);
+    }
+    else return 203;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Note: species 0 is the constituent of the network's quality model.
+
+int DataManager::getSpeciesIndex(char* name, int* index, Network* nw)
+{
+    *index = nw->speciesModel.indexOf(name, nw);
+    if ( *index < 0 ) return 205;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int DataManager::getSpeciesId(int index, char* id, Network* nw)
+{
+    if ( index < 0 || index >= nw->speciesModel.width() )
+    {
+        strcpy(id, "");
+        return 205;
+    }
+    strcpy(id, nw->speciesModel.name(index, nw).c_str());
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int DataManager::getNodeSpecies(int index, int species, double* value, Network* nw)
+{
+    *value = 0.0;
+    if ( index < 0 || index >= nw->count(Element::NODE) ) return 205;
+    if ( species < 0 || species >= nw->speciesModel.width() ) return 205;
+    if ( species == 0 ) *value = nw->node(index)->quality;
+    else *value = nw->speciesModel.nodeQual(index, species);
+    *value *= nw->ucf(Units::CONCEN);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int DataManager::getLinkSpecies(int index, int species, double* value, Network* nw)
+{
+    *value = 0.0;
+    if ( index < 0 || index >= nw->count(Element::LINK) ) return 205;
+    if ( species < 0 || species >= nw->speciesModel.width() ) return 205;
+    if ( species == 0 ) *value = nw->link(index)->quality;
+    else *value = nw->speciesModel.linkQual(index, species);
+    *value *= nw->ucf(Units::CONCEN);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Times are in seconds; the remaining statistics are counts.
+
+int DataManager::getStatistics(int param, double* value, Network* nw)
+{
+    *value = 0.0;
+    int n = SolverStats::MAX_PHASES;
+    if ( param >= EN_ASSEMBLYTIME && param < EN_ASSEMBLYTIME + n )
+    {
+        *value = nw->solverStats.time(param - EN_ASSEMBLYTIME);
+    }
+    else if ( param >= EN_HYDPERIODS &&
+              param < EN_HYDPERIODS + SolverStats::MAX_COUNTERS )
+    {
+        *value = nw->solverStats.counter(param - EN_HYDPERIODS);
+    }
+    else if ( param >= EN_NETBYTESLIVE && param <= EN_SEGBLOCKS )
+    {
+        int m = SolverStats::MAX_POOL_MEASURES;
+        int i = param - EN_NETBYTESLIVE;
+        *value = nw->solverStats.poolStat(i / m, i % m);
+    }
+    else return 203;
+    return 0;
+}
+
 //-----------------------------------------------------------------------------
 int getTankValue(int param, Node* node, double* value, Network* nw)
 {
@@ -427,3 +562,51 @@ int getPipeValue(int param, Link* link, double* value, Network* nw)
     }
     return 0;
 }
+
+//-----------------------------------------------------------------------------
+
+//  Pressure management parameters of a valve are kept in user units.
+
+int getValveValue(int param, Link* link, double* value)
+{
+    *value = 0.0;
+    if ( link->type() != Link::VALVE ) return 0;
+    Valve* valve = static_cast<Valve*>(link);
+    switch (param)
+    {
+    case EN_PMTYPE:       *value = valve->presManagType; break;
+    case EN_PMFIXEDPRES:  *value = valve->fixedOutletPressure; break;
+    case EN_PMDAYPRES:    *value = valve->dayPressure; break;
+    case EN_PMNIGHTPRES:  *value = valve->nightPressure; break;
+    case EN_PMCOEFFA:     *value = valve->a_FM; break;
+    case EN_PMCOEFFB:     *value = valve->b_FM; break;
+    case EN_PMCOEFFC:     *value = valve->c_FM; break;
+    case EN_PMREMOTEPRES: *value = valve->rnmPressure; break;
+    default: return 203;
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int setValveValue(int param, Link* link, double value)
+{
+    if ( link->type() != Link::VALVE ) return 0;
+    Valve* valve = static_cast<Valve*>(link);
+    switch (param)
+    {
+    case EN_PMTYPE:
+        if ( value < Valve::FO || value > Valve::RNM ) return 203;
+        valve->presManagType = (Valve::PresManagType)(int)value;
+        break;
+    case EN_PMFIXEDPRES:  valve->fixedOutletPressure = value; break;
+    case EN_PMDAYPRES:    valve->dayPressure = value; break;
+    case EN_PMNIGHTPRES:  valve->nightPressure = value; break;
+    case EN_PMCOEFFA:     valve->a_FM = value; break;
+    case EN_PMCOEFFB:     valve->b_FM = value; break;
+    case EN_PMCOEFFC:     valve->c_FM = value; break;
+    case EN_PMREMOTEPRES: valve->rnmPressure = value; break;
+    default: return 203;
+    }
+    return 0;
+}
@@ -29,6 +29,17 @@ struct DataManager
     static int getLinkNodes(int index, int* fromNode, int* toNode, Network* nw);
     static int getLinkValue(int index, int param, double* value, Network* nw);
 	static int setLinkValue(int index, int param, double v, Network* nw);
+
+    static int getZoneIndex(char* name, int* index, Network* nw);
+    static int getZoneId(int index, char* id, Network* nw);
+    static int getZoneValue(int index, int param, double* value, Network* nw);
+
+    static int getSpeciesIndex(char* name, int* index, Network* nw);
+    static int getSpeciesId(int index, char* id, Network* nw);
+    static int getNodeSpecies(int index, int species, double* value, Network* nw);
+    static int getLinkSpecies(int index, int species, double* value, Network* nw);
+
+    static int getStatistics(int param, double* value, Network* nw);
 };
 
 #endif // DATAMANAGER_H_
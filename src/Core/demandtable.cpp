@@ -0,0 +1,123 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ ////////////////////////////////////////////////
+ //  Implementation of the DemandTable class.  //
+ ////////////////////////////////////////////////
+
+#include "demandtable.h"
+#include "Core/network.h"
+#include "Elements/junction.h"
+#include "Elements/pattern.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+DemandTable::DemandTable() :
+    lastMultiplier(0.0),
+    isCurrent(false)
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Compile the demand categories of all junctions into a sparse matrix
+//  (must be called after the network's units have been converted).
+
+void DemandTable::compile(Network* nw)
+{
+    junctions.clear();
+    rowStart.clear();
+    column.clear();
+    baseDemand.clear();
+
+    // ... column 0 holds demands that use the global demand pattern
+
+    patterns.assign(1, nullptr);
+    vector<int> patternColumn(nw->patterns.size(), -1);
+
+    for (Node* node : nw->nodes)
+    {
+        if ( node->type() != Node::JUNCTION ) continue;
+        Junction* junc = static_cast<Junction*>(node);
+        junctions.push_back(junc);
+        rowStart.push_back(column.size());
+
+        for (Demand& demand : junc->demands)
+        {
+            if ( demand.baseDemand == 0.0 ) continue;
+
+            // ... find the column assigned to the demand's pattern
+
+            int col = 0;
+            if ( demand.timePattern )
+            {
+                int p = demand.timePattern->index;
+                if ( patternColumn[p] < 0 )
+                {
+                    patternColumn[p] = patterns.size();
+                    patterns.push_back(demand.timePattern);
+                }
+                col = patternColumn[p];
+            }
+            column.push_back(col);
+            baseDemand.push_back(demand.baseDemand);
+        }
+    }
+    rowStart.push_back(column.size());
+    factors.assign(patterns.size(), 0.0);
+    isCurrent = false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Update the current pattern factors, returning true if any have changed.
+
+bool DemandTable::findFactors(double multiplier, double patternFactor)
+{
+    bool changed = !isCurrent || multiplier != lastMultiplier;
+    lastMultiplier = multiplier;
+    if ( factors[0] != patternFactor )
+    {
+        factors[0] = patternFactor;
+        changed = true;
+    }
+    for (size_t i = 1; i < patterns.size(); i++)
+    {
+        double f = patterns[i]->currentFactor();
+        if ( factors[i] != f )
+        {
+            factors[i] = f;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Set each junction's full demand (and initial actual demand) for the
+//  current time period.
+
+void DemandTable::update(double multiplier, double patternFactor)
+{
+    if ( findFactors(multiplier, patternFactor) )
+    {
+        int n = junctions.size();
+        for (int i = 0; i < n; i++)
+        {
+            double q = 0.0;
+            for (int k = rowStart[i]; k < rowStart[i+1]; k++)
+            {
+                q += multiplier * baseDemand[k] * factors[column[k]];
+            }
+            junctions[i]->fullDemand = q;
+        }
+        isCurrent = true;
+    }
+    for (Junction* junc : junctions) junc->actualDemand = junc->fullDemand;
+}
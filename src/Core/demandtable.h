@@ -0,0 +1,54 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file demandtable.h
+//! \brief Describes the DemandTable class.
+
+#ifndef DEMANDTABLE_H_
+#define DEMANDTABLE_H_
+
+#include <vector>
+
+class Network;
+class Junction;
+class Pattern;
+
+//! \class DemandTable
+//! \brief Evaluates the full demand at all junctions for the current time.
+//!
+//! The demand categories of every junction are compiled into a sparse
+//! matrix, stored row-wise by junction, whose columns are the time patterns
+//! that the categories use (column 0 stands for the global demand pattern).
+//! Full demands are then found as the product of this matrix with the
+//! vector of current pattern factors, and are only re-computed when one of
+//! these factors or the demand multiplier changes.
+
+class DemandTable
+{
+  public:
+
+    DemandTable();
+
+    void   compile(Network* nw);
+    void   update(double multiplier, double patternFactor);
+    void   invalidate() { isCurrent = false; }
+
+  private:
+
+    std::vector<Junction*> junctions;    //!< junctions in row order
+    std::vector<int>       rowStart;     //!< start of each junction's entries
+    std::vector<int>       column;       //!< pattern column of each entry
+    std::vector<double>    baseDemand;   //!< base demand of each entry (cfs)
+    std::vector<Pattern*>  patterns;     //!< pattern of each column
+    std::vector<double>    factors;      //!< current factor of each column
+    double                 lastMultiplier;  //!< multiplier of last update
+    bool                   isCurrent;    //!< true if demands are up to date
+
+    bool   findFactors(double multiplier, double patternFactor);
+};
+
+#endif // DEMANDTABLE_H_
@@ -78,8 +78,8 @@ int EN_runEpanet(const char* inpFile, const char* rptFile, const char* outFile)
 	double alfaopen = 0.000001;
 	double alfaclose = 0.000001;
 
-	int IndexV1, IndexJ1, Index13150, Index12957, IndexJ1552; // Hadımköy
-	double flowV1, presJ1, pres13150, pres12957, pres1552;
+	int IndexJ1, Index13150, Index12957, IndexJ1552; // Hadımköy
+	double inletFlow, presJ1, pres13150, pres12957, pres1552;
 
 	pressureAndFlowOutFile << "Time" << "\t\t" << "Inlet_Flow_Rate_(l/s)" << "\t\t" << "Pressure_1_(m)" << "\t\t" << "Pressure_13150_(m)" << "\t\t" << "Pressure_12957_(m)" << "\t\t" << "Pressure_1552_(m)" << "\t\t" << "Leakage_(l/s)" << "\n";
 
@@ -138,27 +138,29 @@ int EN_runEpanet(const char* inpFile, const char* rptFile, const char* outFile)
 
 			// Hadımköy WDN
 
-			int ErrorV1 = EN_getLinkIndex("1", &IndexV1, p.getNetwork());
 			int ErrorJ1 = EN_getNodeIndex("1", &IndexJ1, p.getNetwork());
 			int Error13150 = EN_getNodeIndex("13150", &Index13150, p.getNetwork());
 			int Error12957 = EN_getNodeIndex("12957", &Index12957, p.getNetwork());
 			int ErrorJ1552 = EN_getNodeIndex("1552", &IndexJ1552, p.getNetwork());
 
-			double ErrorValV1 = EN_getLinkValue(IndexV1, EN_FLOW, &flowV1, p.getNetwork());
+			// ... inlet flow is the network's current supply from reservoirs
+			EN_getZoneValue(-1, EN_SUPPLYRATE, &inletFlow, &p);
 			double ErrorValJ1 = EN_getNodeValue(IndexJ1, EN_PRESSURE, &presJ1, p.getNetwork());
 			double ErrorVal13150 = EN_getNodeValue(Index13150, EN_PRESSURE, &pres13150, p.getNetwork());
 			double ErrorVal12957 = EN_getNodeValue(Index12957, EN_PRESSURE, &pres12957, p.getNetwork()); 
 			double ErrorValJ1552 = EN_getNodeValue(IndexJ1552, EN_PRESSURE, &pres1552, p.getNetwork());
 
-			totalFlow += flowV1*tstep * 365 / (7 * 1000); // Compute total annual inlet water volume (m3)
 			
 			if ( t%30 == 0) // Extract the output parameters per 30 seconds.
-				pressureAndFlowOutFile << Utilities::getTime(t) << "\t\t" << flowV1 << "\t\t" << presJ1 << "\t\t" << pres13150 << "\t\t" << pres12957 << "\t\t" << pres1552 << "\t\t" << totalLoss << "\n"; // */ 
+				pressureAndFlowOutFile << Utilities::getTime(t) << "\t\t" << inletFlow << "\t\t" << presJ1 << "\t\t" << pres13150 << "\t\t" << pres12957 << "\t\t" << pres1552 << "\t\t" << totalLoss << "\n"; // */ 
 
 			p.lasting();
 			
         } while (tstep > 0 && !err );
 
+		// ... total annual inlet water volume (m3) from the weekly supply volume
+		EN_getZoneValue(-1, EN_SUPPLYVOL, &totalFlow, &p);
+		totalFlow = totalFlow * 365 / 7;
 		pressureAndFlowOutFile << totalFlow;
 
         break;
@@ -299,6 +301,64 @@ int EN_advanceSolver(int *dt, EN_Project p)
 
 //-----------------------------------------------------------------------------
 
+int EN_saveState(EN_Project p)
+{
+    return project(p)->saveState();
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_restoreState(EN_Project p)
+{
+    return project(p)->restoreState();
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_createScenario(const char* name, int* index, EN_Project p)
+{
+    return project(p)->createScenario(name, index);
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_setScenarioLinkValue(int scenario, int link, int param, double value,
+                            EN_Project p)
+{
+    return project(p)->setScenarioLinkValue(scenario, link, param, value);
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_selectScenario(int scenario, EN_Project p)
+{
+    return project(p)->selectScenario(scenario);
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_openScenarioOutputFile(int scenario, const char* fname, EN_Project p)
+{
+    return project(p)->openScenarioOutput(scenario, fname);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Names a hydraulics file that results are saved to (EN_SAVE) or read from
+//  (EN_USE) on runs initialized after it is set.
+
+int EN_setHydFile(const char* fname, int mode, EN_Project p)
+{
+    if ( mode < EN_SCRATCH || mode > EN_SAVE ) return 203;
+    if ( mode != EN_SCRATCH && (!fname || !fname[0]) ) return 203;
+    Options& options = project(p)->getNetwork()->options;
+    options.setOption(Options::HYD_FILE_MODE, mode);
+    options.setOption(Options::HYD_FILE_NAME, mode == EN_SCRATCH ? "" : fname);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
 int EN_openOutputFile(const char* fname, EN_Project p)
 {
     return project(p)->openOutput(fname);
@@ -313,6 +373,43 @@ int EN_saveOutput(EN_Project p)
 
 //-----------------------------------------------------------------------------
 
+//  Narrow the results recorded in the binary output file (see RecordPlan).
+//  A change takes effect when the solver is next initialized.
+
+int EN_recordNode(int index, EN_Project p)
+{
+    Network* nw = project(p)->getNetwork();
+    if ( index < 0 || index >= nw->count(Element::NODE) ) return 205;
+    nw->recordPlan.addNode(index);
+    return 0;
+}
+
+int EN_recordLink(int index, EN_Project p)
+{
+    Network* nw = project(p)->getNetwork();
+    if ( index < 0 || index >= nw->count(Element::LINK) ) return 205;
+    nw->recordPlan.addLink(index);
+    return 0;
+}
+
+int EN_recordNodeVariable(int var, int interval, EN_Project p)
+{
+    return project(p)->getNetwork()->recordPlan.setNodeVariable(var, interval);
+}
+
+int EN_recordLinkVariable(int var, int interval, EN_Project p)
+{
+    return project(p)->getNetwork()->recordPlan.setLinkVariable(var, interval);
+}
+
+int EN_clearRecordPlan(EN_Project p)
+{
+    project(p)->getNetwork()->recordPlan.clear();
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
 int EN_openReportFile(const char* fname, EN_Project p)
 {
     return project(p)->openReport(fname);
@@ -425,5 +522,102 @@ int EN_setLinkValue(int index, int param, double value, EN_Project p)
 	return DataManager::setLinkValue(index, param, value, project(p)->setNetwork());
 }
 
+//-----------------------------------------------------------------------------
+
+int EN_getZoneIndex(char* name, int* index, EN_Project p)
+{
+    return DataManager::getZoneIndex(name, index, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getZoneId(int index, char* id, EN_Project p)
+{
+    return DataManager::getZoneId(index, id, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getZoneValue(int index, int param, double* value, EN_Project p)
+{
+    return DataManager::getZoneValue(index, param, value, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getSpeciesIndex(char* name, int* index, EN_Project p)
+{
+    return DataManager::getSpeciesIndex(name, index, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getSpeciesId(int index, char* id, EN_Project p)
+{
+    return DataManager::getSpeciesId(index, id, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getNodeSpecies(int index, int species, double* value, EN_Project p)
+{
+    return DataManager::getNodeSpecies(index, species, value,
+                                       project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getLinkSpecies(int index, int species, double* value, EN_Project p)
+{
+    return DataManager::getLinkSpecies(index, species, value,
+                                       project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+int EN_getStatistics(int param, double* value, EN_Project p)
+{
+    return DataManager::getStatistics(param, value, project(p)->getNetwork());
+}
+
+//-----------------------------------------------------------------------------
+
+//  Huge page backing of the memory pools applies to projects loaded after
+//  it is set.
+
+int EN_setHugePages(int enabled, EN_Project p)
+{
+    project(p)->getNetwork()->setHugePages(enabled != 0);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Result statistics apply to runs initialized after they are set. A limit
+//  of -HUGE_VAL (lower) or HUGE_VAL (upper) leaves it unset.
+
+int EN_setResultStats(int enabled, EN_Project p)
+{
+    project(p)->getNetwork()->resultStats.enabled = (enabled != 0);
+    return 0;
+}
+
+int EN_setStatQuantiles(int count, double* fractions, EN_Project p)
+{
+    if ( count < 0 || (count > 0 && !fractions) ) return 203;
+    vector<double> q(fractions, fractions + count);
+    return project(p)->getNetwork()->resultStats.setQuantiles(q);
+}
+
+int EN_setStatLimits(int var, double lower, double upper, EN_Project p)
+{
+    return project(p)->getNetwork()->resultStats.setLimits(var, lower, upper);
+}
+
+int EN_getStatValue(int var, int index, int stat, double* value, EN_Project p)
+{
+    return project(p)->getNetwork()->resultStats.getValue(var, index, stat, value);
+}
+
 
 }  // end of namespace
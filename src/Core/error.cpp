@@ -28,7 +28,8 @@ static const int SystemErrorCodes[] =
     110, //HYDRAULICS_SOLVER_FAILURE,
     111, //QUALITY_SOLVER_FAILURE
 
-    112  //SOLVER_NOT_INITIALIZED,
+    112, //SOLVER_NOT_INITIALIZED,
+    113  //NO_SAVED_STATE
  };
 
 static const char* SystemErrorMsgs[] =
@@ -44,7 +45,8 @@ static const char* SystemErrorMsgs[] =
     "\n\n*** SYSTEM ERROR 109: QUALITY SOLVER NOT OPENED",
     "\n\n*** SYSTEM ERROR 110: HYDRAULIC SOLVER FAILURE",
     "\n\n*** SYSTEM ERROR 111: QUALITY SOLVER FAILURE",
-    "\n\n*** SYSTEM ERROR 112: SOLVER NOT INITIALIZED"
+    "\n\n*** SYSTEM ERROR 112: SOLVER NOT INITIALIZED",
+    "\n\n*** SYSTEM ERROR 113: NO SAVED SIMULATION STATE"
 };
 
 static const int InputErrorCodes[] =
@@ -111,7 +113,10 @@ static const int FileErrorCodes[] =
     307, // CANNOT_READ_HYDRAULICS_FILE
     308, // CANNOT_WRITE_TO_OUTPUT_FILE
     309, // CANNOT_WRITE_TO_REPORT_FILE
-    310  // NO_RESULTS_SAVED_TO_REPORT
+    310, // NO_RESULTS_SAVED_TO_REPORT
+    311, // CANNOT_WRITE_TO_STATS_FILE
+    312, // CANNOT_WRITE_TO_HYDRAULICS_FILE
+    313  // CANNOT_READ_OUTPUT_FILE
 };
 
 static const char* FileErrorMsgs[] =
@@ -125,7 +130,10 @@ static const char* FileErrorMsgs[] =
     "\n\n*** FILE ERROR 307: CANNOT READ HYDRAULICS FILE",
     "\n\n*** FILE ERROR 308: CANNOT WRITE TO OUTPUT FILE",
     "\n\n*** FILE ERROR 309: CANNOT WRITE TO REPORT FILE",
-    "\n\n*** FILE ERROR 310: NO RESULTS SAVED TO REPORT"
+    "\n\n*** FILE ERROR 310: NO RESULTS SAVED TO REPORT",
+    "\n\n*** FILE ERROR 311: CANNOT WRITE TO STATISTICS FILE",
+    "\n\n*** FILE ERROR 312: CANNOT WRITE TO HYDRAULICS FILE",
+    "\n\n*** FILE ERROR 313: CANNOT READ OUTPUT FILE"
 };
 
 //-----------------------------------------------------------------------------
@@ -47,6 +47,7 @@ class SystemError : public ENerror
         HYDRAULICS_SOLVER_FAILURE,     //110
         QUALITY_SOLVER_FAILURE,        //111
         SOLVER_NOT_INITIALIZED,        //112
+        NO_SAVED_STATE,                //113
         SYSTEM_ERROR_LIMIT
     };
     SystemError(int type);
@@ -111,6 +112,9 @@ class FileError : public ENerror
         CANNOT_WRITE_TO_OUTPUT_FILE,   //308
         CANNOT_WRITE_TO_REPORT_FILE,   //309
         NO_RESULTS_SAVED_TO_REPORT,    //310
+        CANNOT_WRITE_TO_STATS_FILE,    //311
+        CANNOT_WRITE_TO_HYDRAULICS_FILE, //312
+        CANNOT_READ_OUTPUT_FILE,       //313
         FILE_ERROR_LIMIT
     };
     FileError(int type);
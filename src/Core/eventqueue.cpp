@@ -0,0 +1,135 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ ///////////////////////////////////////////////
+ //  Implementation of the EventQueue class.  //
+ ///////////////////////////////////////////////
+
+#include "eventqueue.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+EventQueue::EventQueue()
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Empties the queue and sizes it for a given number of event sources.
+
+void EventQueue::init(int sourceCount)
+{
+    heap.clear();
+    heap.reserve(sourceCount);
+    position.assign(sourceCount, -1);
+    eventTime.assign(sourceCount, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Schedules (or reschedules) the event of a source to occur at a given time.
+
+void EventQueue::schedule(int source, int time)
+{
+    int pos = position[source];
+    if ( pos < 0 )
+    {
+        eventTime[source] = time;
+        heap.push_back(source);
+        position[source] = heap.size() - 1;
+        moveUp(heap.size() - 1);
+    }
+    else if ( time != eventTime[source] )
+    {
+        bool earlier = time < eventTime[source];
+        eventTime[source] = time;
+        if ( earlier ) moveUp(pos);
+        else moveDown(pos);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Removes a source's scheduled event (if it has one) from the queue.
+
+void EventQueue::cancel(int source)
+{
+    int pos = position[source];
+    if ( pos < 0 ) return;
+    position[source] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if ( pos == (int)heap.size() ) return;
+
+    // ... fill the vacated position with the last event in the heap
+
+    place(last, pos);
+    moveUp(pos);
+    moveDown(position[last]);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Removes the earliest event from the queue.
+
+void EventQueue::pop()
+{
+    if ( !heap.empty() ) cancel(heap[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+bool EventQueue::precedes(int source1, int source2)
+{
+    if ( eventTime[source1] != eventTime[source2] )
+    {
+        return eventTime[source1] < eventTime[source2];
+    }
+    return source1 < source2;
+}
+
+//-----------------------------------------------------------------------------
+
+void EventQueue::moveUp(int pos)
+{
+    int source = heap[pos];
+    while ( pos > 0 )
+    {
+        int parent = (pos - 1) / 2;
+        if ( !precedes(source, heap[parent]) ) break;
+        place(heap[parent], pos);
+        pos = parent;
+    }
+    place(source, pos);
+}
+
+//-----------------------------------------------------------------------------
+
+void EventQueue::moveDown(int pos)
+{
+    int n = heap.size();
+    int source = heap[pos];
+    for (;;)
+    {
+        int child = 2 * pos + 1;
+        if ( child >= n ) break;
+        if ( child + 1 < n && precedes(heap[child+1], heap[child]) ) child++;
+        if ( !precedes(heap[child], source) ) break;
+        place(heap[child], pos);
+        pos = child;
+    }
+    place(source, pos);
+}
+
+//-----------------------------------------------------------------------------
+
+void EventQueue::place(int source, int pos)
+{
+    heap[pos] = source;
+    position[source] = pos;
+}
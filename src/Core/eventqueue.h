@@ -0,0 +1,52 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file eventqueue.h
+//! \brief Describes the EventQueue class.
+
+#ifndef EVENTQUEUE_H_
+#define EVENTQUEUE_H_
+
+#include <vector>
+
+//! \class EventQueue
+//! \brief A priority queue of the times at which future events occur.
+//!
+//! Each of a fixed number of event sources (e.g., a time pattern or a
+//! control) has at most one event scheduled in the queue. The queue is an
+//! indexed binary heap ordered by event time, with ties going to the source
+//! with the lower index, so that an event can be rescheduled or cancelled
+//! in logarithmic time when its source changes.
+
+class EventQueue
+{
+  public:
+
+    EventQueue();
+
+    void   init(int sourceCount);
+    void   schedule(int source, int time);
+    void   cancel(int source);
+    void   pop();
+
+    bool   empty()   { return heap.empty(); }
+    int    top()     { return heap[0]; }
+    int    topTime() { return eventTime[heap[0]]; }
+
+  private:
+
+    std::vector<int> heap;        //!< sources with scheduled events in heap order
+    std::vector<int> position;    //!< position of each source in heap (or -1)
+    std::vector<int> eventTime;   //!< time of each source's scheduled event
+
+    bool   precedes(int source1, int source2);
+    void   moveUp(int pos);
+    void   moveDown(int pos);
+    void   place(int source, int pos);
+};
+
+#endif // EVENTQUEUE_H_
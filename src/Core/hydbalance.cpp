@@ -15,7 +15,9 @@
 #include "hydbalance.h"
 #include "network.h"
 #include "Elements/node.h"
-#include "Elements/link.h"
+#include "Elements/junction.h"
+#include "Elements/pipe.h"
+#include "Models/leakagemodel.h"
 #include "Elements/valve.h"
 #include "Elements/node.h"
 #include "Core/hydengine.h"
@@ -45,6 +47,9 @@ double  HydBalance::evaluate(
 			int currentTime, 
 			double tstep)
 {
+    nw->solverStats.startTimer(SolverStats::ERROR_NORM);
+    nw->solverStats.count(SolverStats::ERROR_NORM_EVALS);
+
     // ... initialize which elements have the maximum errors
     maxFlowErr = 0.0;
     maxHeadErr = 0.0;
@@ -61,7 +66,9 @@ double  HydBalance::evaluate(
     // ... find the error norm in satisfying conservation of energy
     //     (updating xQ with internal link flows)
 
+    nw->solverStats.startTimer(SolverStats::HEAD_LOSS);
     double norm = findHeadErrorNorm(lamda, dH, dQ, xQ, nw, currentTime, tstep);
+    nw->solverStats.stopTimer(SolverStats::HEAD_LOSS);
 
     // ... update xQ with external outflows
 
@@ -74,6 +81,7 @@ double  HydBalance::evaluate(
     // ... evaluate the total relative flow change
 
     totalFlowChange = findTotalFlowChange(lamda, dQ, nw);
+    nw->solverStats.stopTimer(SolverStats::ERROR_NORM);
 
     // ... return the root mean square error
 
@@ -103,6 +111,10 @@ double HydBalance::findHeadErrorNorm(
         int n1 = link->fromNode->index;
         int n2 = link->toNode->index;
 
+        // ... links attached to isolated nodes carry no flow
+
+        if ( link->isIsolated() ) continue;
+
         // ... apply updated flow to end node flow balances
 
         double flowChange = lamda * dQ[i];
@@ -132,7 +144,7 @@ double HydBalance::findHeadErrorNorm(
         // ... evaluate head loss error according to Steady and Unsteady Flow Conditions
 		
 
-		if (currentTime == 0 || nw->option(Options::HYD_SOLVER) == "GGA" )
+		if (currentTime == 0 || nw->option(Options::HYD_SOLVER) != "RWCGGA" )
 		{
 			unsteadyTerm = 0;
 		}
@@ -178,6 +190,8 @@ void findNodeOutflows(double lamda, double dH[], double xQ[], Network* nw)
     for (Node* node : nw->nodes)
     {
         node->outflow = 0.0;
+        node->emitterFlow = 0.0;
+        node->leakage = 0.0;
         node->qGrad = 0.0;
     }
 
@@ -185,8 +199,24 @@ void findNodeOutflows(double lamda, double dH[], double xQ[], Network* nw)
 
     if ( nw->leakageModel ) findLeakageFlows(lamda, dH, xQ, nw);
 
-    // ... add emitter flows and demands to node outflows
+    // ... add emitter flows to the outflows of junctions that have emitters
 
+    for (Junction* junc : nw->emitterJunctions)
+    {
+        if ( junc->isolated ) continue;
+        int i = junc->index;
+        double dqdh = 0.0;
+        double q = junc->findEmitterFlow(junc->head + lamda * dH[i], dqdh);
+        junc->emitterFlow = q;
+        junc->qGrad += dqdh;
+        junc->outflow += q;
+        xQ[i] -= q;
+    }
+
+    // ... add demands to node outflows, summing the network's water
+    //     balance rates as each node's outflow is found
+
+    nw->waterBalance.startRates();
     int nodeCount = nw->count(Element::NODE);
     for (int i = 0; i < nodeCount; i++)
     {
@@ -195,19 +225,20 @@ void findNodeOutflows(double lamda, double dH[], double xQ[], Network* nw)
         double q = 0.0;
         double dqdh = 0.0;
 
-        // ... for junctions, outflow depends on head
+        // ... isolated nodes have no outflow
 
-        if ( node->type() == Node::JUNCTION )
+        if ( node->isolated )
         {
-            // ... contribution from emitter flow
-
-            q = node->findEmitterFlow(h, dqdh);
-            node->qGrad += dqdh;
-            node->outflow += q;
-            xQ[i] -= q;
+            node->actualDemand = 0.0;
+            xQ[i] = 0.0;
+            nw->waterBalance.addNodeRates(node);
+            continue;
+        }
 
-            // ... contribution from demand flow
+        // ... for junctions, outflow depends on head
 
+        if ( node->type() == Node::JUNCTION )
+        {
             // ... for fixed grade junction, demand is remaining flow excess
             if ( node->fixedGrade )
             {
@@ -233,6 +264,7 @@ void findNodeOutflows(double lamda, double dH[], double xQ[], Network* nw)
             node->outflow = xQ[i];
             xQ[i] = 0.0;
         }
+        nw->waterBalance.addNodeRates(node);
     }
 }
 
@@ -275,44 +307,59 @@ double HydBalance::findFlowErrorNorm(double xQ[], Network* nw)
 
 void findLeakageFlows(double lamda, double dH[], double xQ[], Network* nw)
 {
-    double dqdh = 0.0;  // gradient of leakage outflow w.r.t. pressure head
+    LeakageModel* model = nw->leakageModel;
+    int n = nw->leakingPipes.size();
 
-    for (Link* link : nw->links)
+    // ... find the average pressure head along each leaking pipe
+
+    for (int i = 0; i < n; i++)
     {
-        // ... skip links that don't leak
+        Pipe* pipe = nw->leakingPipes[i];
+        Node* node1 = pipe->fromNode;
+        Node* node2 = pipe->toNode;
+
+        // ... no leakage if neither end node is a junction
+        //     or the pipe is isolated
+
+        if ( (node1->type() != Node::JUNCTION && node2->type() != Node::JUNCTION) ||
+             pipe->isIsolated() )
+        {
+            model->head[i] = 0.0;
+            continue;
+        }
+        double h1 = node1->head + lamda * dH[node1->index] - node1->elev;
+        double h2 = node2->head + lamda * dH[node2->index] - node2->elev;
+        model->head[i] = (h1 + h2) / 2.0;
+    }
+
+    // ... find leakage and its gradient for all pipes at once
+
+    model->findFlows();
 
-        link->leakage = 0.0;
-        dqdh = 0.0;
-        if ( !link->canLeak() ) continue;
+    // ... assign each pipe's leakage to its end nodes
+
+    for (int i = 0; i < n; i++)
+    {
+        Pipe* pipe = nw->leakingPipes[i];
+        pipe->leakage = model->flow[i];
+        if ( model->head[i] <= 0.0 ) continue;
+        double dqdh = model->gradient[i];
 
         // ... identify link's end nodes and their indexes
 
-        Node* node1 = link->fromNode;
-        Node* node2 = link->toNode;
+        Node* node1 = pipe->fromNode;
+        Node* node2 = pipe->toNode;
         int n1 = node1->index;
         int n2 = node2->index;
-
-        // ... no leakage if neither end node is not a junction
-
         bool canLeak1 = (node1->type() == Node::JUNCTION);
         bool canLeak2 = (node2->type() == Node::JUNCTION);
-        if ( !canLeak1 && !canLeak2 ) continue;
-
-        // ... find link's average pressure head
-
         double h1 = node1->head + lamda * dH[n1] - node1->elev;
         double h2 = node2->head + lamda * dH[n2] - node2->elev;
-        double h = (h1 + h2) / 2.0;
-        if ( h <= 0.0 ) continue;
-
-        // ... find leakage and its gradient
-
-        link->leakage = link->findLeakage(nw, h, dqdh);
 
         // ... split leakage flow between end nodes, unless one cannot
         //     support leakage or has negative pressure head
 
-        double q = link->leakage / 2.0;
+        double q = pipe->leakage / 2.0;
         if ( h1 * h2 <= 0.0 || canLeak1 * canLeak2 == 0 ) q = 2.0 * q;
 
         // ... add leakage to each node's outflow
@@ -320,12 +367,14 @@ void findLeakageFlows(double lamda, double dH[], double xQ[], Network* nw)
         if ( h1 > 0.0 && canLeak1 )
         {
             node1->outflow += q;
+            node1->leakage += q;
             node1->qGrad += dqdh;
             xQ[n1] -= q;
         }
         if ( h2 > 0.0 && canLeak2 )
         {
             node2->outflow += q;
+            node2->leakage += q;
             node2->qGrad += dqdh;
             xQ[n2] -= q;
         }
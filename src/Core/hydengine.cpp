@@ -9,23 +9,24 @@
  //  Implementation of the HydEngine class.  //
  //////////////////////////////////////////////
 
- // TO DO:
- // - add support for Rule-Based controls
- // - add support for saving hydraulics results to a binary file
-
 #include "hydengine.h"
 #include "network.h"
 #include "error.h"
+#include "simstate.h"
 #include "Solvers/hydsolver.h"
 #include "Solvers/matrixsolver.h"
+#include "Solvers/forestcoresolver.h"
+#include "Models/leakagemodel.h"
 #include "Elements/link.h"
 #include "Elements/tank.h"
+#include "Elements/pump.h"
 #include "Elements/pattern.h"
 #include "Elements/control.h"
 #include "Utilities/utilities.h"
 
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <iomanip>
 #include <string>
 #include <vector>
@@ -41,29 +42,25 @@ static const string s_IllConditioned =
 static const string s_Balanced   = "  Network balanced in ";
 static const string s_Trials     = " trials.";
 static const string s_Deficient  = " nodes were pressure deficient.";
-static const string s_ReSolve1   =
-    "\n    Re-solving network with these made fixed grade.";
-static const string s_Reductions1 =  " nodes require demand reductions.";
-static const string s_ReSolve2    =
-    "\n    Re-solving network with these reductions made.";
-static const string s_Reductions2 =
-    " nodes require further demand reductions to 0.";
 
 //-----------------------------------------------------------------------------
 
 //  Constructor
 
 HydEngine::HydEngine() :
+    currentTime(0),
     engineState(HydEngine::CLOSED),
     network(nullptr),
     hydSolver(nullptr),
     matrixSolver(nullptr),
     saveToFile(false),
+    readFromFile(false),
     halted(false),
+    eventsScheduled(false),
     startTime(0),
     rptTime(0),
     hydStep(0),
-    currentTime(0),
+    fileStep(0),
     timeOfDay(0),
     peakKwatts(0.0)
 {
@@ -96,6 +93,7 @@ void HydEngine::open(Network* nw)
     network->createHeadLossModel();
     network->createDemandModel();
     network->createLeakageModel();
+    if ( network->leakageModel ) network->leakageModel->init(network);
 
     // ... create and initialize a matrix solver
 
@@ -105,7 +103,16 @@ void HydEngine::open(Network* nw)
     {
         throw SystemError(SystemError::MATRIX_SOLVER_NOT_OPENED);
     }
+    // ... a topology reduction eliminates series nodes as well as the
+    //     forest part of the network
+
+    bool reduceSeries = network->option(Options::TOPOLOGY_REDUCTION);
+    if ( reduceSeries || network->option(Options::FOREST_CORE) )
+    {
+        matrixSolver = new ForestCoreSolver(matrixSolver, reduceSeries);
+    }
     initMatrixSolver();
+    matrixSolver->setStats(&network->solverStats);
 
     // ... create a hydraulic solver
 
@@ -137,6 +144,14 @@ void HydEngine::init(bool initFlows)
         node->initialize(network);          // head, quality, volume, etc.
     }
 
+    if ( network->leakageModel )
+    {
+        network->leakageModel->init(network);  // pipe leakage factors
+    }
+    network->solverStats.clear();
+    demandTable.compile(network);       // junction demand categories
+    ruleEngine.compile(network);        // rule-based controls
+
     int patternStep = network->option(Options::PATTERN_STEP);
     int patternStart = network->option(Options::PATTERN_START);
     for (Pattern* pattern : network->patterns)
@@ -150,8 +165,22 @@ void HydEngine::init(bool initFlows)
     startTime = network->option(Options::START_TIME);
     rptTime = network->option(Options::REPORT_START);
     peakKwatts = 0.0;
+    network->waterBalance.init(network);
     engineState = HydEngine::INITIALIZED;
     timeStepReason = "";
+    eventsScheduled = false;
+
+    // ... open a hydraulics file being saved to or used (can throw exception)
+
+    int fileMode = network->option(Options::HYD_FILE_MODE);
+    saveToFile = (fileMode == Options::SAVE);
+    readFromFile = (fileMode == Options::USE);
+    fileStep = 0;
+    hydFile.close();
+    if ( saveToFile || readFromFile )
+    {
+        hydFile.open(network, network->option(Options::HYD_FILE_NAME), readFromFile);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -161,7 +190,7 @@ void HydEngine::init(bool initFlows)
 int  HydEngine::solve(int* t)
 {
     if ( engineState != HydEngine::INITIALIZED ) return 0;
-    if ( network->option(Options::REPORT_STATUS) )
+    if ( network->option(Options::REPORT_STATUS) && !readFromFile )
     {
         network->msgLog << endl << "  Hour " <<
             Utilities::getTime(currentTime) << timeStepReason;
@@ -170,22 +199,37 @@ int  HydEngine::solve(int* t)
     *t = currentTime;
     timeOfDay = (currentTime + startTime) % 86400;
 
+    // ... retrieve the results of a hydraulics file being used
+
+    if ( readFromFile )
+    {
+        fileStep = hydFile.readResults(currentTime);
+        network->waterBalance.update(network, hydStep);
+        return 0;
+    }
+
     updateCurrentConditions();
 
     if ( network->option(Options::REPORT_TRIALS) )  network->msgLog << endl;
     int trials = 0;
     int statusCode = hydSolver->solve(hydStep, trials, currentTime);
 
-    if ( statusCode == HydSolver::SUCCESSFUL && isPressureDeficient() )
-    {
-        statusCode = resolvePressureDeficiency(trials);
-    }
+    // ... pressure deficient junctions are resolved by the solver as part
+    //     of its status checks (see ConstrainedDemandModel)
+
+    if ( network->option(Options::REPORT_TRIALS) ) reportDeficientNodes();
+    network->solverStats.addTrials(trials);
+    network->solverStats.setPoolStats(SolverStats::NETWORK_POOL, network->poolStats());
 	
 	for (Link* link : network->links)
 	{
 		link->previousStatus = link->status;
 	}
-	
+
+    // ... add flows over the step just completed to the water balance
+
+    network->waterBalance.update(network, hydStep);
+
     reportDiagnostics(statusCode, trials);
     if ( halted ) throw SystemError(SystemError::HYDRAULICS_SOLVER_FAILURE); // */
     return statusCode;
@@ -200,21 +244,30 @@ void HydEngine::advance(int* tstep)
     *tstep = 0;
     if ( engineState != HydEngine::INITIALIZED ) return;
 
-    // ... save current results to hydraulics file
-    //if ( saveToFile ) errcode = hydWriter.writeResults(hydState, hydTime);
-
     // ... if time remains, find time (hydStep) until next hydraulic event
+    //     (or take it from the hydraulics file being used)
 
     hydStep = 0;
+    if ( !eventsScheduled ) scheduleEvents();
     int timeLeft = network->option(Options::TOTAL_DURATION) - currentTime;
     if ( halted ) timeLeft = 0;
     if ( timeLeft > 0  )
     {
-        hydStep = getTimeStep();
+        if ( readFromFile ) hydStep = fileStep;
+        else hydStep = getTimeStep();
         if ( hydStep > timeLeft ) hydStep = timeLeft;
     }
     *tstep = hydStep;
 
+    // ... add the current results, which hold over the time step, to the
+    //     result statistics
+
+    network->resultStats.update(network, currentTime, hydStep);
+
+    // ... save current results to hydraulics file
+
+    if ( saveToFile ) hydFile.writeResults(currentTime, hydStep);
+
     // ... update energy usage and tank levels over the time step
 
     updateEnergyUsage();
@@ -231,9 +284,9 @@ void HydEngine::advance(int* tstep)
         rptTime += network->option(Options::REPORT_STEP);
     }
 
-    // ... advance time patterns
+    // ... advance time patterns and reschedule events that have come due
 
-    updatePatterns();
+    updateEvents();
 }
 
 //-----------------------------------------------------------------------------
@@ -247,6 +300,7 @@ void HydEngine::close()
     matrixSolver = nullptr;
     delete hydSolver;
     hydSolver = nullptr;
+    hydFile.close();
     engineState = HydEngine::CLOSED;
 
     //... Other objects created in HydEngine::open() belong to the
@@ -255,6 +309,47 @@ void HydEngine::close()
 
 //-----------------------------------------------------------------------------
 
+//  Saves the engine's clock, energy usage and hydraulics file position (the
+//  state of the network's elements is saved separately).
+
+void HydEngine::saveState(SimState& state)
+{
+    state.put(halted);
+    state.put(rptTime);
+    state.put(hydStep);
+    state.put(currentTime);
+    state.put(timeOfDay);
+    state.put(peakKwatts);
+    state.put(fileStep);
+    hydFile.saveState(state);
+    ruleEngine.saveState(state);
+}
+
+//-----------------------------------------------------------------------------
+
+void HydEngine::restoreState(SimState& state)
+{
+    halted = state.getBool();
+    rptTime = state.getInt();
+    hydStep = state.getInt();
+    currentTime = state.getInt();
+    timeOfDay = state.getInt();
+    peakKwatts = state.get();
+    fileStep = state.getInt();
+    hydFile.restoreState(state);
+    ruleEngine.restoreState(state);
+
+    // ... junction demands must be re-evaluated at the next time period
+    //     since their pattern factors have been restored
+    demandTable.invalidate();
+
+    // ... the event queue is rebuilt once the network's patterns have
+    //     also been restored
+    eventsScheduled = false;
+}
+
+//-----------------------------------------------------------------------------
+
 //  Initializes the matrix equation solver.
 
 void HydEngine::initMatrixSolver()
@@ -305,35 +400,23 @@ void HydEngine::updateCurrentConditions()
 	if (patternFactor < 0)
 		patternFactor = 0;
 
+    // ... find each junction's full target demand for current time period
+
+    demandTable.update(multiplier, patternFactor);
+
     // ... update node conditions
 
     for (Node* node : network->nodes)
     {
-        // ... find node's full target demand for current time period
-        node->findFullDemand(multiplier, patternFactor);
-
         // ... set its fixed grade state (for tanks & reservoirs)
         node->setFixedGrade();
-		
-		if (node->type() == Node::JUNCTION)
-		{
-			double ph;
-			node->pastHead = node->head;
-			node->ph = node->head;
-			
-		}
-		else if (node->type() == Node::RESERVOIR)
-		{
-			node->pastHead = node->head;
-			node->ph = node->head;
-		}
 
-		else if (node->type() == Node::TANK)
-		{
-			node->pastHead = node->head;
-			node->ph = node->head;
-		}
+        // ... save its head at the start of the time step
+        node->pastHead = node->head;
+        node->ph = node->head;
 
+        // ... set its pressure constraint on demand (for junctions)
+        node->initDemandStatus(network);
     }
 
     // ... update link conditions
@@ -343,14 +426,17 @@ void HydEngine::updateCurrentConditions()
         // ... open a temporarily closed link
         //if ( link->status >= Link::TEMP_CLOSED ) link->status = Link::LINK_OPEN;
 
-		if (link->type() == Link::PIPE || Link::PUMP || Link::VALVE)
-		{
-			link->pastFlow = link->flow;
-			link->pastHloss = link->hLoss;
-			link->pastSetting = link->setting;
-		}
+        // ... save its flow state at the start of the time step
+        link->pastFlow = link->flow;
+        link->pastHloss = link->hLoss;
+        link->pastSetting = link->setting;
+    }
 
-        // ... apply pattern-based pump or valve setting
+    // ... apply pattern-based pump or valve settings
+
+    network->solverStats.startTimer(SolverStats::CONTROLS);
+    for (Link* link : network->links)
+    {
         link->applyControlPattern(network->msgLog);
     }
 
@@ -360,94 +446,28 @@ void HydEngine::updateCurrentConditions()
     {
         control->apply(network, currentTime, timeOfDay);
     }
-}
 
-//-----------------------------------------------------------------------------
+    // ... apply rule-based controls
 
-bool HydEngine::isPressureDeficient()
-{
-    int count = 0;
-    for (Node* node : network->nodes)
-    {
-        // ... This only gets evaluated for the CONSTRAINED demand model
-        if ( node->isPressureDeficient(network) ) count++;
-    }
-    if ( count > 0 && network->option(Options::REPORT_TRIALS) )
-    {
-        network->msgLog << "\n\n    " << count << s_Deficient;
-    }
-    return (count > 0);
+    ruleEngine.apply(currentTime);
+    network->solverStats.stopTimer(SolverStats::CONTROLS);
 }
 
 //-----------------------------------------------------------------------------
 
-int HydEngine::resolvePressureDeficiency(int& trials)
-{
-    int trials2 = 0;
-    int trials3 = 0;
-    int trials4 = 0;
-    int count1 = 0;
-    int count2 = 0;
-    bool reportTrials = ( network->option(Options::REPORT_TRIALS) );
-
-    // ... re-solve network hydraulics with the pressure deficient junctions
-    //     set to fixed grade (which occurred in isPressureDeficient())
-
-    if ( reportTrials ) network->msgLog << s_ReSolve1;
-    int statusCode = hydSolver->solve(hydStep, trials2, currentTime);
-    if ( statusCode == HydSolver::FAILED_ILL_CONDITIONED ) return statusCode;
-
-    // ... adjust actual demands for the pressure deficient junctions
-
-    for (Node* node : network->nodes)
-    {
-        if ( node->type() == Node::JUNCTION && node->fixedGrade )
-        {
-            node->actualDemand = min(node->actualDemand, node->fullDemand);
-            node->actualDemand = max(0.0, node->actualDemand);
-            if ( node->actualDemand < node->fullDemand ) count1++;
-            node->fixedGrade = false;
-        }
-    }
-
-    // ... re-solve once more with the reduced demands at the affected junctions
-
-    if (reportTrials )
-    {
-        network->msgLog << "\n\n    " << count1 << s_Reductions1;
-        network->msgLog << s_ReSolve2;
-    }
-    statusCode = hydSolver->solve(hydStep, trials3, currentTime);
-
-    // ... check once more for any remaining pressure deficiencies
+//  Reports the number of junctions whose demand was reduced because of
+//  insufficient pressure (under the CONSTRAINED demand model).
 
+void HydEngine::reportDeficientNodes()
+{
+    if ( network->option(Options::DEMAND_MODEL) != "CONSTRAINED" ) return;
+    int count = 0;
     for (Node* node : network->nodes)
     {
-        if ( node->isPressureDeficient(network) )
-        {
-            count2++;
-
-            // ... remove fixed grade status set in isPressureDeficient
-            //     and make actual demand 0
-            node->fixedGrade = false;
-            node->actualDemand = 0.0;
-        }
-    }
-
-     // ... if there are any, then re-solve once more
-
-    if ( count2 > 0 )
-    {
-        if ( reportTrials )
-        {
-            network->msgLog << "\n    " << count2 << s_Reductions2;
-            network->msgLog << s_ReSolve2 << "\n";
-        }
-        statusCode = hydSolver->solve(hydStep, trials4, currentTime);
+        if ( node->type() == Node::JUNCTION &&
+             node->actualDemand < node->fullDemand ) count++;
     }
-
-    trials += trials2 + trials3 + trials4;
-    return statusCode;
+    if ( count > 0 ) network->msgLog << "\n    " << count << s_Deficient;
 }
 
 //-----------------------------------------------------------------------------
@@ -505,95 +525,162 @@ int HydEngine::getTimeStep()
         timeStepReason = "";
     }
 
-    // ... adjust for time until next time pattern change
-
-    tstep = timeToPatternChange(tstep);
+    // ... adjust for time until the next pattern change, tank closure or
+    //     control activation
 
-    // ... adjust for shortest time to fill or drain a tank
+    scheduleTankEvents();
+    tstep = timeToNextEvent(tstep);
 
-    tstep = timeToCloseTank(tstep);
+    // ... adjust for time until a rule-based control would fire
 
-    // ... adjust for shortest time to activate a simple control
-
-    tstep = timeToActivateControl(tstep);
+    t = ruleEngine.timeToFire(currentTime, tstep);
+    if ( t < tstep )
+    {
+        tstep = t;
+        timeStepReason = "  (rule activated)";
+    }
     return tstep;
 }
 
 //-----------------------------------------------------------------------------
 
-//  Finds shortest time until next change for all time patterns.
+//  Places the next pattern change and timed control activation in the event
+//  queue. Events are numbered by source with patterns first, then tanks and
+//  then controls (the order in which a tie between them is broken).
 
-int HydEngine::timeToPatternChange(int tstep)
+void HydEngine::scheduleEvents()
 {
-    Pattern* changedPattern = nullptr;
-    for (Pattern* pattern : network->patterns)
+    int nPatterns = network->patterns.size();
+    int nTanks = network->tanks.size();
+    events.init(nPatterns + nTanks + network->controls.size());
+    tankControls.clear();
+    controlTanks.clear();
+
+    // ... an outflow of NaN forces every tank's events to be rescheduled
+    tankOutflows.assign(nTanks, numeric_limits<double>::quiet_NaN());
+    tankVolumes.assign(nTanks, 0.0);
+    tankChanged.assign(nTanks, 1);
+    vector<int> tankOfNode(network->count(Element::NODE), -1);
+    for (int i = 0; i < nTanks; i++) tankOfNode[network->tanks[i]->index] = i;
+
+    for (int i = 0; i < nPatterns; i++)
     {
-        int t = pattern->nextTime(currentTime) - currentTime;
-        if ( t > 0 && t < tstep )
+        int t = network->patterns[i]->nextTime(currentTime);
+        if ( t > currentTime && t < numeric_limits<int>::max() )
         {
-            tstep = t;
-            changedPattern = pattern;
+            events.schedule(i, t);
         }
     }
-    if ( changedPattern )
+
+    int tod = (currentTime + startTime) % 86400;
+    int source = nPatterns + nTanks;
+    for (Control* control : network->controls)
     {
-        timeStepReason = "  (change in Pattern " + changedPattern->name + ")";
+        if ( control->getType() == Control::TANK_LEVEL )
+        {
+            tankControls.push_back(source);
+            controlTanks.push_back(tankOfNode[control->getNode()->index]);
+        }
+        int t = control->nextActivationTime(currentTime, tod);
+        if ( t > currentTime ) events.schedule(source, t);
+        source++;
     }
-    return tstep;
+    eventsScheduled = true;
 }
 
 //-----------------------------------------------------------------------------
 
-//  Finds the shortest time to completely fill or empty all tanks.
+//  Reschedules the times at which tanks fill or empty and tank level controls
+//  activate for those tanks whose flow or volume changed over the last step.
 
-int HydEngine::timeToCloseTank(int tstep)
+void HydEngine::scheduleTankEvents()
 {
-    Tank* closedTank = nullptr;
-    for (Node* node : network->nodes)
+    int timeLeft = numeric_limits<int>::max() - currentTime;
+    int firstTank = network->patterns.size();
+    int nTanks = network->tanks.size();
+    for (int i = 0; i < nTanks; i++)
     {
-        // ... check if node is a tank
-
-        if ( node->type() == Node::TANK )
-        {
-            // ... find the time to fill (or empty) the tank
-
-            Tank* tank = static_cast<Tank*>(node);
-            int t = tank->timeToVolume(tank->minVolume);
-            if ( t <= 0 ) t = tank->timeToVolume(tank->maxVolume);
-
-            // ... compare this time with current time step
-
-            if ( t > 0 && t < tstep )
-            {
-                tstep = t;
-                closedTank = tank;
-            }
-        }
+        // ... a tank's event time stays put while its flow and volume do
+        Tank* tank = network->tanks[i];
+        tankChanged[i] = tank->outflow != tankOutflows[i] ||
+                         tank->volume != tankVolumes[i];
+        if ( !tankChanged[i] ) continue;
+        tankOutflows[i] = tank->outflow;
+        tankVolumes[i] = tank->volume;
+
+        int t = tank->timeToVolume(tank->minVolume);
+        if ( t <= 0 ) t = tank->timeToVolume(tank->maxVolume);
+        if ( t > 0 && t < timeLeft ) events.schedule(firstTank + i, currentTime + t);
+        else events.cancel(firstTank + i);
     }
-    if ( closedTank )
+
+    // ... a level control of an unchanged tank also keeps its time unless
+    //     the tank is moving and the status of the controlled link may have
+    //     changed at the current time
+    int firstControl = firstTank + nTanks;
+    for (size_t k = 0; k < tankControls.size(); k++)
     {
-        timeStepReason = "  (Tank " + closedTank->name + " closed)";
+        int i = controlTanks[k];
+        if ( !tankChanged[i] && network->tanks[i]->outflow == 0.0 ) continue;
+        int c = tankControls[k];
+        Control* control = network->control(c - firstControl);
+        int t = control->timeToActivate(network, currentTime, timeOfDay);
+        if ( t > 0 && t < timeLeft ) events.schedule(c, currentTime + t);
+        else events.cancel(c);
     }
-    return tstep;
 }
 
 //-----------------------------------------------------------------------------
 
-//  Finds the shortest time to activate a simple control.
+//  Finds the time until the earliest event that occurs within a time step,
+//  skipping timed controls whose activation would not change anything.
 
-int HydEngine::timeToActivateControl(int tstep)
+int HydEngine::timeToNextEvent(int tstep)
 {
-    bool activated = false;
-    for (Control* control : network->controls)
+    int firstTank = network->patterns.size();
+    int firstControl = firstTank + network->tanks.size();
+    vector<int> skipped;
+
+    while ( !events.empty() )
     {
-        int t = control->timeToActivate(network, currentTime, timeOfDay);
-        if ( t > 0 && t < tstep )
+        int source = events.top();
+        int t = events.topTime() - currentTime;
+        if ( t >= tstep ) break;
+
+        if ( source < firstTank )
+        {
+            timeStepReason = "  (change in Pattern " +
+                             network->pattern(source)->name + ")";
+        }
+        else if ( source < firstControl )
         {
-            tstep = t;
-            activated = true;
+            timeStepReason = "  (Tank " +
+                             network->tanks[source - firstTank]->name + " closed)";
         }
+        else
+        {
+            Control* control = network->control(source - firstControl);
+            if ( control->timeToActivate(network, currentTime, timeOfDay) != t )
+            {
+                skipped.push_back(source);
+                events.pop();
+                continue;
+            }
+            timeStepReason = "  (control activated)";
+        }
+        tstep = t;
+        break;
+    }
+
+    // ... return skipped controls to the queue since they may still
+    //     activate at some later time step
+
+    int tod = (currentTime + startTime) % 86400;
+    for (int source : skipped)
+    {
+        Control* control = network->control(source - firstControl);
+        events.schedule(source, control->nextActivationTime(currentTime, tod));
     }
-    if ( activated ) timeStepReason = "  (control activated)";
     return tstep;
 }
 
@@ -612,9 +699,9 @@ void HydEngine::updateEnergyUsage()
     // ... update energy usage for each pump link over the time step
 
     double totalKwatts = 0.0;
-    for (Link* link : network->links)
+    for (Pump* pump : network->pumps)
     {
-        totalKwatts += link->updateEnergyUsage(network, dt);
+        totalKwatts += pump->updateEnergyUsage(network, dt);
     }
 
     // ... update peak energy usage over entire simulation
@@ -628,20 +715,16 @@ void HydEngine::updateEnergyUsage()
 
 void HydEngine::updateTanks()
 {
-    for (Node* node : network->nodes)
+    for (Tank* tank : network->tanks)
     {
-    	if ( node->type() == Node::TANK )
-        {
-            Tank* tank = static_cast<Tank*>(node);
-            tank->pastHead = tank->head;
-			tank->ph = tank->head;
-            tank->pastVolume = tank->volume;
-			tank->pastArea = tank->area;
-            tank->pastOutflow = tank->outflow;
-            node->fixedGrade = true;
-            tank->updateVolume(hydStep);
-            tank->updateArea();
-        }
+        tank->pastHead = tank->head;
+        tank->ph = tank->head;
+        tank->pastVolume = tank->volume;
+        tank->pastArea = tank->area;
+        tank->pastOutflow = tank->outflow;
+        tank->fixedGrade = true;
+        tank->updateVolume(hydStep);
+        tank->updateArea();
     }
 }
 
@@ -680,12 +763,35 @@ void HydEngine::pastLink()
 
 //-----------------------------------------------------------------------------
 
-//  Advances all time patterns.
+//  Advances the time patterns whose next change has been reached and
+//  reschedules the events that have come due at the current time.
 
-void HydEngine::updatePatterns()
+void HydEngine::updateEvents()
 {
-    for (Pattern* pattern : network->patterns)
+    int firstTank = network->patterns.size();
+    int firstControl = firstTank + network->tanks.size();
+    int tod = (currentTime + startTime) % 86400;
+
+    while ( !events.empty() && events.topTime() <= currentTime )
     {
-        pattern->advance(currentTime);
+        int source = events.top();
+        events.pop();
+        int t = -1;
+
+        // ... tank events are rescheduled at the next time step
+
+        if ( source < firstTank )
+        {
+            Pattern* pattern = network->pattern(source);
+            pattern->advance(currentTime);
+            t = pattern->nextTime(currentTime);
+            if ( t == numeric_limits<int>::max() ) t = -1;
+        }
+        else if ( source >= firstControl )
+        {
+            Control* control = network->control(source - firstControl);
+            t = control->nextActivationTime(currentTime, tod);
+        }
+        if ( t > currentTime ) events.schedule(source, t);
     }
 }
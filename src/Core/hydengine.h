@@ -11,18 +11,35 @@
 #ifndef HYDENGINE_H_
 #define HYDENGINE_H_
 
+#include "Core/demandtable.h"
+#include "Core/eventqueue.h"
+#include "Core/ruleengine.h"
+#include "Output/hydfile.h"
+
 #include <string>
+#include <vector>
 
 class Network;
 class HydSolver;
 class MatrixSolver;
+class SimState;
 
 //! \class HydEngine
 //! \brief Simulates extended period hydraulics.
 //!
 //! The HydEngine class carries out an extended period hydraulic simulation on
 //! a pipe network, calling on its HydSolver object to solve the conservation of
-//! mass and energy equations at each time step.
+//! mass and energy equations at each time step. When the HYDRAULICS option
+//! names a file in SAVE mode the results of each time step are written to it,
+//! and in USE mode they are read back from it instead of being solved for.
+//!
+//! The time at which each time pattern next changes, each tank fills or
+//! empties and each timed or tank level control activates is kept in an
+//! EventQueue whose earliest event limits the next time step. Pattern and
+//! timed control events are only rescheduled once they come due, while tank
+//! events are rescheduled after each time step's flows have been found.
+//! Rule-based controls are applied by a RuleEngine, which can also cut a
+//! time step short when a rule would fire before it ends.
 
 class HydEngine
 {
@@ -41,6 +58,9 @@ class HydEngine
     void   advance(int* tstep);
     void   close();
 
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
+
     int    getElapsedTime() { return currentTime; }
     double getPeakKwatts()  { return peakKwatts;  }
 	double rastgele1;
@@ -58,15 +78,26 @@ class HydEngine
     Network*       network;            //!< network being analyzed
     HydSolver*     hydSolver;          //!< steady state or rwc unsteady hydraulic solver
     MatrixSolver*  matrixSolver;       //!< sparse matrix solver
-//    HydFile*       hydFile;            //!< hydraulics file accessor
+    DemandTable    demandTable;        //!< junction demands by pattern
+    HydFile        hydFile;            //!< hydraulics file accessor
+    EventQueue     events;             //!< future hydraulic events
+    RuleEngine     ruleEngine;         //!< rule-based control evaluator
+    std::vector<int> tankControls;     //!< tank level controls
+    std::vector<int> controlTanks;     //!< tank of each tank level control
+    std::vector<double> tankOutflows;  //!< tank outflows when last scheduled
+    std::vector<double> tankVolumes;   //!< tank volumes when last scheduled
+    std::vector<char>   tankChanged;   //!< true if tank's events were rescheduled
 
     // Engine properties
 
     bool           saveToFile;         //!< true if results saved to file
+    bool           readFromFile;       //!< true if results read from file
     bool           halted;             //!< true if simulation has been halted
+    bool           eventsScheduled;    //!< true if event queue is up to date
     int            startTime;          //!< starting time of day (sec)
     int            rptTime;            //!< current reporting time (sec)
     int            hydStep;            //!< hydraulic time step (sec)
+    int            fileStep;           //!< time step read from file (sec)
     
     int            timeOfDay;          //!< current time of day (sec)
     double         peakKwatts;         //!< peak energy usage (kwatts)
@@ -79,17 +110,16 @@ class HydEngine
     int            getTimeStep();
 	void           pastJunction();
 	void           pastLink();
-    int            timeToPatternChange(int tstep);
-    int            timeToActivateControl(int tstep);
-    int            timeToCloseTank(int tstep);
+    void           scheduleEvents();
+    void           scheduleTankEvents();
+    int            timeToNextEvent(int tstep);
 
     void           updateCurrentConditions();
     void           updateTanks();
-    void           updatePatterns();
+    void           updateEvents();
     void           updateEnergyUsage();
 
-    bool           isPressureDeficient();
-	int            resolvePressureDeficiency(int& trials);
+    void           reportDeficientNodes();
     void           reportDiagnostics(int statusCode, int trials);
 };
 
@@ -11,11 +11,17 @@
 
 #include "network.h"
 #include "error.h"
-#include "Elements/node.h"
-#include "Elements/link.h"
+#include "simstate.h"
+#include "Elements/junction.h"
+#include "Elements/reservoir.h"
+#include "Elements/tank.h"
+#include "Elements/pipe.h"
+#include "Elements/pump.h"
+#include "Elements/valve.h"
 #include "Elements/pattern.h"
 #include "Elements/curve.h"
 #include "Elements/control.h"
+#include "Elements/rule.h"
 #include "Models/headlossmodel.h"
 #include "Models/demandmodel.h"
 #include "Models/leakagemodel.h"
@@ -32,9 +38,12 @@ Network::Network() :
     headLossModel(nullptr),
     demandModel(nullptr),
     leakageModel(nullptr),
-    qualModel(nullptr)
+    qualModel(nullptr),
+    hugePages(false),
+    valveTypeLists(Valve::DPRV + 1)
 {
     options.setDefaults();
+    waterBalance.clear();
     memPool = new MemPool();
 }
 
@@ -75,10 +84,35 @@ void Network::clear()
     curves.clear();
     for (Control* control : controls) control->~Control();
     controls.clear();
+    for (Rule* rule : rules) rule->~Rule();
+    rules.clear();
 
-    // ... reclaim all memory allocated by the memory pool
+    // ... empty the typed element lists
 
-    memPool->reset();
+    emitterJunctions.clear();
+    tanks.clear();
+    reservoirs.clear();
+    leakingPipes.clear();
+    pumps.clear();
+    valves.clear();
+    for (auto& valveList : valveTypeLists) valveList.clear();
+
+    // ... remove all water balance zones
+
+    waterBalance.clear();
+    recordPlan.clear();
+    resultStats.clear();
+    speciesModel.clear();
+
+    // ... reclaim all memory allocated by the memory pool (replacing it
+    //     if huge page backing was turned on or off)
+
+    if ( memPool->usesHugePages() == hugePages ) memPool->reset();
+    else
+    {
+        delete memPool;
+        memPool = new MemPool(hugePages);
+    }
 
     // ... re-set all options to their default values
 
@@ -90,6 +124,15 @@ void Network::clear()
 
 //-----------------------------------------------------------------------------
 
+//  Gets the allocation statistics of the memory pool for network objects.
+
+const MemPool::Stats& Network::poolStats()
+{
+    return memPool->stats();
+}
+
+//-----------------------------------------------------------------------------
+
 int Network::count(Element::ElementType eType)
 {
     switch(eType)
@@ -99,6 +142,7 @@ int Network::count(Element::ElementType eType)
     case Element::PATTERN: return patterns.size();
     case Element::CURVE:   return curves.size();
     case Element::CONTROL: return controls.size();
+    case Element::RULE:    return rules.size();
     }
     return 0;
 }
@@ -125,6 +169,9 @@ int Network::indexOf(Element::ElementType eType, const string& name)
     case Element::CONTROL:
         table = &controlTable;
         break;
+    case Element::RULE:
+        table = &ruleTable;
+        break;
     default:
         return -1;
     }
@@ -198,6 +245,18 @@ Control* Network::control(const int index)
 
 //-----------------------------------------------------------------------------
 
+Rule* Network::rule(const string& name)
+{
+    return static_cast<Rule*>(ruleTable.find(name)->second);
+}
+
+Rule* Network::rule(const int index)
+{
+    return rules[index];
+}
+
+//-----------------------------------------------------------------------------
+
 void Network::writeTitle(ostream& out)
 {
     if ( title.size() > 0 )
@@ -212,9 +271,117 @@ void Network::writeTitle(ostream& out)
 void Network::convertUnits()
 {
     units.setUnits(options);
+    for (Curve* curve : curves) curve->finalize();
     for (Node* node : nodes) node->convertUnits(this);
     for (Link* link : links) link->convertUnits(this);
     for (Control* control : controls) control->convertUnits(this);
+    updateElementLists();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Saves the variables of all nodes, links and patterns, along with the
+//  water balance, water quality mass balance and result statistics, that
+//  change as a simulation proceeds.
+
+void Network::saveState(SimState& state)
+{
+    for (Node* node : nodes) node->saveState(state);
+    for (Link* link : links) link->saveState(state);
+    for (Pattern* pattern : patterns) pattern->saveState(state);
+    waterBalance.saveState(state);
+    state.put(qualBalance.initMass);
+    state.put(qualBalance.inflowMass);
+    state.put(qualBalance.outflowMass);
+    state.put(qualBalance.reactedMass);
+    state.put(qualBalance.storedMass);
+    resultStats.saveState(state);
+}
+
+//-----------------------------------------------------------------------------
+
+void Network::restoreState(SimState& state)
+{
+    for (Node* node : nodes) node->restoreState(state);
+    for (Link* link : links) link->restoreState(state);
+    for (Pattern* pattern : patterns) pattern->restoreState(state);
+    waterBalance.restoreState(state);
+    qualBalance.initMass = state.get();
+    qualBalance.inflowMass = state.get();
+    qualBalance.outflowMass = state.get();
+    qualBalance.reactedMass = state.get();
+    qualBalance.storedMass = state.get();
+    resultStats.restoreState(state);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Rebuilds the element lists that depend on properties assigned after an
+//  element is created (valve type, leakage coefficients and emitters).
+
+void Network::updateElementLists()
+{
+    emitterJunctions.clear();
+    for (Node* node : nodes)
+    {
+        if ( node->type() == Node::JUNCTION && node->hasEmitter() )
+        {
+            emitterJunctions.push_back(static_cast<Junction*>(node));
+        }
+    }
+
+    leakingPipes.clear();
+    for (auto& valveList : valveTypeLists) valveList.clear();
+    for (Link* link : links)
+    {
+        if ( link->type() == Link::PIPE && link->canLeak() )
+        {
+            leakingPipes.push_back(static_cast<Pipe*>(link));
+        }
+    }
+    for (Valve* valve : valves)
+    {
+        valveTypeLists[valve->valveType].push_back(valve);
+    }
+    // ... the leakage model keeps factors for each leaking pipe
+    if ( leakageModel ) leakageModel->init(this);
+}
+
+//-----------------------------------------------------------------------------
+
+const vector<Valve*>& Network::valvesOfType(int valveType)
+{
+    return valveTypeLists[valveType];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Adds a newly created element to the typed list for its type.
+
+void Network::addToElementLists(Node* node)
+{
+    switch (node->type())
+    {
+    case Node::TANK:
+        tanks.push_back(static_cast<Tank*>(node));
+        break;
+    case Node::RESERVOIR:
+        reservoirs.push_back(static_cast<Reservoir*>(node));
+        break;
+    }
+}
+
+void Network::addToElementLists(Link* link)
+{
+    switch (link->type())
+    {
+    case Link::PUMP:
+        pumps.push_back(static_cast<Pump*>(link));
+        break;
+    case Link::VALVE:
+        valves.push_back(static_cast<Valve*>(link));
+        break;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -233,6 +400,7 @@ bool Network::addElement(Element::ElementType element, int type, string name)
             node->index = nodes.size();
             nodeTable[node->name] = node;
             nodes.push_back(node);
+            addToElementLists(node);
         }
 
         else if ( element == Element::LINK )
@@ -241,6 +409,7 @@ bool Network::addElement(Element::ElementType element, int type, string name)
             link->index = links.size();
             linkTable[link->name] = link;
             links.push_back(link);
+            addToElementLists(link);
         }
 
         else if ( element == Element::PATTERN )
@@ -266,6 +435,14 @@ bool Network::addElement(Element::ElementType element, int type, string name)
             controlTable[control->name] = control;
             controls.push_back(control);
         }
+
+        else if ( element == Element::RULE )
+        {
+            Rule* rule = new(memPool->alloc(sizeof(Rule))) Rule(name);
+            rule->index = rules.size();
+            ruleTable[rule->name] = rule;
+            rules.push_back(rule);
+        }
         return true;
     }
     catch (...)
@@ -14,6 +14,11 @@
 #include "Core/options.h"
 #include "Core/units.h"
 #include "Core/qualbalance.h"
+#include "Core/waterbalance.h"
+#include "Core/solverstats.h"
+#include "Core/resultstats.h"
+#include "Output/recordplan.h"
+#include "Models/speciesmodel.h"
 #include "Elements/element.h"
 #include "Utilities/graph.h"
 
@@ -22,15 +27,23 @@
 #include <unordered_map>
 
 class Node;
+class Junction;
+class Reservoir;
+class Tank;
 class Link;
+class Pipe;
+class Pump;
+class Valve;
 class Pattern;
 class Curve;
 class Control;
+class Rule;
 class HeadLossModel;
 class DemandModel;
 class LeakageModel;
 class QualModel;
 class MemPool;
+class SimState;
 
 //! \class Network
 //! \brief Contains the data elements that describe a pipe network.
@@ -48,9 +61,17 @@ class Network
     // Clears all elements from the network
     void          clear();
 
+    // Backs the memory pools with huge pages from the next clear() on
+    void          setHugePages(bool enabled) { hugePages = enabled; }
+    bool          usesHugePages() { return hugePages; }
+    const MemPool::Stats& poolStats();
+
     // Adds an element to the network
     bool          addElement(Element::ElementType eType, int subType, std::string name);
 
+    // Rebuilds the typed element lists that depend on element properties
+    void          updateElementLists();
+
     // Finds element counts by type and index by id name
     int           count(Element::ElementType eType);
     int           indexOf(Element::ElementType eType, const std::string& name);
@@ -67,6 +88,7 @@ class Network
     Pattern*      pattern(const std::string& name);
     Curve*        curve(const std::string& name);
     Control*      control(const std::string& name);
+    Rule*         rule(const std::string& name);
 
     // Gets a network element by index
     Node*         node(const int index);
@@ -74,6 +96,7 @@ class Network
     Pattern*      pattern(const int index);
     Curve*        curve(const int index);
     Control*      control(const int index);
+    Rule*         rule(const int index);
 
     // Creates analysis models
     bool          createHeadLossModel();
@@ -89,6 +112,10 @@ class Network
     std::string   getUnits(Units::Quantity quantity);  //unit names
     void          convertUnits();
 
+    // Saves/restores the dynamic state of all network elements
+    void          saveState(SimState& state);
+    void          restoreState(SimState& state);
+
     // Adds/writes network title
     void          addTitleLine(std::string line);
     void          writeTitle(std::ostream& out);
@@ -100,9 +127,26 @@ class Network
     std::vector<Curve*>      curves;        //!< collection of data curve objects
     std::vector<Pattern*>    patterns;      //!< collection of time pattern objects
     std::vector<Control*>    controls;      //!< collection of control rules
+    std::vector<Rule*>       rules;         //!< collection of rule-based controls
+
+    // Typed lists of network elements (subsets of nodes and links)
+    std::vector<Junction*>   emitterJunctions; //!< junctions with emitters
+    std::vector<Tank*>       tanks;         //!< storage tank nodes
+    std::vector<Reservoir*>  reservoirs;    //!< fixed grade reservoir nodes
+    std::vector<Pipe*>       leakingPipes;  //!< pipes with leakage coeffs.
+    std::vector<Pump*>       pumps;         //!< pump links
+    std::vector<Valve*>      valves;        //!< valve links of all types
+
+    // Gets the list of valves of a given Valve::ValveType
+    const std::vector<Valve*>& valvesOfType(int valveType);
     Units                    units;         //!< unit conversion factors
     Options                  options;       //!< analysis options
     QualBalance              qualBalance;   //!< water quality mass balance
+    WaterBalance             waterBalance;  //!< water volume balance by zone
+    SolverStats              solverStats;   //!< solver timing and counters
+    ResultStats              resultStats;   //!< statistics of computed results
+    RecordPlan               recordPlan;    //!< results saved to output file
+    SpeciesModel             speciesModel;  //!< additional quality species
     std::ostringstream       msgLog;        //!< status message log.
 
     // Computational sub-models
@@ -119,7 +163,15 @@ class Network
     std::unordered_map<std::string, Element*>      curveTable;    //!< hash table for curve ID names.
     std::unordered_map<std::string, Element*>      patternTable;  //!< hash table for pattern ID names.
     std::unordered_map<std::string, Element*>      controlTable;  //!< hash table for control ID names.
+    std::unordered_map<std::string, Element*>      ruleTable;     //!< hash table for rule ID names.
     MemPool *      memPool;       //!< memory pool for network objects
+    bool           hugePages;     //!< true if memory pools use huge pages
+
+    // Valve lists indexed by Valve::ValveType
+    std::vector< std::vector<Valve*> > valveTypeLists;
+
+    void           addToElementLists(Node* node);
+    void           addToElementLists(Link* link);
 };
 
 //-----------------------------------------------------------------------------
@@ -34,7 +34,7 @@ static const char* flowUnitsWords[] =
 static const char* pressureUnitsWords[] = {"PSI", "METERS", "PKA", 0};
 
 // Keywords for Hyd_Solver enumeration in options.h
-static const char* hydSolverWords[] = { "GGA", "RWCGGA", 0 };
+static const char* hydSolverWords[] = { "GGA", "RWCGGA", "NULLSPACE", 0 };
 
 // Headloss formula keywords
 static const char* headlossModelWords[] = {"H-W", "D-W", "C-M", 0};
@@ -47,6 +47,9 @@ static const char* valveRepWords[] = { "Toe", "Cd", 0 };
 
 static const char* ifUnbalancedWords[] = {"STOP", "CONTINUE", 0};
 
+// Hydraulics file mode keywords
+static const char* fileModeWords[] = {"SCRATCH", "USE", "SAVE", 0};
+
 // Demand model keywords
 static const char* demandModelWords[] =
     {"FIXED", "CONSTRAINED", "POWER", "LOGISTIC", 0};
@@ -58,6 +61,10 @@ static const char* leakageModelWords[] =
 // Quality model keywords
 static const char* qualModelWords[] = {"NONE", "AGE", "TRACE", "CHEMICAL", 0};
 
+// Report statistic keywords
+static const char* statisticWords[] =
+    {"NONE", "AVERAGE", "MINIMUM", "MAXIMUM", "RANGE", 0};
+
 // Quality units keywords
 static const char* qualUnitsWords[] = {"", "HRS", "PCNT", "MG/L", "UG/L", 0};
 
@@ -96,6 +103,7 @@ void Options::setDefaults()
     stringOptions[QUAL_NAME]               = "Chemical";
     stringOptions[QUAL_UNITS_NAME]         = "MG/L";
     stringOptions[TRACE_NODE_NAME]         = "";
+    stringOptions[STATS_FILE_NAME]         = "";
 
     indexOptions[UNIT_SYSTEM]              = US;
     indexOptions[FLOW_UNITS]               = GPM;
@@ -103,6 +111,8 @@ void Options::setDefaults()
     indexOptions[MAX_TRIALS]               = 100;
     indexOptions[IF_UNBALANCED]            = STOP;
     indexOptions[HYD_FILE_MODE]            = SCRATCH;
+    indexOptions[FOREST_CORE]              = false;
+    indexOptions[TOPOLOGY_REDUCTION]       = false;
     indexOptions[DEMAND_PATTERN]           = -1;
     indexOptions[ENERGY_PRICE_PATTERN]     = -1;
     indexOptions[QUAL_TYPE]                = NOQUAL;
@@ -156,6 +166,7 @@ void Options::setDefaults()
     timeOptions[REPORT_START]              = 0;
     timeOptions[RULE_STEP]                 = 300;
     timeOptions[TOTAL_DURATION]            = 0;
+    timeOptions[REPORT_STATISTIC]          = NOSTAT;
 
     reportFields.setDefaults();
 }
@@ -238,6 +249,14 @@ int Options::setOption(StringOption option, const string& value)
         stringOptions[TRACE_NODE_NAME] = value;
         break;
 
+    case STATS_FILE_NAME:
+        stringOptions[STATS_FILE_NAME] = value;
+        break;
+
+    case HYD_FILE_NAME:
+        stringOptions[HYD_FILE_NAME] = value;
+        break;
+
     default: break;
     }
     return 0;
@@ -280,7 +299,18 @@ int Options::setOption(IndexOption option, const string& value, Network* network
         indexOptions[IF_UNBALANCED] = i;
         break;
 
-    case HYD_FILE_MODE: break;
+    case HYD_FILE_MODE:
+        i = Utilities::findFullMatch(ucValue, fileModeWords);
+        if ( i < 0 ) return InputError::INVALID_KEYWORD;
+        indexOptions[HYD_FILE_MODE] = i;
+        break;
+
+    case FOREST_CORE:
+    case TOPOLOGY_REDUCTION:
+        if ( Utilities::match(value, "YES") ) indexOptions[option] = true;
+        else if ( Utilities::match(value, "NO") ) indexOptions[option] = false;
+        else return InputError::INVALID_KEYWORD;
+        break;
 
     case DEMAND_PATTERN:
         i = network->indexOf(Element::PATTERN, value);
@@ -391,8 +421,28 @@ string Options::hydOptionsToStr()
 	s << valueOptions[TEMP_DISC_PARA] << "\n";
     s << setw(w) << "STEP_SIZING";
     s << stringOptions[STEP_SIZING] << "\n";
+    if ( indexOptions[FOREST_CORE] )
+    {
+        s << setw(w) << "FOREST_CORE" << "YES\n";
+    }
+    if ( indexOptions[TOPOLOGY_REDUCTION] )
+    {
+        s << setw(w) << "TOPOLOGY_REDUCTION" << "YES\n";
+    }
     s << setw(w) << "IF_UNBALANCED";
-    s << ifUnbalancedWords[indexOptions[IF_UNBALANCED]] << "\n\n";
+    s << ifUnbalancedWords[indexOptions[IF_UNBALANCED]] << "\n";
+    if ( stringOptions[STATS_FILE_NAME].length() > 0 )
+    {
+        s << setw(w) << "STATISTICS_FILE";
+        s << stringOptions[STATS_FILE_NAME] << "\n";
+    }
+    if ( indexOptions[HYD_FILE_MODE] != SCRATCH )
+    {
+        s << setw(w) << "HYDRAULICS";
+        s << fileModeWords[indexOptions[HYD_FILE_MODE]] << " ";
+        s << stringOptions[HYD_FILE_NAME] << "\n";
+    }
+    s << "\n";
     return s.str();
 }
 
@@ -525,6 +575,11 @@ string Options::timeOptionsToStr()
         Utilities::getTime(timeOptions[REPORT_START]) << "\n";
     s << setw(w) << "START CLOCKTIME" <<
         Utilities::getTime(timeOptions[START_TIME]) << "\n";
+    if ( timeOptions[REPORT_STATISTIC] != NOSTAT )
+    {
+        s << setw(w) << "STATISTIC" <<
+            statisticWords[timeOptions[REPORT_STATISTIC]] << "\n";
+    }
     return s.str();
 }
 
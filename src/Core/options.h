@@ -34,6 +34,7 @@ class Options
     enum QualType      {NOQUAL, AGE, TRACE, CHEM};
     enum QualUnits     {NOUNITS, HRS, PCNT, MGL, UGL};
     enum ReportedItems {NONE, ALL, SOME};
+    enum StatisticType {NOSTAT, AVERAGE, MINIMUM, MAXIMUM, RANGE};
 
     // ... Options with string values
 
@@ -56,6 +57,7 @@ class Options
         QUAL_NAME,             //!< Name of water quality constituent
         QUAL_UNITS_NAME,       //!< Name of water quality units
         TRACE_NODE_NAME,       //!< Name of node for source tracing
+        STATS_FILE_NAME,       //!< Name of file for solver statistics
 
         MAX_STRING_OPTIONS
     };
@@ -69,6 +71,8 @@ class Options
         MAX_TRIALS,            //!< Maximum hydraulic trials
         IF_UNBALANCED,         //!< Stop or continue if network is unbalanced
         HYD_FILE_MODE,         //!< Binary hydraulics file mode
+        FOREST_CORE,           //!< Solve only the looped core of the network
+        TOPOLOGY_REDUCTION,    //!< Also eliminate nodes of series link chains
         DEMAND_PATTERN,        //!< Global demand pattern index
         ENERGY_PRICE_PATTERN,  //!< Global energy price pattern index
 
@@ -58,6 +58,7 @@ namespace Epanet
 		outFileName(""),
 		tmpFileName(""),
 		rptFileName(""),
+		currentScenario(-1),
 		networkEmpty(true),
 		hydEngineOpened(false),
 		qualEngineOpened(false),
@@ -75,6 +76,7 @@ namespace Epanet
 		//cout << "\nDestructing Project.";
 
 		closeReport();
+		clearScenarios();
 		outputFile.close();
 		remove(tmpFileName.c_str());
 
@@ -112,6 +114,9 @@ namespace Epanet
 			networkEmpty = false;
 			runQuality = network.option(Options::QUAL_TYPE) != Options::NOQUAL;
 
+			// ... resolve the species named in any reaction kinetics
+			network.speciesModel.compile(&network);
+
 			// ... convert all network data to internal units
 			network.convertUnits();
 			network.options.adjustOptions();
@@ -160,6 +165,9 @@ namespace Epanet
 		networkEmpty = true;
 
 		solverInitialized = false;
+		savedState.clear();
+		clearScenarios();
+		baseState.clear();
 		inpFileName = "";
 	}
 
@@ -173,6 +181,10 @@ namespace Epanet
 		{
 			if (networkEmpty) return 0;
 			solverInitialized = false;
+			clearStates();
+
+			// ... the network's own run starts from its own values
+			if (currentScenario >= 0) scenarios[currentScenario]->revert(&network);
 			Diagnostics diagnostics;
 			diagnostics.validateNetwork(&network);
 
@@ -196,11 +208,26 @@ namespace Epanet
 				qualEngine.init();
 			}
 
+			// ... reset the result statistics
+			network.resultStats.init(&network);
+
 			// ... mark solvers as being initialized
 			solverInitialized = true;
 
-			// ... initialize the binary output file
+			// ... initialize the binary output files
 			outputFile.initWriter();
+			for (Scenario* s : scenarios)
+			{
+				if (s->outputOpened) s->output.initWriter();
+			}
+
+			// ... a selected scenario forks from the network's initial state
+			if (currentScenario >= 0)
+			{
+				int scenario = currentScenario;
+				currentScenario = -1;
+				return selectScenario(scenario);
+			}
 			return 0;
 		}
 		catch (ENerror const& e)
@@ -220,9 +247,11 @@ namespace Epanet
 		{
 			if (!solverInitialized) throw SystemError(SystemError::SOLVER_NOT_INITIALIZED);
 			hydEngine.solve(t);
-			if (outputFileOpened  && *t % network.option(Options::REPORT_STEP) == 0)
+			if (runOutputOpened()  && *t % network.option(Options::REPORT_STEP) == 0)
 			{
-				outputFile.writeNetworkResults();
+				network.solverStats.startTimer(SolverStats::OUTPUT);
+				runOutput().writeNetworkResults();
+				network.solverStats.stopTimer(SolverStats::OUTPUT);
 			}
 			return 0; // */
 		}
@@ -249,7 +278,155 @@ namespace Epanet
 			if (*dt == 0) finalizeSolver();
 
 			// ... otherwise update water quality over the time step
-			else if (runQuality) qualEngine.solve(*dt);
+			else if (runQuality)
+			{
+				network.solverStats.startTimer(SolverStats::QUALITY);
+				qualEngine.solve(*dt);
+				network.solverStats.stopTimer(SolverStats::QUALITY);
+			}
+			return 0;
+		}
+		catch (ENerror const& e)
+		{
+			writeMsg(e.msg);
+			return e.code;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Save the dynamic state of the simulation at the current point in time
+	//  (replacing any previously saved state).
+
+	int Project::saveState()
+	{
+		try
+		{
+			if (!solverInitialized) throw SystemError(SystemError::SOLVER_NOT_INITIALIZED);
+			captureState(savedState);
+			return 0;
+		}
+		catch (ENerror const& e)
+		{
+			writeMsg(e.msg);
+			return e.code;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Return the simulation to the point in time at which its state was last
+	//  saved. The saved state is kept so that it can be restored again.
+
+	int Project::restoreState()
+	{
+		try
+		{
+			if (!solverInitialized) throw SystemError(SystemError::SOLVER_NOT_INITIALIZED);
+			if (savedState.isEmpty()) throw SystemError(SystemError::NO_SAVED_STATE);
+			resumeState(savedState);
+			return 0;
+		}
+		catch (ENerror const& e)
+		{
+			writeMsg(e.msg);
+			return e.code;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Add a new scenario, with no overrides, to the project.
+
+	int Project::createScenario(const char* name, int* index)
+	{
+		*index = -1;
+		if (networkEmpty) return 0;
+		scenarios.push_back(new Scenario(name));
+		*index = (int)scenarios.size() - 1;
+		return 0;
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Override the value of a link parameter in a scenario. If the scenario
+	//  is the selected one the new value takes effect immediately.
+
+	int Project::setScenarioLinkValue(int scenario, int link, int param, double value)
+	{
+		if (scenario < 0 || scenario >= (int)scenarios.size()) return 205;
+		Scenario& s = *scenarios[scenario];
+		if (scenario == currentScenario) s.revert(&network);
+		int err = s.setLinkValue(link, param, value, &network);
+		if (scenario == currentScenario) s.apply(&network);
+		return err;
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Make a scenario (or the network itself when scenario is -1) the one
+	//  being simulated. The dynamic state of the scenario being left is kept
+	//  with it. A scenario selected for the first time since the solver was
+	//  initialized forks from the network's own run at the point that run was
+	//  left, along with the results it saved so far; otherwise it resumes
+	//  from where it was left. Its overrides are laid over the network after
+	//  its state is resumed, so that status and setting overrides made while
+	//  it was not selected are not undone by the state it was left in.
+
+	int Project::selectScenario(int scenario)
+	{
+		if (scenario < -1 || scenario >= (int)scenarios.size()) return 205;
+		if (scenario == currentScenario) return 0;
+		try
+		{
+			SimState& oldState = currentScenario < 0 ?
+				baseState : scenarios[currentScenario]->state;
+			SimState& newState = scenario < 0 ?
+				baseState : scenarios[scenario]->state;
+			if (solverInitialized) captureState(oldState);
+
+			if (currentScenario >= 0) scenarios[currentScenario]->revert(&network);
+			currentScenario = scenario;
+
+			if (solverInitialized && !newState.isEmpty()) resumeState(newState);
+			else if (solverInitialized && !baseState.isEmpty())
+			{
+				// ... fork from the network's own run
+				resumeState(baseState);
+				Scenario* s = scenarios[scenario];
+				if (s->outputOpened && outputFileOpened)
+				{
+					int err = s->output.copyPeriods(outputFile);
+					if (err) throw FileError(err);
+				}
+			}
+			if (scenario >= 0) scenarios[scenario]->apply(&network);
+			return 0;
+		}
+		catch (ENerror const& e)
+		{
+			writeMsg(e.msg);
+			return e.code;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Open a binary file that saves a scenario's computed results apart from
+	//  those of the network and of other scenarios.
+
+	int Project::openScenarioOutput(int scenario, const char* fname)
+	{
+		if (scenario < 0 || scenario >= (int)scenarios.size()) return 205;
+		Scenario& s = *scenarios[scenario];
+		s.output.close();
+		s.outputOpened = false;
+		clearStates();
+
+		try
+		{
+			s.output.open(fname, &network);
+			s.outputOpened = true;
 			return 0;
 		}
 		catch (ENerror const& e)
@@ -261,6 +438,72 @@ namespace Epanet
 
 	//-----------------------------------------------------------------------------
 
+	//  Write the dynamic state of the simulation to a SimState buffer.
+
+	void Project::captureState(SimState& state)
+	{
+		state.clear();
+		hydEngine.saveState(state);
+		network.saveState(state);
+		if (runQuality) qualEngine.saveState(state);
+		runOutput().saveState(state);
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Return the simulation to the dynamic state held in a SimState buffer.
+
+	void Project::resumeState(SimState& state)
+	{
+		state.rewind();
+		hydEngine.restoreState(state);
+		network.restoreState(state);
+		if (runQuality) qualEngine.restoreState(state);
+		runOutput().restoreState(state);
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Discard all saved simulation states (they no longer apply once the
+	//  solver or output file is re-initialized).
+
+	void Project::clearStates()
+	{
+		savedState.clear();
+		baseState.clear();
+		for (Scenario* s : scenarios) s->state.clear();
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  Delete all scenarios (closing their output files).
+
+	void Project::clearScenarios()
+	{
+		for (Scenario* s : scenarios) delete s;
+		scenarios.clear();
+		currentScenario = -1;
+	}
+
+	//-----------------------------------------------------------------------------
+
+	//  The output file of the run being simulated: the selected scenario's
+	//  own file, or the project's file when no scenario is selected.
+
+	OutputFile& Project::runOutput()
+	{
+		if (currentScenario < 0) return outputFile;
+		return scenarios[currentScenario]->output;
+	}
+
+	bool Project::runOutputOpened()
+	{
+		if (currentScenario < 0) return outputFileOpened;
+		return scenarios[currentScenario]->outputOpened;
+	}
+
+	//-----------------------------------------------------------------------------
+
 	//  Open a binary file that saves computed results.
 
 	int Project::openOutput(const char* fname)
@@ -269,6 +512,7 @@ namespace Epanet
 		if (networkEmpty) return 0;
 		outputFile.close();
 		outputFileOpened = false;
+		clearStates();
 
 		// ... save the name of the output file
 		outFileName = fname;
@@ -294,10 +538,12 @@ namespace Epanet
 
 	int Project::saveOutput()
 	{
-		if (!outputFileOpened) return 0;
+		if (!runOutputOpened()) return 0;
 		try
 		{
-			outputFile.writeNetworkResults();
+			network.solverStats.startTimer(SolverStats::OUTPUT);
+			runOutput().writeNetworkResults();
+			network.solverStats.stopTimer(SolverStats::OUTPUT);
 			return 0;
 		}
 		catch (ENerror const& e)
@@ -316,11 +562,13 @@ namespace Epanet
 		if (!solverInitialized) return;
 
 		// Save energy usage results to the binary output file.
-		if (outputFileOpened)
+		if (runOutputOpened())
 		{
 			double totalHrs = hydEngine.getElapsedTime() / 3600.0;
 			double peakKwatts = hydEngine.getPeakKwatts();
-			outputFile.writeEnergyResults(totalHrs, peakKwatts);
+			network.solverStats.startTimer(SolverStats::OUTPUT);
+			runOutput().writeEnergyResults(totalHrs, peakKwatts);
+			network.solverStats.stopTimer(SolverStats::OUTPUT);
 		}
 
 		// Write mass balance results for WQ constituent to message log
@@ -328,6 +576,22 @@ namespace Epanet
 		{
 			network.qualBalance.writeBalance(network.msgLog);
 		}
+
+		// Write water balance results to message log
+		if (network.option(Options::REPORT_STATUS))
+		{
+			network.waterBalance.writeBalance(network.msgLog, &network);
+		}
+
+		// Save solver statistics to file if one was named
+		string statsFileName = network.option(Options::STATS_FILE_NAME);
+		if (statsFileName.length() > 0)
+		{
+			if (!network.solverStats.writeToFile(statsFileName))
+			{
+				throw FileError(FileError::CANNOT_WRITE_TO_STATS_FILE);
+			}
+		}
 	}
 
 	//-----------------------------------------------------------------------------
@@ -440,12 +704,13 @@ namespace Epanet
 	{
 		try
 		{
-			if (!outputFileOpened)
+			if (!runOutputOpened())
 			{
 				throw FileError(FileError::NO_RESULTS_SAVED_TO_REPORT);
 			}
 			ReportWriter reportWriter(rptFile, &network);
-			reportWriter.writeReport(inpFileName, &outputFile);
+			int err = reportWriter.writeReport(inpFileName, &runOutput());
+			if ( err ) throw FileError(err);
 			return 0;
 		}
 		catch (ENerror const& e)
@@ -465,179 +730,164 @@ namespace Epanet
 
 		int deltat = network.option(Options::HYD_STEP);
 
-		for (int j = 0; j < network.count(Element::LINK); j++)
+		for (Valve* valve : network.valvesOfType(Valve::DPRV))
 		{
-			Link* link = network.link(j);
-			if (link->type() == Link::VALVE)
+			if (t == 0)
 			{
-				Valve* valve = static_cast<Valve*>(link);
-				if (valve->valveType == Valve::DPRV)
+				valve->Xm = 0.2;
+				valve->Xm_Last = 0.2;
+				valve->delta_Xm = 0;
+				valve->errorValve = 0;
+				valve->errorSumValve = 0;
+				valve->errorDifValve = 0;
+				valve->errorPreValve = 0.5;
+			}
+
+			pToNode = valve->toNode->head - valve->toNode->elev;
+			pToPastNode = valve->toNode->pastHead - valve->toNode->elev;
+			pFromNode = valve->fromNode->head - valve->fromNode->elev;
+
+			if (valve->presManagType == Valve::FO)
+			{
+				ref = valve->fixedOutletPressure / network.ucf(Units::PRESSURE);
+
+				// ... a valve shut off by the user or a control stays closed
+
+				if (valve->status == Valve::LINK_CLOSED && !valve->isShutOff())
 				{
-					if (t == 0)
-					{
-						valve->Xm = 0.2;
-						valve->Xm_Last = 0.2;
-						valve->delta_Xm = 0;
-						valve->errorValve = 0;
-						valve->errorSumValve = 0;
-						valve->errorDifValve = 0;
-						valve->errorPreValve = 0.5;
-					}
-
-					pToNode = valve->toNode->head - valve->toNode->elev;
-					pToPastNode = valve->toNode->pastHead - valve->toNode->elev;
-					pFromNode = valve->fromNode->head - valve->fromNode->elev;
-
-					if (valve->presManagType == Valve::FO)
-					{
-						ref = valve->fixedOutletPressure / network.ucf(Units::PRESSURE);
-
-						if (valve->status == Valve::LINK_CLOSED)
-						{
-							if (pFromNode > ref && pToNode < ref)
-								valve->status = Valve::VALVE_ACTIVE;
-						}
-					}
-						
-					if (valve->status == Valve::VALVE_ACTIVE)
-					{
-
-						// Fixed Outlet Pressure Control.
-
-						if (valve->presManagType == Valve::FO)
-						{
-							ref = valve->fixedOutletPressure / network.ucf(Units::PRESSURE);
-
-							valve->errorValve = ref - pToNode;
-						}
-
-						// Time Modulated Pressure Control. Time Schedule can be adjusted arbitrarily.
-
-						else if (valve->presManagType == Valve::TM) 
-						{
-							if (0 <= t && t <= 3600)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (3600 <= t && t <= 18000)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (18000 <= t && t <= 90000)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (90000 <= t && t <= 104400)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (104400 <= t && t <= 176400)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (176400 <= t && t <= 190800)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (190800 <= t && t <= 262800)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (262800 <= t && t <= 277200)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (277200 <= t && t <= 349200)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (349200 <= t && t <= 363600)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (363600 <= t && t <= 435600)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (435600 <= t && t <= 450000)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (450000 <= t && t <= 522000)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE);
-							else if (522000 <= t && t <= 536400)
-								ref = valve->nightPressure / network.ucf(Units::PRESSURE);
-							else if (536400 <= t && t <= 604800)
-								ref = valve->dayPressure / network.ucf(Units::PRESSURE); // */
-
-							valve->errorValve = ref - pToNode;
-						}
-
-						// Flow Modulated Pressure Control
-
-						else if (valve->presManagType == Valve::FM)
-						{
-							ref = (valve->a_FM * (valve->flow * network.ucf(Units::FLOW))* (valve->flow * network.ucf(Units::FLOW)) + valve->b_FM * (valve->flow * network.ucf(Units::FLOW)) + valve->c_FM) / network.ucf(Units::LENGTH);
-
-							valve->errorValve = ref - pToNode;
-						}
-
-						// Remote Node Modulated Pressure Control
-
-						else if (valve->presManagType == Valve::RNM)
-						{
-							pRemoteNode = valve->remoteNode->head - valve->remoteNode->elev;
-							ref = valve->rnmPressure / network.ucf(Units::PRESSURE);
-							valve->errorValve = ref - pRemoteNode;
-						}
-
-						// PRV Parameters
-
-						double Vcontrol = 0.0047;
-						double lift = 0.057;
-						double k5 = 1.30;
-						double k6 = 0.56;
-						double Acs = (k5 * valve->Xm * valve->Xm + k6) * Vcontrol / lift; // m2
-	
-						double q3 = 0;
+					if (pFromNode > ref && pToNode < ref)
+						valve->status = Valve::VALVE_ACTIVE;
+				}
+			}
+				
+			if (valve->status == Valve::VALVE_ACTIVE)
+			{
+
+				// Fixed Outlet Pressure Control.
+
+				if (valve->presManagType == Valve::FO)
+				{
+					ref = valve->fixedOutletPressure / network.ucf(Units::PRESSURE);
 
-						// Physical Based Control
-						if (valve->errorValve >= 0)
-						{
-							q3 = alfaopen * valve->errorValve;
-						}
-						else if (valve->errorValve <= 0)
-						{
-							q3 = alfaclose * valve->errorValve;
-						}
+					valve->errorValve = ref - pToNode;
+				}
 
-						valve->delta_Xm = (q3 / Acs) * deltat; // */
+				// Time Modulated Pressure Control. Time Schedule can be adjusted arbitrarily.
 
-						// PID Control
+				else if (valve->presManagType == Valve::TM) 
+				{
+					if (0 <= t && t <= 3600)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (3600 <= t && t <= 18000)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (18000 <= t && t <= 90000)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (90000 <= t && t <= 104400)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (104400 <= t && t <= 176400)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (176400 <= t && t <= 190800)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (190800 <= t && t <= 262800)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (262800 <= t && t <= 277200)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (277200 <= t && t <= 349200)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (349200 <= t && t <= 363600)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (363600 <= t && t <= 435600)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (435600 <= t && t <= 450000)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (450000 <= t && t <= 522000)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE);
+					else if (522000 <= t && t <= 536400)
+						ref = valve->nightPressure / network.ucf(Units::PRESSURE);
+					else if (536400 <= t && t <= 604800)
+						ref = valve->dayPressure / network.ucf(Units::PRESSURE); // */
+
+					valve->errorValve = ref - pToNode;
+				}
 
-						/*valve->errorSumValve = valve->errorSumValve + (valve->errorValve); // / 12);
-						if (valve->errorSumValve <= -100)
-							valve->errorSumValve = -100;
-						else if (valve->errorSumValve > 100)
-							valve->errorSumValve = 100;
+				// Flow Modulated Pressure Control
 
-						valve->errorDifValve = (valve->errorValve - valve->errorPreValve); // *12;
+				else if (valve->presManagType == Valve::FM)
+				{
+					ref = (valve->a_FM * (valve->flow * network.ucf(Units::FLOW))* (valve->flow * network.ucf(Units::FLOW)) + valve->b_FM * (valve->flow * network.ucf(Units::FLOW)) + valve->c_FM) / network.ucf(Units::LENGTH);
 
-						double pInput = Kp * valve->errorValve;
-						double iInput = Ki * valve->errorSumValve;
-						double dInput = Kd * (pToNode - pToPastNode); // valve->errorDifValve;
+					valve->errorValve = ref - pToNode;
+				}
 
-						q3 = -(pInput + iInput + dInput);
+				// Remote Node Modulated Pressure Control
 
-						valve->delta_Xm = (q3 / Acs) * deltat; // */
-		
-						valve->Xm = valve->delta_Xm + valve->Xm_Last;
-					}
+				else if (valve->presManagType == Valve::RNM)
+				{
+					pRemoteNode = valve->remoteNode->head - valve->remoteNode->elev;
+					ref = valve->rnmPressure / network.ucf(Units::PRESSURE);
+					valve->errorValve = ref - pRemoteNode;
+				}
 
-					if (valve->Xm < 0)
-						valve->Xm = 0;
-					if (valve->Xm > 1)
-						valve->Xm = 1;
-					else
-						valve->Xm = valve->Xm;
+				// PRV Parameters
+
+				double Vcontrol = 0.0047;
+				double lift = 0.057;
+				double k5 = 1.30;
+				double k6 = 0.56;
+				double Acs = (k5 * valve->Xm * valve->Xm + k6) * Vcontrol / lift; // m2
+	
+				double q3 = 0;
 
-					outFile << Utilities::getTime(t) << " " << valve->Xm << "\n";
+				// Physical Based Control
+				if (valve->errorValve >= 0)
+				{
+					q3 = alfaopen * valve->errorValve;
+				}
+				else if (valve->errorValve <= 0)
+				{
+					q3 = alfaclose * valve->errorValve;
 				}
-				else
-					continue;
+
+				valve->delta_Xm = (q3 / Acs) * deltat; // */
+
+				// PID Control
+
+				/*valve->errorSumValve = valve->errorSumValve + (valve->errorValve); // / 12);
+				if (valve->errorSumValve <= -100)
+					valve->errorSumValve = -100;
+				else if (valve->errorSumValve > 100)
+					valve->errorSumValve = 100;
+
+				valve->errorDifValve = (valve->errorValve - valve->errorPreValve); // *12;
+
+				double pInput = Kp * valve->errorValve;
+				double iInput = Ki * valve->errorSumValve;
+				double dInput = Kd * (pToNode - pToPastNode); // valve->errorDifValve;
+
+				q3 = -(pInput + iInput + dInput);
+
+				valve->delta_Xm = (q3 / Acs) * deltat; // */
+		
+				valve->Xm = valve->delta_Xm + valve->Xm_Last;
 			}
+
+			if (valve->Xm < 0)
+				valve->Xm = 0;
+			if (valve->Xm > 1)
+				valve->Xm = 1;
 			else
-				continue;
+				valve->Xm = valve->Xm;
+
+			outFile << Utilities::getTime(t) << " " << valve->Xm << "\n";
 		}
 	}
 
 
 	double Project::computeWaterLoss(double totalLoss)
 	{
-		totalLeak = 0;
-		int nodeCount = network.count(Element::NODE);
-		int linkCount = network.count(Element::LINK);
-
-		for (int j = 0; j < linkCount; j++)
-		{
-			totalLeak += network.link(j)->leakage * network.ucf(Units::FLOW);
-		}
+		// ... current leakage rate is kept by the network's water balance
+		totalLeak = network.waterBalance.rate(-1, WaterBalance::LEAKAGE) *
+		            network.ucf(Units::FLOW);
 
 		totalLoss = totalLeak; // */
 
@@ -646,24 +896,10 @@ namespace Epanet
 	
 	void Project::lasting()
 	{
-		int linkCount = network.count(Element::LINK);
-
-		for (int j = 0; j < linkCount; j++)
+		for (Valve* valve : network.valvesOfType(Valve::DPRV))
 		{
-			Link* link = network.link(j);
-			if (link->type() == Link::VALVE)
-			{
-				Valve* valve = static_cast<Valve*>(link);
-				if (valve->valveType == Valve::DPRV)
-				{
-					valve->Xm_Last = valve->Xm;
-					valve->errorPreValve = valve->errorValve;
-				}
-				else
-					continue;
-			}
-			else
-				continue;
+			valve->Xm_Last = valve->Xm;
+			valve->errorPreValve = valve->errorValve;
 		}
 	}
 
@@ -24,9 +24,12 @@
 #include "Core/network.h"
 #include "Core/hydengine.h"
 #include "Core/qualengine.h"
+#include "Core/simstate.h"
+#include "Core/scenario.h"
 #include "Output/outputfile.h"
 
 #include <string>
+#include <vector>
 #include <fstream>
 
 namespace Epanet
@@ -55,6 +58,14 @@ namespace Epanet
         int   runSolver(int* t);
         int   advanceSolver(int* dt);
 
+        int   saveState();
+        int   restoreState();
+
+        int   createScenario(const char* name, int* index);
+        int   setScenarioLinkValue(int scenario, int link, int param, double value);
+        int   selectScenario(int scenario);
+        int   openScenarioOutput(int scenario, const char* fname);
+
         int   openOutput(const char* fname);
         int   saveOutput();
 
@@ -89,6 +100,10 @@ namespace Epanet
         std::string    tmpFileName;    //!< name of project's temporary binary output file.
         std::string    rptFileName;    //!< name of project's report file.
         std::ofstream  rptFile;        //!< reporting file stream.
+        SimState       savedState;     //!< saved dynamic simulation state.
+        std::vector<Scenario*> scenarios; //!< scenarios forked from the network.
+        int            currentScenario;  //!< selected scenario (-1 for none).
+        SimState       baseState;      //!< network's state while a scenario runs.
 
         // Project status conditions
         bool           networkEmpty;
@@ -100,6 +115,12 @@ namespace Epanet
 
         void           finalizeSolver();
         void           closeReport();
+        void           captureState(SimState& state);
+        void           resumeState(SimState& state);
+        void           clearStates();
+        void           clearScenarios();
+        OutputFile&    runOutput();
+        bool           runOutputOpened();
 		double totalLeak;
 		double totalDemand;
 		double totalOutflow;
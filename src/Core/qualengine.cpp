@@ -15,6 +15,7 @@
 #include "qualengine.h"
 #include "network.h"
 #include "error.h"
+#include "simstate.h"
 #include "Models/qualmodel.h"
 #include "Solvers/qualsolver.h"
 #include "Elements/qualsource.h"
@@ -113,17 +114,18 @@ void QualEngine::init()
     {
         if ( network->qualModel->type == QualModel::TRACE ) node->quality = 0.0;
         else node->quality = node->initQual;
-        if ( node->type() == Node::TANK )
-        {
-            Tank* tank = static_cast<Tank*>(node);
-            tank->volume = tank->findVolume(tank->initHead);
-        }
+    }
+    for (Tank* tank : network->tanks)
+    {
+        tank->volume = tank->findVolume(tank->initHead);
     }
 
-    // ... initialize reaction model and quality solver
+    // ... initialize reaction models and quality solver
 
+    network->speciesModel.init(network);
     qualSolver->init();
     network->qualModel->init(network);
+    network->speciesModel.holdTraceSources();
     qualStep = network->option(Options::QUAL_STEP);
     if ( qualStep <= 0 ) qualStep = 300;
     qualTime = 0;
@@ -178,6 +180,29 @@ void QualEngine::close()
 
 //-----------------------------------------------------------------------------
 
+//  Saves the engine's clock, the flow directions its link ordering is based
+//  on and the state of its quality solver.
+
+void QualEngine::saveState(SimState& state)
+{
+    if ( engineState != QualEngine::INITIALIZED ) return;
+    state.put(qualTime);
+    for (char d : flowDirection) state.put(d);
+    qualSolver->saveState(state);
+}
+
+//-----------------------------------------------------------------------------
+
+void QualEngine::restoreState(SimState& state)
+{
+    if ( engineState != QualEngine::INITIALIZED ) return;
+    qualTime = state.getInt();
+    for (char& d : flowDirection) d = (char)state.getInt();
+    qualSolver->restoreState(state);
+}
+
+//-----------------------------------------------------------------------------
+
 //  Check if the flow direction of any link has changed.
 
 bool QualEngine::flowDirectionsChanged()
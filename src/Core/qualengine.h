@@ -15,6 +15,7 @@
 
 class Network;
 class QualSolver;
+class SimState;
 //class JuncMixer;
 //class TankMixer;
 
@@ -41,6 +42,9 @@ class QualEngine
     void   solve(int tstep);
     void   close();
 
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
+
 private:
 
     // Engine state
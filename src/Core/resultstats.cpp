@@ -0,0 +1,405 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "resultstats.h"
+#include "Core/network.h"
+#include "Core/simstate.h"
+#include "Elements/node.h"
+#include "Elements/link.h"
+#include "Elements/qualsource.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+const char* ResultStats::VariableWords[] =
+    {"PRESSURE", "QUALITY", "FLOW", "VELOCITY", "LEAKAGE", 0};
+
+static const double Huge = numeric_limits<double>::max();
+
+//-----------------------------------------------------------------------------
+
+ResultStats::ResultStats() :
+    active(false),
+    sampleCount(0),
+    sampleWeight(0.0),
+    sampleTime(0.0)
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Restores the default settings (no statistics, quantiles or limits).
+
+void ResultStats::clear()
+{
+    enabled = false;
+    fractions.clear();
+    for (int v = 0; v < MAX_VARIABLES; v++)
+    {
+        lowerLimit[v] = -Huge;
+        upperLimit[v] = Huge;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+int ResultStats::setQuantiles(const vector<double>& q)
+{
+    if ( (int)q.size() > MaxQuantiles ) return 203;
+    for (double p : q)
+    {
+        if ( p <= 0.0 || p >= 1.0 ) return 203;
+    }
+    fractions = q;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Sets the limits that time below and time above are measured from; a
+//  limit of -Huge (lower) or Huge (upper) is never crossed.
+
+int ResultStats::setLimits(int variable, double lower, double upper)
+{
+    if ( variable < 0 || variable >= MAX_VARIABLES ) return 203;
+    lowerLimit[variable] = lower;
+    upperLimit[variable] = upper;
+    return 0;
+}
+
+bool ResultStats::hasLowerLimit(int variable)
+{
+    return lowerLimit[variable] > -Huge;
+}
+
+bool ResultStats::hasUpperLimit(int variable)
+{
+    return upperLimit[variable] < Huge;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Sizes and resets the accumulators at the start of a run.
+
+void ResultStats::init(Network* nw)
+{
+    active = enabled ||
+             nw->option(Options::REPORT_STATISTIC) != Options::NOSTAT;
+    sampleCount = 0;
+    sampleWeight = 0.0;
+    sampleTime = 0.0;
+
+    for (int v = 0; v < MAX_VARIABLES; v++)
+    {
+        int n = 0;
+        if ( active ) n = v < FLOW ? nw->count(Element::NODE) :
+                                     nw->count(Element::LINK);
+        values[v].assign(n, 0.0);
+        moments[v].assign(n, Moments());
+        markers[v].assign(n * fractions.size(), Markers());
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Adds the results found at time t, which hold over a hydraulic time step
+//  of tstep seconds, to the statistics (only the part of the step after the
+//  report start time counts).
+
+void ResultStats::update(Network* nw, int t, int tstep)
+{
+    if ( !active ) return;
+    int rptStart = nw->option(Options::REPORT_START);
+    double dt = t + tstep - max(t, rptStart);
+    if ( dt < 0.0 || (dt == 0.0 && t < rptStart) ) return;
+
+    // ... steps of zero length (at the end of a run) are skipped unless the
+    //     run is a single steady state solution
+    double w = dt;
+    if ( w == 0.0 )
+    {
+        if ( sampleCount > 0 || nw->option(Options::TOTAL_DURATION) > 0 ) return;
+        w = 1.0;
+    }
+
+    findValues(nw);
+    sampleCount++;
+    sampleWeight += w;
+    sampleTime += dt;
+    int nq = fractions.size();
+    for (int v = 0; v < MAX_VARIABLES; v++)
+    {
+        int n = values[v].size();
+        for (int i = 0; i < n; i++)
+        {
+            double x = values[v][i];
+            bool limited = v != PRESSURE ||
+                           nw->node(i)->type() == Node::JUNCTION;
+            addSample(moments[v][i], x, w, dt, v, limited);
+            for (int k = 0; k < nq; k++)
+            {
+                addSample(markers[v][i * nq + k], x, fractions[k]);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool ResultStats::isActive()
+{
+    return active && sampleCount > 0;
+}
+
+int ResultStats::elementCount(int variable)
+{
+    return values[variable].size();
+}
+
+//  Returns the length of time the statistics cover (hrs).
+
+double ResultStats::hours()
+{
+    return sampleTime / 3600.0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Retrieves a statistic of a variable for the element with a given index;
+//  statistic QUANTILE + k refers to the k-th quantile in fractions.
+
+int ResultStats::getValue(int variable, int index, int statistic, double* value)
+{
+    *value = 0.0;
+    if ( variable < 0 || variable >= MAX_VARIABLES ) return 203;
+    if ( statistic < COUNT || statistic >= QUANTILE + (int)fractions.size() )
+    {
+        return 203;
+    }
+    if ( index < 0 || index >= (int)values[variable].size() ) return 205;
+    if ( sampleCount == 0 ) return 0;
+
+    Moments& m = moments[variable][index];
+    switch (statistic)
+    {
+    case COUNT:      *value = sampleCount; break;
+    case MINIMUM:    *value = m.min; break;
+    case MAXIMUM:    *value = m.max; break;
+    case MEAN:       *value = m.mean; break;
+    case STDDEV:     *value = sqrt(max(0.0, m.m2 / sampleWeight)); break;
+    case TIME_BELOW: *value = m.below / 3600.0; break;
+    case TIME_ABOVE: *value = m.above / 3600.0; break;
+    default:
+        int k = statistic - QUANTILE;
+        *value = quantile(markers[variable][index * fractions.size() + k],
+                          fractions[k]);
+    }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void ResultStats::saveState(SimState& state)
+{
+    state.put(sampleCount);
+    state.put(sampleWeight);
+    state.put(sampleTime);
+    for (int v = 0; v < MAX_VARIABLES; v++)
+    {
+        for (Moments& m : moments[v])
+        {
+            state.put(m.min);
+            state.put(m.max);
+            state.put(m.mean);
+            state.put(m.m2);
+            state.put(m.below);
+            state.put(m.above);
+        }
+        for (Markers& q : markers[v])
+        {
+            for (int j = 0; j < 5; j++) state.put(q.height[j]);
+            for (int j = 0; j < 5; j++) state.put(q.position[j]);
+        }
+    }
+}
+
+void ResultStats::restoreState(SimState& state)
+{
+    sampleCount = state.getInt();
+    sampleWeight = state.get();
+    sampleTime = state.get();
+    for (int v = 0; v < MAX_VARIABLES; v++)
+    {
+        for (Moments& m : moments[v])
+        {
+            m.min = state.get();
+            m.max = state.get();
+            m.mean = state.get();
+            m.m2 = state.get();
+            m.below = state.get();
+            m.above = state.get();
+        }
+        for (Markers& q : markers[v])
+        {
+            for (int j = 0; j < 5; j++) q.height[j] = state.get();
+            for (int j = 0; j < 5; j++) q.position[j] = state.get();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds the current value of each variable in user units, converted the
+//  same way as the results saved to the binary output file.
+
+void ResultStats::findValues(Network* nw)
+{
+    double pcf = nw->ucf(Units::PRESSURE);
+    double ccf = nw->ucf(Units::CONCEN);
+    double qcf = nw->ucf(Units::FLOW);
+    double lcf = nw->ucf(Units::LENGTH);
+
+    int i = 0;
+    for (Node* node : nw->nodes)
+    {
+        double quality = node->quality;
+        if ( node->qualSource ) quality = node->qualSource->quality;
+        values[PRESSURE][i] = (node->head - node->elev) * pcf;
+        values[QUALITY][i] = quality * ccf;
+        i++;
+    }
+
+    i = 0;
+    for (Link* link : nw->links)
+    {
+        values[FLOW][i] = link->flow * qcf;
+        values[VELOCITY][i] = link->getVelocity() * lcf;
+        values[LEAKAGE][i] = link->leakage * qcf;
+        i++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Folds a new value with weight w, holding for dt seconds, into an
+//  element's moments (sampleCount and sampleWeight include it). Time below
+//  and above the limits is only kept if the element is limited.
+
+void ResultStats::addSample(Moments& m, double x, double w, double dt,
+                            int variable, bool limited)
+{
+    if ( sampleCount == 1 )
+    {
+        m.min = x;
+        m.max = x;
+        m.mean = x;
+        m.m2 = 0.0;
+        m.below = 0.0;
+        m.above = 0.0;
+    }
+    else
+    {
+        m.min = min(m.min, x);
+        m.max = max(m.max, x);
+        double delta = x - m.mean;
+        m.mean += delta * w / sampleWeight;
+        m.m2 += w * delta * (x - m.mean);
+    }
+    if ( !limited ) return;
+    if ( x < lowerLimit[variable] ) m.below += dt;
+    if ( x > upperLimit[variable] ) m.above += dt;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Updates the five P-square markers of a quantile with a new value. The
+//  first five values are kept in sorted order as the initial markers; after
+//  that the middle three markers are moved toward their desired positions,
+//  which all elements share since they have the same number of samples.
+
+void ResultStats::addSample(Markers& q, double x, double fraction)
+{
+    double* h = q.height;
+    double* n = q.position;
+    int count = sampleCount;
+
+    // ... insert one of the first five values in sorted order
+    if ( count <= 5 )
+    {
+        int j = count - 1;
+        while ( j > 0 && h[j-1] > x )
+        {
+            h[j] = h[j-1];
+            j--;
+        }
+        h[j] = x;
+        n[count-1] = count;
+        return;
+    }
+
+    // ... find the cell the value falls in, extending the end markers
+    int k;
+    if ( x < h[0] )
+    {
+        h[0] = x;
+        k = 0;
+    }
+    else if ( x >= h[4] )
+    {
+        h[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while ( x >= h[k+1] ) k++;
+    }
+    for (int j = k + 1; j < 5; j++) n[j] += 1.0;
+
+    // ... adjust the heights of the middle markers
+    double increment[5] = {0.0, fraction / 2.0, fraction, (1.0 + fraction) / 2.0, 1.0};
+    for (int j = 1; j <= 3; j++)
+    {
+        double d = 1.0 + (count - 1) * increment[j] - n[j];
+        if ( (d >= 1.0 && n[j+1] - n[j] > 1.0) ||
+             (d <= -1.0 && n[j-1] - n[j] < -1.0) )
+        {
+            double s = d > 0.0 ? 1.0 : -1.0;
+
+            // ... try a piecewise parabolic prediction of the new height
+            double hp = h[j] + s / (n[j+1] - n[j-1]) *
+                ((n[j] - n[j-1] + s) * (h[j+1] - h[j]) / (n[j+1] - n[j]) +
+                 (n[j+1] - n[j] - s) * (h[j] - h[j-1]) / (n[j] - n[j-1]));
+
+            // ... use a linear one if it would leave the markers out of order
+            if ( hp <= h[j-1] || hp >= h[j+1] )
+            {
+                int js = j + (int)s;
+                hp = h[j] + s * (h[js] - h[j]) / (n[js] - n[j]);
+            }
+            h[j] = hp;
+            n[j] += s;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Returns the estimated quantile; with fewer than five samples it's the
+//  nearest ranked sample.
+
+double ResultStats::quantile(Markers& q, double fraction)
+{
+    if ( sampleCount >= 5 ) return q.height[2];
+    int j = (int)floor(fraction * (sampleCount - 1) + 0.5);
+    return q.height[j];
+}
@@ -0,0 +1,119 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file resultstats.h
+//! \brief Describes the ResultStats class.
+
+#ifndef RESULTSTATS_H_
+#define RESULTSTATS_H_
+
+#include <vector>
+
+class Network;
+class SimState;
+
+//! \class ResultStats
+//! \brief Accumulates summary statistics of computed results during a run.
+//!
+//! As each hydraulic time step is taken (from the report start time on) the
+//! pressure and water quality of every node and the flow, velocity and
+//! leakage of every link at the start of the step are folded into running
+//! statistics without the time series being stored. The minimum and maximum,
+//! the mean and standard deviation (using West's weighted form of Welford's
+//! update) and the time spent below and above optional lower and upper limits
+//! are weighted by the length of the step, so they measure time rather than
+//! the number of samples. Pressure limits apply to junctions only. Estimates
+//! of a chosen set of quantiles of the values of each step are also kept
+//! (using the P-square algorithm of Jain and Chlamtac, which tracks five
+//! markers per quantile). Values are kept in user units.
+//! Statistics are collected when the [TIMES] STATISTIC option is not NONE or
+//! when they are requested in the [REPORT] section or through the API. The
+//! STATISTIC option alone reports just the statistic it names.
+
+struct ResultStats
+{
+    enum Variable {
+        PRESSURE,          //!< node pressure
+        QUALITY,           //!< node water quality
+        FLOW,              //!< link flow rate
+        VELOCITY,          //!< link flow velocity
+        LEAKAGE,           //!< link leakage rate
+        MAX_VARIABLES
+    };
+
+    enum Statistic {
+        COUNT,             //!< number of hydraulic steps sampled
+        MINIMUM,           //!< smallest value
+        MAXIMUM,           //!< largest value
+        MEAN,              //!< mean value
+        STDDEV,            //!< standard deviation
+        TIME_BELOW,        //!< hours spent below the lower limit
+        TIME_ABOVE,        //!< hours spent above the upper limit
+        QUANTILE           //!< first of the estimated quantiles
+    };
+
+    static const int   MaxQuantiles = 9;
+    static const char* VariableWords[];
+
+    bool                enabled;     //!< true if statistics were requested
+    std::vector<double> fractions;   //!< fractions (0 - 1) of quantiles estimated
+    double lowerLimit[MAX_VARIABLES];  //!< value that time below is measured from
+    double upperLimit[MAX_VARIABLES];  //!< value that time above is measured from
+
+    ResultStats();
+
+    // Settings
+    void      clear();
+    int       setQuantiles(const std::vector<double>& q);
+    int       setLimits(int variable, double lower, double upper);
+    bool      hasLowerLimit(int variable);
+    bool      hasUpperLimit(int variable);
+
+    // Accumulation
+    void      init(Network* nw);
+    void      update(Network* nw, int t, int tstep);
+    bool      isActive();
+    int       elementCount(int variable);
+    double    hours();
+    int       getValue(int variable, int index, int statistic, double* value);
+    void      saveState(SimState& state);
+    void      restoreState(SimState& state);
+
+  private:
+
+    struct Moments
+    {
+        double min;
+        double max;
+        double mean;
+        double m2;        //!< weighted sum of squared deviations from the mean
+        double below;     //!< time below the lower limit (sec)
+        double above;     //!< time above the upper limit (sec)
+    };
+
+    struct Markers
+    {
+        double height[5];    //!< marker heights (estimated values)
+        double position[5];  //!< marker positions (1-based sample ranks)
+    };
+
+    bool     active;         //!< true if results are being sampled
+    int      sampleCount;    //!< number of hydraulic steps sampled
+    double   sampleWeight;   //!< total weight of the samples
+    double   sampleTime;     //!< total time the samples hold for (sec)
+    std::vector<double>  values[MAX_VARIABLES];   //!< work array of current values
+    std::vector<Moments> moments[MAX_VARIABLES];  //!< moments of each element
+    std::vector<Markers> markers[MAX_VARIABLES];  //!< quantile markers of each element
+
+    void      findValues(Network* nw);
+    void      addSample(Moments& m, double x, double w, double dt,
+                        int variable, bool limited);
+    void      addSample(Markers& q, double x, double fraction);
+    double    quantile(Markers& q, double fraction);
+};
+
+#endif
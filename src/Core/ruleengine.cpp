@@ -0,0 +1,479 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ ///////////////////////////////////////////////
+ //  Implementation of the RuleEngine class.  //
+ ///////////////////////////////////////////////
+
+#include "ruleengine.h"
+#include "Core/network.h"
+#include "Core/simstate.h"
+#include "Elements/rule.h"
+#include "Elements/junction.h"
+#include "Elements/tank.h"
+#include "Elements/link.h"
+#include "Utilities/utilities.h"
+
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+static const double Tol = 0.001;    // tolerance on equality comparisons
+
+static const string s_ByRule         = " by rule ";
+static const string s_StatusChanged  = " status changed to ";
+static const string s_SettingChanged = " setting changed to ";
+static const string statusTxt[]      = {"closed", "open"};
+
+//-----------------------------------------------------------------------------
+
+RuleEngine::RuleEngine() :
+    network(nullptr),
+    ruleCount(0),
+    ruleStep(0),
+    startTime(0),
+    lastCheckTime(-1),
+    isCurrent(false),
+    passCount(0)
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Compiles the rules of a network (whose units have been converted) into
+//  the tables used to evaluate them.
+
+void RuleEngine::compile(Network* nw)
+{
+    network = nw;
+    ruleCount = nw->rules.size();
+    ruleStep = nw->option(Options::RULE_STEP);
+    startTime = nw->option(Options::START_TIME);
+
+    terms.clear();
+    termStart.clear();
+    logicOps.clear();
+    actions.clear();
+    thenStart.clear();
+    elseStart.clear();
+    projectedTerms.clear();
+
+    for (Rule* rule : nw->rules)
+    {
+        // ... add a term for each premise
+
+        termStart.push_back(terms.size());
+        for (Rule::Premise& p : rule->premises)
+        {
+            Term term;
+            term.variable = p.variable;
+            term.index = p.object ? p.object->index : -1;
+            term.relation = p.relation;
+            term.status = p.status;
+            term.value = p.value;
+            term.rule = rule->index;
+
+            bool isProjected = p.variable == Rule::TIME ||
+                               p.variable == Rule::CLOCKTIME;
+            if ( p.objType == Rule::NODE_OBJ &&
+                 static_cast<Node*>(p.object)->type() == Node::TANK )
+            {
+                isProjected = p.variable != Rule::DEMAND;
+            }
+            if ( isProjected ) projectedTerms.push_back(terms.size());
+            terms.push_back(term);
+            logicOps.push_back(p.logicOp);
+        }
+
+        // ... add its actions with settings in internal units
+
+        thenStart.push_back(actions.size());
+        for (int i = 0; i < 2; i++)
+        {
+            if ( i == 1 ) elseStart.push_back(actions.size());
+            for (Rule::Action& a : (i == 0) ? rule->thenActions : rule->elseActions)
+            {
+                Action action;
+                action.link = a.link->index;
+                action.status = a.status;
+                action.setting = a.setting;
+                if ( a.status == Rule::NO_STATUS )
+                {
+                    action.setting = a.link->convertSetting(nw, a.setting);
+                }
+                actions.push_back(action);
+            }
+        }
+    }
+    termStart.push_back(terms.size());
+    thenStart.push_back(actions.size());
+
+    // ... order rules by descending priority (ties go to the earlier rule)
+
+    ruleOrder.resize(ruleCount);
+    for (int r = 0; r < ruleCount; r++) ruleOrder[r] = r;
+    stable_sort(ruleOrder.begin(), ruleOrder.end(), [nw](int r1, int r2)
+        { return nw->rule(r1)->priority > nw->rule(r2)->priority; });
+
+    termState.assign(terms.size(), 0);
+    ruleState.assign(ruleCount, 0);
+    ruleDirty.assign(ruleCount, 0);
+    dirtyRules.clear();
+    linkClaim.assign(nw->count(Element::LINK), 0);
+    passCount = 0;
+    lastCheckTime = -1;
+    isCurrent = false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Evaluates all rules at the start of the hydraulic time period beginning
+//  at time t and carries out the actions they call for. Rules aren't applied
+//  at time 0 since no heads or flows have been computed yet.
+
+void RuleEngine::apply(int t)
+{
+    if ( ruleCount == 0 || t == 0 ) return;
+    update(true, t, 0);
+    lastCheckTime = t;
+    takeActions(true);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Checks the rules at each rule time step within the hydraulic time step
+//  tstep that follows time t, returning the time until the first check at
+//  which a rule would change a link (or tstep if none would).
+
+int RuleEngine::timeToFire(int t, int tstep)
+{
+    if ( ruleCount == 0 || ruleStep <= 0 ) return tstep;
+
+    // ... all heads and flows have changed since the rules were applied,
+    //     after which only projected tank levels and time change
+
+    bool allTerms = true;
+    for (int tr = (t / ruleStep + 1) * ruleStep; tr < t + tstep; tr += ruleStep)
+    {
+        bool changed = update(allTerms, tr, tr - t);
+        if ( (allTerms || changed) && takeActions(false) ) return tr - t;
+        allTerms = false;
+        lastCheckTime = tr;
+    }
+    return tstep;
+}
+
+//-----------------------------------------------------------------------------
+
+void RuleEngine::saveState(SimState& state)
+{
+    state.put(lastCheckTime);
+}
+
+void RuleEngine::restoreState(SimState& state)
+{
+    lastCheckTime = state.getInt();
+    isCurrent = false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Re-evaluates either all terms or only those on tanks and time at time t
+//  (with tank levels projected dt seconds ahead), and then the premises of
+//  the rules whose terms have changed. Returns true if any rule's premises
+//  changed.
+
+bool RuleEngine::update(bool allTerms, int t, int dt)
+{
+    if ( !isCurrent )
+    {
+        allTerms = true;
+        for (int r = 0; r < ruleCount; r++)
+        {
+            ruleDirty[r] = 1;
+            dirtyRules.push_back(r);
+        }
+    }
+
+    // ... find total system demand if needed
+
+    double systemDemand = 0.0;
+    if ( allTerms )
+    {
+        for (Term& term : terms)
+        {
+            if ( term.variable == Rule::DEMAND && term.index < 0 )
+            {
+                for (Node* node : network->nodes)
+                {
+                    if ( node->type() == Node::JUNCTION ) systemDemand += node->actualDemand;
+                }
+                break;
+            }
+        }
+    }
+
+    // ... update terms, marking the rules of those that change as dirty
+
+    int n = allTerms ? terms.size() : projectedTerms.size();
+    for (int i = 0; i < n; i++)
+    {
+        int k = allTerms ? i : projectedTerms[i];
+        char state = evalTerm(terms[k], t, dt, systemDemand);
+        if ( state == termState[k] ) continue;
+        termState[k] = state;
+        int r = terms[k].rule;
+        if ( !ruleDirty[r] )
+        {
+            ruleDirty[r] = 1;
+            dirtyRules.push_back(r);
+        }
+    }
+    isCurrent = true;
+
+    // ... re-evaluate the premises of dirty rules
+
+    bool changed = false;
+    for (int r : dirtyRules)
+    {
+        ruleDirty[r] = 0;
+        char state = evalPremises(r);
+        if ( state != ruleState[r] )
+        {
+            ruleState[r] = state;
+            changed = true;
+        }
+    }
+    dirtyRules.clear();
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Evaluates a term at time t, with tank levels projected dt seconds ahead.
+
+bool RuleEngine::evalTerm(const Term& term, int t, int dt, double systemDemand)
+{
+    // ... time terms of the EQ and NE type check if the time being compared
+    //     to was passed since the rules were last checked
+
+    if ( term.variable == Rule::TIME || term.variable == Rule::CLOCKTIME )
+    {
+        int t1 = lastCheckTime;
+        int t2 = t;
+        if ( term.variable == Rule::CLOCKTIME )
+        {
+            t1 = ((t1 + startTime) % 86400 + 86400) % 86400;
+            t2 = (t2 + startTime) % 86400;
+        }
+        int v = (int)term.value;
+        bool passed = (t1 <= t2) ? (v > t1 && v <= t2) : (v > t1 || v <= t2);
+        switch (term.relation)
+        {
+        case Rule::EQ: return passed;
+        case Rule::NE: return !passed;
+        case Rule::LE: return t2 <= v;
+        case Rule::GE: return t2 >= v;
+        case Rule::LT: return t2 < v;
+        case Rule::GT: return t2 > v;
+        }
+        return false;
+    }
+
+    // ... status terms compare status codes
+
+    if ( term.variable == Rule::STATUS )
+    {
+        int status = network->link(term.index)->status;
+        if ( status == Link::VALVE_ACTIVE ) status = Rule::ACTIVE_STATUS;
+        else if ( status == Link::LINK_OPEN ) status = Rule::OPEN_STATUS;
+        else status = Rule::CLOSED_STATUS;
+        if ( term.relation == Rule::EQ ) return status == term.status;
+        if ( term.relation == Rule::NE ) return status != term.status;
+        return false;
+    }
+
+    // ... find the value of the term's variable in user units
+
+    double x = 0.0;
+    Node* node = nullptr;
+    double head = 0.0;
+    if ( term.index >= 0 && term.variable <= Rule::PRESSURE )
+    {
+        node = network->node(term.index);
+        head = node->head;
+        if ( dt > 0 && node->type() == Node::TANK ) head = tankHead(term.index, dt);
+    }
+
+    switch (term.variable)
+    {
+    case Rule::DEMAND:
+        if ( node == nullptr ) x = systemDemand;
+        else if ( node->type() == Node::JUNCTION ) x = node->actualDemand;
+        else x = node->outflow;
+        x *= network->ucf(Units::FLOW);
+        break;
+
+    case Rule::HEAD:
+    case Rule::GRADE:
+        x = head * network->ucf(Units::LENGTH);
+        break;
+
+    case Rule::LEVEL:
+        x = (head - node->elev) * network->ucf(Units::LENGTH);
+        break;
+
+    case Rule::PRESSURE:
+        x = (head - node->elev) * network->ucf(Units::PRESSURE);
+        break;
+
+    case Rule::FILLTIME:
+    case Rule::DRAINTIME:
+    {
+        // ... hours to fill or drain a tank (false if it isn't doing so)
+        Tank* tank = static_cast<Tank*>(network->node(term.index));
+        double q = tank->outflow;
+        double v = tankVolume(term.index, dt);
+        if ( term.variable == Rule::FILLTIME )
+        {
+            if ( q <= 0.0 ) return false;
+            x = (tank->maxVolume - v) / q / 3600.0;
+        }
+        else
+        {
+            if ( q >= 0.0 ) return false;
+            x = (tank->minVolume - v) / q / 3600.0;
+        }
+        break;
+    }
+
+    case Rule::FLOW:
+        x = network->link(term.index)->flow * network->ucf(Units::FLOW);
+        break;
+
+    case Rule::SETTING:
+        x = network->link(term.index)->getSetting(network);
+        break;
+    }
+
+    switch (term.relation)
+    {
+    case Rule::EQ: return abs(x - term.value) < Tol;
+    case Rule::NE: return abs(x - term.value) >= Tol;
+    case Rule::LE: return x <= term.value;
+    case Rule::GE: return x >= term.value;
+    case Rule::LT: return x < term.value;
+    case Rule::GT: return x > term.value;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Evaluates a rule's premises from left to right, where an OR term is only
+//  checked if the terms before it were false and an AND term only if they
+//  were true.
+
+bool RuleEngine::evalPremises(int rule)
+{
+    bool result = true;
+    for (int k = termStart[rule]; k < termStart[rule+1]; k++)
+    {
+        if ( logicOps[k] == Rule::OR )
+        {
+            if ( !result ) result = termState[k];
+        }
+        else
+        {
+            if ( !result ) return false;
+            result = termState[k];
+        }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Takes the THEN actions of rules whose premises hold and the ELSE actions
+//  of those whose don't, with a link acted on by several rules following
+//  the one with highest priority. If makeChange is false, the actions are
+//  only checked to see if any would change a link.
+
+bool RuleEngine::takeActions(bool makeChange)
+{
+    passCount++;
+    bool changed = false;
+    string reason;
+    for (int r : ruleOrder)
+    {
+        int beg = ruleState[r] ? thenStart[r] : elseStart[r];
+        int end = ruleState[r] ? elseStart[r] : thenStart[r+1];
+        for (int i = beg; i < end; i++)
+        {
+            Action& a = actions[i];
+            if ( linkClaim[a.link] == passCount ) continue;
+            linkClaim[a.link] = passCount;
+
+            Link* link = network->link(a.link);
+            if ( makeChange )
+            {
+                reason = link->typeStr() + " " + link->name;
+                if ( a.status != Rule::NO_STATUS )
+                {
+                    reason += s_StatusChanged + statusTxt[a.status];
+                }
+                else
+                {
+                    reason += s_SettingChanged + Utilities::to_string(a.setting);
+                }
+                reason += s_ByRule + network->rule(r)->name;
+            }
+
+            bool result;
+            if ( a.status != Rule::NO_STATUS )
+            {
+                int status = (a.status == Rule::OPEN_STATUS) ?
+                             Link::LINK_OPEN : Link::LINK_CLOSED;
+                result = link->changeStatus(status, makeChange, reason, network->msgLog);
+            }
+            else
+            {
+                result = link->changeSetting(a.setting, makeChange, reason, network->msgLog);
+            }
+            if ( result && !makeChange ) return true;
+            changed = changed || result;
+        }
+    }
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Projects a tank's volume dt seconds ahead at its current flow rate, the
+//  same way it will be updated at the end of the time step.
+
+double RuleEngine::tankVolume(int node, int dt)
+{
+    Tank* tank = static_cast<Tank*>(network->node(node));
+    if ( dt <= 0 ) return tank->volume;
+    double v = tank->volume + tank->outflow * dt;
+    double v1 = v + tank->outflow;
+    if ( v1 <= tank->minVolume ) return tank->minVolume;
+    if ( v1 >= tank->maxVolume ) return tank->maxVolume;
+    return v;
+}
+
+double RuleEngine::tankHead(int node, int dt)
+{
+    Tank* tank = static_cast<Tank*>(network->node(node));
+    double v = tankVolume(node, dt);
+    if ( dt <= 0 ) return tank->head;
+    if ( v <= tank->minVolume ) return tank->minHead;
+    if ( v >= tank->maxVolume ) return tank->maxHead;
+    return tank->findHead(v);
+}
@@ -0,0 +1,103 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file ruleengine.h
+//! \brief Describes the RuleEngine class.
+
+#ifndef RULEENGINE_H_
+#define RULEENGINE_H_
+
+#include <string>
+#include <vector>
+
+class Network;
+class SimState;
+
+//! \class RuleEngine
+//! \brief Evaluates a network's rule-based controls during a simulation.
+//!
+//! The premises of all rules are compiled into a flat table of terms, each
+//! comparing a variable of a node, link or the system (referenced by index)
+//! with a value, and each rule into a sequence of these terms joined by AND
+//! or OR. The truth of every term and rule is cached so that a rule's
+//! premises are only re-evaluated when one of its terms changes.
+//!
+//! Rules are applied at the start of each hydraulic time period. Between
+//! periods they are also checked every RULE_STEP seconds using the tank
+//! levels projected from the current tank flows, which are (together with
+//! the time) the only quantities that change before the next period is
+//! solved. Only the terms that refer to tanks or to time are re-evaluated at
+//! these checks, and the hydraulic time step is cut short at the first one
+//! where a rule would change a link's status or setting.
+
+class RuleEngine
+{
+  public:
+
+    RuleEngine();
+
+    void   compile(Network* nw);
+    bool   hasRules() { return ruleCount > 0; }
+    void   apply(int t);
+    int    timeToFire(int t, int tstep);
+
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
+
+  private:
+
+    struct Term
+    {
+        int    variable;       //!< Rule::Variable being compared
+        int    index;          //!< index of node or link (-1 for system)
+        int    relation;       //!< Rule::Relation operator
+        int    status;         //!< Rule::StatusType compared to
+        double value;          //!< value compared to (user units or sec)
+        int    rule;           //!< rule the term belongs to
+    };
+
+    struct Action
+    {
+        int    link;           //!< index of link acted on
+        int    status;         //!< new status (or Rule::NO_STATUS)
+        double setting;        //!< new setting (internal units)
+    };
+
+    Network*            network;
+    int                 ruleCount;      //!< number of rules
+    int                 ruleStep;       //!< time between rule checks (sec)
+    int                 startTime;      //!< time of day at start of run (sec)
+    int                 lastCheckTime;  //!< time rules were last checked (sec)
+    bool                isCurrent;      //!< true if all terms are up to date
+
+    // Compiled rules
+    std::vector<Term>   terms;          //!< premise terms of all rules
+    std::vector<int>    termStart;      //!< start of each rule's terms
+    std::vector<int>    logicOps;       //!< Rule::LogicOp of each term
+    std::vector<Action> actions;        //!< THEN and ELSE actions of all rules
+    std::vector<int>    thenStart;      //!< start of each rule's THEN actions
+    std::vector<int>    elseStart;      //!< start of each rule's ELSE actions
+    std::vector<int>    ruleOrder;      //!< rules in order of priority
+    std::vector<int>    projectedTerms; //!< terms on tanks or time
+
+    // Evaluation state
+    std::vector<char>   termState;      //!< current truth of each term
+    std::vector<char>   ruleState;      //!< current truth of each rule's premises
+    std::vector<char>   ruleDirty;      //!< true if a rule's terms have changed
+    std::vector<int>    dirtyRules;     //!< rules whose terms have changed
+    std::vector<int>    linkClaim;      //!< last pass in which a link was acted on
+    int                 passCount;      //!< number of action passes made
+
+    bool   update(bool allTerms, int t, int dt);
+    bool   evalTerm(const Term& term, int t, int dt, double systemDemand);
+    bool   evalPremises(int rule);
+    bool   takeActions(bool makeChange);
+    double tankHead(int node, int dt);
+    double tankVolume(int node, int dt);
+};
+
+#endif
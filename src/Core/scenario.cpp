@@ -0,0 +1,94 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ /////////////////////////////////////////////
+ //  Implementation of the Scenario class.  //
+ /////////////////////////////////////////////
+
+#include "scenario.h"
+#include "Core/datamanager.h"
+#include "Core/network.h"
+#include "epanet3.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+//  Link parameters that a scenario can override.
+
+static bool isOverridable(int param)
+{
+    switch (param)
+    {
+    case EN_DIAMETER:
+    case EN_MINORLOSS:
+    case EN_INITSTATUS:
+    case EN_INITSETTING:
+    case EN_STATUS:
+    case EN_SETTING:
+        return true;
+    default:
+        return param >= EN_PMTYPE && param <= EN_PMREMOTEPRES;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+Scenario::Scenario(string name_) :
+    name(name_),
+    outputOpened(false)
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Add an override of a link parameter (in user units) to the scenario,
+//  replacing any earlier override of the same parameter.
+
+int Scenario::setLinkValue(int index, int param, double value, Network* nw)
+{
+    if ( !isOverridable(param) ) return 203;
+    double v;
+    int err = DataManager::getLinkValue(index, param, &v, nw);
+    if ( err ) return err;
+
+    for (LinkOverride& lo : overrides)
+    {
+        if ( lo.index == index && lo.param == param )
+        {
+            lo.value = value;
+            return 0;
+        }
+    }
+    overrides.push_back({index, param, value, v});
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Lay the scenario's overrides over the network, keeping the values they
+//  replace.
+
+void Scenario::apply(Network* nw)
+{
+    for (LinkOverride& lo : overrides)
+    {
+        DataManager::getLinkValue(lo.index, lo.param, &lo.baseValue, nw);
+        DataManager::setLinkValue(lo.index, lo.param, lo.value, nw);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Put back the network values replaced by apply().
+
+void Scenario::revert(Network* nw)
+{
+    for (auto lo = overrides.rbegin(); lo != overrides.rend(); ++lo)
+    {
+        DataManager::setLinkValue(lo->index, lo->param, lo->baseValue, nw);
+    }
+}
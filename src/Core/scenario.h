@@ -0,0 +1,68 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file scenario.h
+//! \brief Describes the Scenario class.
+
+#ifndef SCENARIO_H_
+#define SCENARIO_H_
+
+#include "Core/simstate.h"
+#include "Output/outputfile.h"
+
+#include <string>
+#include <vector>
+
+class Network;
+
+//! \class Scenario
+//! \brief A variation of a project's network that can be simulated alongside it.
+//!
+//! A scenario does not copy the network. It holds only the link parameters
+//! it overrides, its own dynamic simulation state and, optionally, its own
+//! binary output file. The overrides are laid over the shared network when
+//! the scenario is selected and the network's own values are put back when
+//! it is deselected, so any number of scenarios can be forked from a project
+//! and advanced in turn. A scenario always forks from the network's own run,
+//! never from another scenario, and its results are never written to the
+//! network's output file or to that of another scenario.
+//!
+//! Scenarios are not simulated concurrently. Network elements hold their
+//! static properties and their dynamic state together, and a project has a
+//! single set of solvers, so only the selected scenario can be advanced.
+//! Separate projects are needed to run in parallel.
+
+class Scenario
+{
+  public:
+
+    Scenario(std::string name_);
+
+    int       setLinkValue(int index, int param, double value, Network* nw);
+    int       overrideCount() { return (int)overrides.size(); }
+
+    void      apply(Network* nw);
+    void      revert(Network* nw);
+
+    std::string name;          //!< scenario name
+    SimState    state;         //!< dynamic state when not selected
+    OutputFile  output;        //!< binary output file for saved results
+    bool        outputOpened;  //!< true if output file was opened
+
+  private:
+
+    struct LinkOverride
+    {
+        int    index;       //!< index of link
+        int    param;       //!< EN_ link parameter code
+        double value;       //!< scenario's value of the parameter
+        double baseValue;   //!< network's value saved by apply()
+    };
+    std::vector<LinkOverride> overrides;
+};
+
+#endif
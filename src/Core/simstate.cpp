@@ -0,0 +1,39 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ /////////////////////////////////////////////
+ //  Implementation of the SimState class.  //
+ /////////////////////////////////////////////
+
+#include "simstate.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+SimState::SimState() :
+    pos(0)
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Discard all saved values (keeping the buffer's capacity).
+
+void SimState::clear()
+{
+    values.clear();
+    pos = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Position the buffer to read back its values from the start.
+
+void SimState::rewind()
+{
+    pos = 0;
+}
@@ -0,0 +1,65 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file simstate.h
+//! \brief Describes the SimState class.
+
+#ifndef SIMSTATE_H_
+#define SIMSTATE_H_
+
+#include <vector>
+#include <cstddef>
+
+//! \class SimState
+//! \brief A snapshot of the dynamic state of a simulation.
+//!
+//! The engines, network elements and output file write the variables that
+//! change during a simulation (heads, flows, tank volumes, valve positions,
+//! pattern intervals, water quality segments, etc.) to a SimState buffer in
+//! a fixed order and read them back in the same order to return a project
+//! to that point in time. Values are stored as a flat array of doubles
+//! (integers and flags convert exactly), so a snapshot can be taken and
+//! restored without any allocation once the buffer has grown to size.
+
+class SimState
+{
+  public:
+
+    SimState();
+
+    void      clear();
+    void      rewind();
+    bool      isEmpty();
+    size_t    size();
+
+    void      put(double value);
+    double    get();
+    int       getInt();
+    bool      getBool();
+
+  private:
+    std::vector<double> values;  //!< saved state variables
+    size_t              pos;     //!< position of next value to read
+};
+
+//-----------------------------------------------------------------------------
+//    Inline Functions
+//-----------------------------------------------------------------------------
+
+inline void   SimState::put(double value) { values.push_back(value); }
+
+inline double SimState::get() { return values[pos++]; }
+
+inline int    SimState::getInt() { return (int)values[pos++]; }
+
+inline bool   SimState::getBool() { return values[pos++] != 0.0; }
+
+inline bool   SimState::isEmpty() { return values.empty(); }
+
+inline size_t SimState::size() { return values.size(); }
+
+#endif // SIMSTATE_H_
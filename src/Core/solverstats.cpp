@@ -0,0 +1,170 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ ////////////////////////////////////////////////
+ //  Implementation of the SolverStats class.  //
+ ////////////////////////////////////////////////
+
+#include "solverstats.h"
+#include "Utilities/utilities.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+static const char* phaseNames[] =
+    {"assembly", "factorization", "back_substitution", "head_loss",
+     "error_norm", "controls", "quality", "output"};
+
+static const char* counterNames[] =
+    {"periods", "trials", "max_trials", "step_size_evals",
+     "error_norm_evals", "status_changes", "factorizations"};
+
+static const char* poolNames[] = {"network", "segments"};
+
+static const char* poolMeasureNames[] = {"bytes_live", "bytes_peak", "blocks"};
+
+//-----------------------------------------------------------------------------
+
+SolverStats::SolverStats()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverStats::clear()
+{
+    fill(times, times + MAX_PHASES, 0.0);
+    fill(counters, counters + MAX_COUNTERS, 0);
+    MemPool::Stats none = {0, 0, 0, 0};
+    fill(pools, pools + MAX_POOLS, none);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Record the number of trials needed to solve a hydraulic time period.
+
+void SolverStats::addTrials(int trials)
+{
+    counters[PERIODS]++;
+    counters[TRIALS] += trials;
+    counters[MAX_TRIALS] = max(counters[MAX_TRIALS], (long long)trials);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Record the allocation statistics of one of the memory pools.
+
+void SolverStats::setPoolStats(int pool, const MemPool::Stats& stats)
+{
+    if ( pool >= 0 && pool < MAX_POOLS ) pools[pool] = stats;
+}
+
+//-----------------------------------------------------------------------------
+
+double SolverStats::time(int phase)
+{
+    if ( phase < 0 || phase >= MAX_PHASES ) return 0.0;
+    return times[phase];
+}
+
+//-----------------------------------------------------------------------------
+
+double SolverStats::counter(int counter)
+{
+    if ( counter < 0 || counter >= MAX_COUNTERS ) return 0.0;
+    return (double)counters[counter];
+}
+
+//-----------------------------------------------------------------------------
+
+double SolverStats::poolStat(int pool, int measure)
+{
+    if ( pool < 0 || pool >= MAX_POOLS ) return 0.0;
+    switch (measure)
+    {
+    case BYTES_LIVE:  return (double)pools[pool].bytesLive;
+    case BYTES_PEAK:  return (double)pools[pool].bytesPeak;
+    case BLOCK_COUNT: return (double)pools[pool].blockCount;
+    }
+    return 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverStats::writeJson(ostream& out)
+{
+    out << "{\n  \"times\": {";
+    out << fixed << setprecision(6);
+    for (int i = 0; i < MAX_PHASES; i++)
+    {
+        if ( i > 0 ) out << ",";
+        out << "\n    \"" << phaseNames[i] << "\": " << times[i];
+    }
+    out << "\n  },\n  \"counters\": {";
+    for (int i = 0; i < MAX_COUNTERS; i++)
+    {
+        if ( i > 0 ) out << ",";
+        out << "\n    \"" << counterNames[i] << "\": " << counters[i];
+    }
+    out << "\n  },\n  \"memory\": {";
+    for (int i = 0; i < MAX_POOLS; i++)
+    {
+        if ( i > 0 ) out << ",";
+        out << "\n    \"" << poolNames[i] << "\": {";
+        for (int j = 0; j < MAX_POOL_MEASURES; j++)
+        {
+            if ( j > 0 ) out << ",";
+            out << " \"" << poolMeasureNames[j] << "\": " << (long long)poolStat(i, j);
+        }
+        out << " }";
+    }
+    out << "\n  }\n}\n";
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverStats::writeCsv(ostream& out)
+{
+    out << "statistic,value\n";
+    out << fixed << setprecision(6);
+    for (int i = 0; i < MAX_PHASES; i++)
+    {
+        out << phaseNames[i] << "_time," << times[i] << "\n";
+    }
+    for (int i = 0; i < MAX_COUNTERS; i++)
+    {
+        out << counterNames[i] << "," << counters[i] << "\n";
+    }
+    for (int i = 0; i < MAX_POOLS; i++)
+    {
+        for (int j = 0; j < MAX_POOL_MEASURES; j++)
+        {
+            out << poolNames[i] << "_" << poolMeasureNames[j] << "," <<
+                (long long)poolStat(i, j) << "\n";
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write statistics to a file in CSV format if its name ends in ".csv"
+//  or in JSON format otherwise.
+
+bool SolverStats::writeToFile(const string& fname)
+{
+    ofstream out(fname);
+    if ( !out.is_open() ) return false;
+
+    string ext = "";
+    if ( fname.size() > 4 ) ext = fname.substr(fname.size() - 4);
+    if ( Utilities::upperCase(ext) == ".CSV" ) writeCsv(out);
+    else writeJson(out);
+    return !out.fail();
+}
@@ -0,0 +1,110 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file solverstats.h
+//! \brief Describes the SolverStats class.
+
+#ifndef SOLVERSTATS_H_
+#define SOLVERSTATS_H_
+
+#include "Utilities/mempool.h"
+
+#include <string>
+#include <ostream>
+#include <chrono>
+
+//! \class SolverStats
+//! \brief Collects timing and iteration statistics for a simulation run.
+//!
+//! Wall clock time is accumulated for each phase of a run (matrix assembly,
+//! factorization, forward/back substitution, head loss and error norm
+//! evaluation, controls, water quality transport and output writing) along
+//! with counters of hydraulic periods, Newton trials, step size evaluations
+//! and link status changes. Phases may be nested (head loss evaluation is
+//! part of error norm evaluation), so their times need not add up to the
+//! total run time. The allocation statistics of the memory pools holding
+//! network objects and water quality segments are also kept.
+
+struct SolverStats
+{
+    enum Phase {
+        ASSEMBLY,          //!< setting matrix coefficients
+        FACTORIZATION,     //!< numerical factorization of the matrix
+        BACK_SUBSTITUTION, //!< forward and back substitution
+        HEAD_LOSS,         //!< link head loss and energy error evaluation
+        ERROR_NORM,        //!< complete error norm evaluation
+        CONTROLS,          //!< applying pattern and conditional controls
+        QUALITY,           //!< water quality transport
+        OUTPUT,            //!< writing results to the binary output file
+        MAX_PHASES
+    };
+
+    enum Counter {
+        PERIODS,           //!< hydraulic time periods solved
+        TRIALS,            //!< total Newton trials
+        MAX_TRIALS,        //!< most trials needed in a single period
+        STEP_SIZE_EVALS,   //!< error norm evaluations made in step size search
+        ERROR_NORM_EVALS,  //!< total error norm evaluations
+        STATUS_CHANGES,    //!< link status changes made while solving
+        FACTORIZATIONS,    //!< matrix factorizations
+        MAX_COUNTERS
+    };
+
+    enum Pool {
+        NETWORK_POOL,      //!< network elements
+        SEGMENT_POOL,      //!< water quality volume segments
+        MAX_POOLS
+    };
+
+    enum PoolMeasure {
+        BYTES_LIVE,        //!< bytes in objects not yet released
+        BYTES_PEAK,        //!< largest number of bytes live
+        BLOCK_COUNT,       //!< number of memory blocks
+        MAX_POOL_MEASURES
+    };
+
+    SolverStats();
+
+    void      clear();
+    void      startTimer(int phase);
+    void      stopTimer(int phase);
+    void      count(int counter, int n = 1);
+    void      addTrials(int trials);
+    void      setPoolStats(int pool, const MemPool::Stats& stats);
+
+    double    time(int phase);
+    double    counter(int counter);
+    double    poolStat(int pool, int measure);
+
+    void      writeJson(std::ostream& out);
+    void      writeCsv(std::ostream& out);
+    bool      writeToFile(const std::string& fname);
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    double            times[MAX_PHASES];       //!< accumulated times (sec)
+    Clock::time_point startTimes[MAX_PHASES];  //!< start time of each phase
+    long long         counters[MAX_COUNTERS];  //!< event counters
+    MemPool::Stats    pools[MAX_POOLS];        //!< memory pool statistics
+};
+
+//-----------------------------------------------------------------------------
+//    Inline Functions
+//-----------------------------------------------------------------------------
+
+inline void SolverStats::startTimer(int phase)
+       { startTimes[phase] = Clock::now(); }
+
+inline void SolverStats::stopTimer(int phase)
+       { times[phase] += std::chrono::duration<double>(
+                             Clock::now() - startTimes[phase]).count(); }
+
+inline void SolverStats::count(int counter, int n)
+       { counters[counter] += n; }
+
+#endif // SOLVERSTATS_H_
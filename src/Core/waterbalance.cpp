@@ -0,0 +1,301 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ /////////////////////////////////////////////////
+ //  Implementation of the WaterBalance class.  //
+ /////////////////////////////////////////////////
+
+#include "waterbalance.h"
+#include "Core/network.h"
+#include "Core/simstate.h"
+#include "Elements/node.h"
+#include "Elements/link.h"
+#include "Elements/tank.h"
+
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+static const char* componentHeadings[] =
+    {"Supply", "Transfer", "Demand", "Emitters", "Leakage", "Storage"};
+
+//-----------------------------------------------------------------------------
+
+//  Add a named zone, returning its index (or that of an existing zone).
+
+int WaterBalance::addZone(const string& name)
+{
+    int index = zoneIndex(name);
+    if ( index >= 0 ) return index;
+    zoneNames.push_back(name);
+    return zoneNames.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+
+int WaterBalance::zoneIndex(const string& name)
+{
+    for (size_t i = 0; i < zoneNames.size(); i++)
+    {
+        if ( zoneNames[i] == name ) return i;
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+void WaterBalance::clear()
+{
+    zoneNames.clear();
+    volumes.clear();
+    rates.clear();
+    pastRates.clear();
+    initStorage.clear();
+    boundaryLinks.clear();
+    hasPastRates = false;
+    ratesFound = false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Initialize the balance at the start of a simulation.
+
+void WaterBalance::init(Network* nw)
+{
+    // ... use the same time weighting as the hydraulic solver
+
+    theta = nw->option(Options::TIME_WEIGHT);
+    theta = min(theta, 1.0);
+    if ( theta > 0.0 ) theta = max(theta, 0.5);
+
+    // ... clear accumulated volumes and flow rates
+
+    int rows = zoneCount() + 1;
+    volumes.assign(rows * MAX_COMPONENTS, 0.0);
+    rates.assign(rows * MAX_COMPONENTS, 0.0);
+    pastRates.assign(rows * MAX_COMPONENTS, 0.0);
+    hasPastRates = false;
+    ratesFound = false;
+
+    // ... save initial tank storage
+
+    initStorage.assign(rows, 0.0);
+    for (Tank* tank : nw->tanks)
+    {
+        initStorage[0] += tank->volume;
+        if ( tank->zone >= 0 ) initStorage[tank->zone + 1] += tank->volume;
+    }
+
+    // ... identify links whose end nodes lie in different zones
+
+    boundaryLinks.clear();
+    for (Link* link : nw->links)
+    {
+        if ( link->fromNode->zone != link->toNode->zone )
+        {
+            boundaryLinks.push_back(link);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Update accumulated volumes with the solution found after a time step.
+
+void WaterBalance::update(Network* nw, int tstep)
+{
+    // ... integrate flow rates over the step just completed (node rates
+    //     were summed by the hydraulic solver unless results came from a
+    //     hydraulics file)
+
+    if ( !ratesFound ) findRates(nw);
+    addTransferRates();
+    ratesFound = false;
+    if ( hasPastRates && tstep > 0 )
+    {
+        for (size_t i = 0; i < volumes.size(); i++)
+        {
+            volumes[i] += tstep * ((1.0 - theta) * pastRates[i] + theta * rates[i]);
+        }
+    }
+    pastRates.swap(rates);
+    hasPastRates = true;
+
+    // ... storage change is the difference between current and initial
+    //     tank volumes
+
+    int rows = zoneCount() + 1;
+    for (int row = 0; row < rows; row++)
+    {
+        volumes[offset(row, STORAGE)] = -initStorage[row];
+    }
+    for (Tank* tank : nw->tanks)
+    {
+        volumes[offset(0, STORAGE)] += tank->volume;
+        if ( tank->zone >= 0 )
+        {
+            volumes[offset(tank->zone + 1, STORAGE)] += tank->volume;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Clear the flow rates before the node outflows of a new trial solution
+//  are added in.
+
+void WaterBalance::startRates()
+{
+    fill(rates.begin(), rates.end(), 0.0);
+    ratesFound = !rates.empty();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Add the flow rates of a node's balance components to the network's and
+//  its zone's rates.
+
+void WaterBalance::addNodeRates(Node* node)
+{
+    if ( !ratesFound ) return;
+    double* r0 = &rates[offset(0, 0)];
+    double* r1 = nullptr;
+    if ( node->zone >= 0 ) r1 = &rates[offset(node->zone + 1, 0)];
+
+    switch (node->type())
+    {
+    case Node::JUNCTION:
+        r0[DEMAND]  += node->actualDemand;
+        r0[EMITTER] += node->emitterFlow;
+        r0[LEAKAGE] += node->leakage;
+        if ( r1 )
+        {
+            r1[DEMAND]  += node->actualDemand;
+            r1[EMITTER] += node->emitterFlow;
+            r1[LEAKAGE] += node->leakage;
+        }
+        break;
+
+    case Node::RESERVOIR:
+        r0[SUPPLY] -= node->outflow;
+        if ( r1 ) r1[SUPPLY] -= node->outflow;
+        break;
+
+    case Node::TANK:
+        r0[STORAGE] += node->outflow;
+        if ( r1 ) r1[STORAGE] += node->outflow;
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find the rate of each node balance component for each zone from the
+//  current node flows (used when results are read from a hydraulics file).
+
+void WaterBalance::findRates(Network* nw)
+{
+    startRates();
+    for (Node* node : nw->nodes) addNodeRates(node);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Add the flow transferred between zones to each zone's rates.
+
+void WaterBalance::addTransferRates()
+{
+    for (Link* link : boundaryLinks)
+    {
+        int z1 = link->fromNode->zone;
+        int z2 = link->toNode->zone;
+        if ( z1 >= 0 ) rates[offset(z1 + 1, TRANSFER)] -= link->flow;
+        if ( z2 >= 0 ) rates[offset(z2 + 1, TRANSFER)] += link->flow;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Get the volume (ft3) of a balance component accumulated for a zone.
+
+double WaterBalance::volume(int zone, int component)
+{
+    int i = offset(zone + 1, component);
+    if ( i < 0 || i >= (int)volumes.size() ) return 0.0;
+    return volumes[i];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Get the flow rate (cfs) of a balance component for a zone as of the
+//  most recent update (rates are swapped into pastRates by update()).
+
+double WaterBalance::rate(int zone, int component)
+{
+    int i = offset(zone + 1, component);
+    if ( i < 0 || i >= (int)pastRates.size() ) return 0.0;
+    return pastRates[i];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Save and restore the accumulated volumes and most recent flow rates
+//  (the zones themselves and initial storage do not change during a run).
+
+void WaterBalance::saveState(SimState& state)
+{
+    state.put(hasPastRates);
+    for (double v : volumes) state.put(v);
+    for (double r : pastRates) state.put(r);
+}
+
+void WaterBalance::restoreState(SimState& state)
+{
+    hasPastRates = state.getBool();
+    for (double& v : volumes) v = state.get();
+    for (double& r : pastRates) r = state.get();
+}
+
+//-----------------------------------------------------------------------------
+
+void WaterBalance::writeBalance(ostream& msgLog, Network* nw)
+{
+    double vcf = nw->ucf(Units::VOLUME);
+    streamsize oldPrecision = msgLog.precision();
+    msgLog << "\n  Water Balance (" << nw->getUnits(Units::VOLUME) << ")"
+           << "\n  ------------------";
+    msgLog << "\n  " << left << setw(16) << "Zone" << right;
+    for (int i = 0; i < MAX_COMPONENTS; i++)
+    {
+        msgLog << setw(14) << componentHeadings[i];
+    }
+    msgLog << setw(14) << "% Imbalance";
+
+    for (int zone = -1; zone < zoneCount(); zone++)
+    {
+        string name = "Network";
+        if ( zone >= 0 ) name = zoneNames[zone];
+        msgLog << "\n  " << left << setw(16) << name << right;
+        msgLog << fixed << setprecision(2);
+        for (int i = 0; i < MAX_COMPONENTS; i++)
+        {
+            msgLog << setw(14) << volume(zone, i) * vcf;
+        }
+
+        double vIn = volume(zone, SUPPLY) + volume(zone, TRANSFER);
+        double vOut = volume(zone, DEMAND) + volume(zone, EMITTER) +
+                      volume(zone, LEAKAGE) + volume(zone, STORAGE);
+        double pctDiff = vIn - vOut;
+        if ( vIn > 0.0 ) pctDiff = 100.0 * pctDiff / vIn;
+        else if ( vOut > 0.0 ) pctDiff = 100.0 * pctDiff / vOut;
+        else pctDiff = 0.0;
+        msgLog << setw(14) << pctDiff;
+    }
+    msgLog << "\n";
+    msgLog.unsetf(ios_base::floatfield);
+    msgLog.precision(oldPrecision);
+}
@@ -0,0 +1,97 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file waterbalance.h
+//! \brief Describes the WaterBalance class.
+
+#ifndef WATERBALANCE_H_
+#define WATERBALANCE_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+class Network;
+class Node;
+class Link;
+class SimState;
+
+//! \class WaterBalance
+//! \brief Accumulates the volumes of water entering and leaving the network.
+//!
+//! The WaterBalance structure integrates reservoir supply, transfers between
+//! zones, consumer demand, emitter outflow and pipe leakage over each hydraulic
+//! time step, using the same time weighting (theta) that the hydraulic solver
+//! applies to tank levels, and tracks the change in tank storage. Totals are
+//! kept for the whole network and for each zone (or DMA) defined by the node
+//! tags in the [TAGS] section of the input file.
+//!
+//! The flow rates of the node components are summed by the hydraulic
+//! solver's node outflow loop (see findNodeOutflows() in hydbalance.cpp) as
+//! it finds each node's outflow, so no separate pass over the nodes is made
+//! after a solution is found. When results are read from a hydraulics file
+//! the rates are found from the saved node flows instead.
+
+struct WaterBalance
+{
+    enum Component {
+        SUPPLY,            //!< inflow from reservoirs
+        TRANSFER,          //!< net inflow from other zones
+        DEMAND,            //!< consumer demand delivered
+        EMITTER,           //!< emitter outflow
+        LEAKAGE,           //!< pipe leakage
+        STORAGE,           //!< increase in tank storage
+        MAX_COMPONENTS
+    };
+
+    std::vector<std::string> zoneNames;   //!< names of the network's zones
+
+    // Zone management (a zone index of -1 refers to the whole network)
+    int       addZone(const std::string& name);
+    int       zoneIndex(const std::string& name);
+    int       zoneCount();
+    void      clear();
+
+    // Volume accounting
+    void      init(Network* nw);
+    void      update(Network* nw, int tstep);
+    void      startRates();
+    void      addNodeRates(Node* node);
+    double    volume(int zone, int component);
+    double    rate(int zone, int component);
+    void      writeBalance(std::ostream& msgLog, Network* nw);
+    void      saveState(SimState& state);
+    void      restoreState(SimState& state);
+
+  private:
+    double    theta;               //!< time weighting factor
+    bool      hasPastRates;        //!< true once a solution has been recorded
+    bool      ratesFound;          //!< true if solver has summed node rates
+    std::vector<double> volumes;   //!< accumulated volumes (ft3)
+    std::vector<double> rates;     //!< work array of current flow rates (cfs)
+    std::vector<double> pastRates; //!< flow rates at last update (cfs)
+    std::vector<double> initStorage;      //!< initial tank volume (ft3)
+    std::vector<Link*>  boundaryLinks;    //!< links joining different zones
+
+    void      findRates(Network* nw);
+    void      addTransferRates();
+    int       offset(int row, int component);
+};
+
+//-----------------------------------------------------------------------------
+//    Inline Functions
+//-----------------------------------------------------------------------------
+
+// Row 0 holds network totals while row z+1 holds the totals for zone z
+
+inline int WaterBalance::offset(int row, int component)
+       { return row * MAX_COMPONENTS + component; }
+
+inline int WaterBalance::zoneCount()
+       { return zoneNames.size(); }
+
+#endif // WATERBALANCE_H_
@@ -117,6 +117,30 @@ int Control::timeToActivate(Network* network, int t, int tod)
 
 //-----------------------------------------------------------------------------
 
+//  Finds the elapsed time (sec) after the current time t (at time of day tod)
+//  when the condition of an ELAPSED_TIME or TIME_OF_DAY control is next met,
+//  returning -1 for other types of controls or if it's never met again.
+
+int Control::nextActivationTime(int t, int tod)
+{
+    int aTime;
+    switch (type)
+    {
+    case ELAPSED_TIME:
+        if ( time > t ) return time;
+        return -1;
+
+    case TIME_OF_DAY:
+        aTime = time - tod;
+        if ( aTime <= 0 ) aTime += 86400;
+        return t + aTime;
+
+    default: return -1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 bool Control::applyPressureControls(Network* network)
 {
     bool makeChange = true;
@@ -61,9 +61,16 @@ class Control: public Element
     int     getType()
             { return type; }
 
+    // Returns the node that triggers the control
+    Node*   getNode()
+            { return node; }
+
     // Finds the time until the control is next activated
     int    timeToActivate(Network* network, int t, int tod);
 
+    // Finds the next time at which a timed control's condition is met
+    int    nextActivationTime(int t, int tod);
+
     // Checks if the control's conditions are met
     void    apply(Network* network, int t, int tod);
 
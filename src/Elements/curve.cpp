@@ -9,6 +9,8 @@
 #include "Utilities/utilities.h"
 
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
 using namespace std;
 
 //-----------------------------------------------------------------------------
@@ -20,7 +22,11 @@ const char* Curve::CurveTypeWords[] =
 
 Curve::Curve(string name_) :
     Element(name_),
-    type(UNKNOWN)
+    type(UNKNOWN),
+    finalized(false),
+    xSorted(true),
+    ySorted(true),
+    xStep(0.0)
 {}
 
 Curve::~Curve()
@@ -31,67 +37,161 @@ Curve::~Curve()
 
 //-----------------------------------------------------------------------------
 
-void Curve::findSegment(double xseg, double& slope, double& intercept)
+//  Compute the slope and intercept of each curve segment and determine how
+//  segments can be searched for.
+
+void Curve::finalize()
 {
     int n = xData.size();
-    int segment = n-1;
+    slopes.assign(n, 0.0);
+    intercepts.assign(n, 0.0);
+    inverseSlopes.assign(n, 0.0);
+    xSorted = true;
+    ySorted = true;
+    xStep = 0.0;
+    finalized = true;
+    if ( n < 2 ) return;
+
+    for (int i = 1; i < n; i++)
+    {
+        double dx = xData[i] - xData[i-1];
+        double dy = yData[i] - yData[i-1];
+        slopes[i] = dy / dx;
+        intercepts[i] = yData[i] - slopes[i] * xData[i];
+        if ( dy != 0.0 ) inverseSlopes[i] = dx / dy;
+        if ( dx < 0.0 ) xSorted = false;
+        if ( dy < 0.0 ) ySorted = false;
+    }
 
-    if (n == 1)
+    // ... check if x-values are evenly spaced
+
+    double step = (xData[n-1] - xData[0]) / (n - 1);
+    if ( !xSorted || step <= 0.0 ) return;
+    double tol = 1.0e-9 * (xData[n-1] - xData[0]);
+    for (int i = 1; i < n; i++)
     {
-        intercept = 0.0;
-        if (xData[0] == 0.0) slope = 0.0;
-        else slope = yData[0] / xData[0];
+        if ( fabs(xData[i] - xData[0] - i * step) > tol ) return;
     }
+    xStep = step;
+}
 
-    else
+//-----------------------------------------------------------------------------
+
+//  Find the first segment i (1 <= i < n) for which x <= xData[i],
+//  returning n if there is none.
+
+int Curve::findXSegment(double x, int& hint) const
+{
+    int n = xData.size();
+    if ( n < 2 ) return n;
+    if ( !xSorted )
     {
         for (int i = 1; i < n; i++)
         {
-            if (xseg <= xData[i])
-            {
-                segment = i;
-                break;
-            }
+            if ( x <= xData[i] ) return i;
         }
-        slope = (yData[segment] - yData[segment-1]) /
-                (xData[segment] - xData[segment-1]);
-        intercept = yData[segment] - slope * xData[segment];
+        return n;
     }
+    if ( x > xData[n-1] ) return n;
+
+    // ... start with the hinted segment or, for evenly spaced data,
+    //     the segment that x falls in
+
+    int i = hint;
+    if ( i < 1 || i >= n ) i = 1;
+    if ( xStep > 0.0 )
+    {
+        i = (int)ceil((x - xData[0]) / xStep);
+        i = max(1, min(i, n-1));
+    }
+
+    // ... check if x lies in this segment, otherwise use a binary search
+
+    if ( !(x <= xData[i] && (i == 1 || x > xData[i-1])) )
+    {
+        i = lower_bound(xData.begin() + 1, xData.end(), x) - xData.begin();
+    }
+    hint = i;
+    return i;
 }
 
 //-----------------------------------------------------------------------------
 
-double Curve::getYofX(double x)
-{
-    if ( x <= xData[0] ) return yData[0];
+//  Find the first segment i (1 <= i < n) for which y <= yData[i],
+//  returning n if there is none.
 
-    for (vector<double>::size_type i = 1; i < xData.size(); i++)
+int Curve::findYSegment(double y, int& hint) const
+{
+    int n = yData.size();
+    if ( n < 2 ) return n;
+    if ( !ySorted )
     {
-        if ( x <= xData[i] )
+        for (int i = 1; i < n; i++)
         {
-            double dx = xData[i] - xData[i-1];
-            if ( dx == 0.0 ) return yData[i-1];
-            return yData[i-1] + (x - xData[i-1]) / dx * (yData[i] - yData[i-1]);
+            if ( y <= yData[i] ) return i;
         }
+        return n;
+    }
+    if ( y > yData[n-1] ) return n;
+
+    int i = hint;
+    if ( i < 1 || i >= n ) i = 1;
+    if ( !(y <= yData[i] && (i == 1 || y > yData[i-1])) )
+    {
+        i = lower_bound(yData.begin() + 1, yData.end(), y) - yData.begin();
     }
-    return yData[xData.size()-1];
+    hint = i;
+    return i;
 }
 
 //-----------------------------------------------------------------------------
 
-double Curve::getXofY(double y)
-// Assumes Y is increasing with X
+//  Find the slope and intercept of the curve segment containing xseg
+//  (the curve must have been finalized).
+
+void Curve::findSegment(double xseg, double& slope, double& intercept,
+                        int& hint) const
 {
-    if ( y <= yData[0] ) return xData[0];
+    int n = xData.size();
 
-    for (vector<double>::size_type i = 1; i < yData.size(); i++)
+    if (n == 1)
     {
-    	if ( y <= yData[i] )
-    	{
-            double dy = yData[i] - yData[i-1];
-            if ( dy == 0.0 ) return xData[i-1];
-            return xData[i-1] + (y - yData[i-1]) / dy * (xData[i] - xData[i-1]);
-        }
+        intercept = 0.0;
+        if (xData[0] == 0.0) slope = 0.0;
+        else slope = yData[0] / xData[0];
     }
-    return xData[yData.size()-1];
+
+    else
+    {
+        int segment = min(findXSegment(xseg, hint), n-1);
+        slope = slopes[segment];
+        intercept = intercepts[segment];
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+double Curve::getYofX(double x, int& hint) const
+{
+    if ( x <= xData[0] ) return yData[0];
+
+    int n = xData.size();
+    int i = findXSegment(x, hint);
+    if ( i >= n ) return yData[n-1];
+    if ( xData[i] == xData[i-1] ) return yData[i-1];
+    return yData[i-1] + (x - xData[i-1]) * slopes[i];
+}
+
+//-----------------------------------------------------------------------------
+
+double Curve::getXofY(double y, int& hint) const
+// Assumes Y is increasing with X
+{
+    if ( y <= yData[0] ) return xData[0];
+
+    int n = yData.size();
+    int i = findYSegment(y, hint);
+    if ( i >= n ) return xData[n-1];
+    if ( yData[i] == yData[i-1] ) return xData[i-1];
+    return xData[i-1] + (y - yData[i-1]) * inverseSlopes[i];
 }
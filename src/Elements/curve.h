@@ -23,6 +23,13 @@
 //! Curves can be used to describe how tank volume varies with height, how
 //! pump head or efficiency varies with flow, or how a valve's head loss
 //! varies with flow.
+//!
+//! Once its data are complete a curve is finalized, which computes the slope
+//! and intercept of each of its segments. A finalized curve is not changed
+//! by look ups, so it can be read by several simulations at once. Segments
+//! are located by binary search (or directly when the x-values are evenly
+//! spaced), starting with a check of a segment hint owned by the caller
+//! (such as a tank or pump), which is updated to the segment found.
 
 //  NOTE: Curve data are stored in the user's original units.
 //-----------------------------------------------------------------------------
@@ -44,20 +51,34 @@ class Curve: public Element
     // Data provider methods
     void   setType(int curveType);
     void   addData(double x, double y);
+    void   finalize();
 
     // Data retrieval methods
     int    size();
     int    curveType();
     double x(int index);
     double y(int index);
-    void   findSegment(double xseg, double& slope, double& intercept);
-    double getYofX(double x);
-    double getXofY(double y);
+    void   findSegment(double xseg, double& slope, double& intercept,
+                       int& hint) const;
+    double getYofX(double x, int& hint) const;
+    double getXofY(double y, int& hint) const;
 
   private:
     CurveType               type;           //!< curve type
     std::vector<double>     xData;          //!< x-values
     std::vector<double>     yData;          //!< y-values
+
+    // Segment data (segment i joins points i-1 and i)
+    bool                    finalized;      //!< true if segment data are current
+    std::vector<double>     slopes;         //!< dy/dx of each segment
+    std::vector<double>     intercepts;     //!< y-intercept of each segment
+    std::vector<double>     inverseSlopes;  //!< dx/dy of each segment
+    bool                    xSorted;        //!< true if x-values never decrease
+    bool                    ySorted;        //!< true if y-values never decrease
+    double                  xStep;          //!< x spacing if uniform, else 0
+
+    int    findXSegment(double x, int& hint) const;
+    int    findYSegment(double y, int& hint) const;
 };
 
 //-----------------------------------------------------------------------------
@@ -67,14 +88,14 @@ inline  void   Curve::setType(int curveType)
                { type = (CurveType)curveType; }
 
 inline  void   Curve::addData(double x, double y)
-               { xData.push_back(x); yData.push_back(y);}
+               { xData.push_back(x); yData.push_back(y); finalized = false; }
 
 inline  int    Curve::size() { return xData.size(); }
 
 inline  int    Curve::curveType() { return (int)type; }
 
-inline  double Curve::x(int i) { return xData.at(i); }
+inline  double Curve::x(int i) { return xData[i]; }
 
-inline  double Curve::y(int i) { return yData.at(i); }
+inline  double Curve::y(int i) { return yData[i]; }
 
 #endif
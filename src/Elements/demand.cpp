@@ -16,7 +16,6 @@
 
 Demand::Demand() :
     baseDemand(0.0),
-    fullDemand(0.0),
     timePattern(nullptr)
 {
 }
@@ -26,16 +25,3 @@ Demand::Demand() :
 //  Demand Destructor
 
 Demand::~Demand() {}
-
-//-----------------------------------------------------------------------------
-
-//    Find pattern-adjusted full demand
-
-double Demand::getFullDemand(double multiplier, double patternFactor)
-{
-    if ( timePattern ) patternFactor = timePattern->currentFactor();
-	
-	fullDemand = multiplier * baseDemand * patternFactor;
-	
-    return fullDemand;
-}
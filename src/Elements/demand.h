@@ -25,10 +25,7 @@ class Demand
     Demand();
     ~Demand();
 
-    double   getFullDemand(double multiplier, double patternFactor);
-
     double   baseDemand;          //!< baseline demand flow (cfs)
-    double   fullDemand;          //!< pattern adjusted demand flow (cfs)
     Pattern* timePattern;         //!< time pattern used to adjust baseline demand
 };
 
@@ -20,7 +20,7 @@ class Element
 {
   public:
 
-    enum ElementType {NODE, LINK, PATTERN, CURVE, CONTROL};
+    enum ElementType {NODE, LINK, PATTERN, CURVE, CONTROL, RULE};
 
     Element(std::string name_);
     virtual ~Element() = 0;
@@ -9,6 +9,7 @@
 #include "emitter.h"
 #include "Core/network.h"
 #include "Core/constants.h"
+#include "Core/simstate.h"
 #include "Models/demandmodel.h"
 
 using namespace std;
@@ -20,7 +21,8 @@ Junction::Junction(string name_) :
 Node(name_),
 pMin(MISSING),
 pFull(MISSING),
-emitter(nullptr)
+emitter(nullptr),
+demandStatus(0)
 //pastHead(0.0),
 //ph(0.0)
 {
@@ -89,40 +91,39 @@ void Junction::initialize(Network* nw)
 	ph = elev + (pFull - pMin) / 2.0;       // synonym of past head
     quality = initQual;
     actualDemand = 0.0;
+    emitterFlow = 0.0;
+    leakage = 0.0;
     outflow = 0.0;
     fixedGrade = false;
+    demandStatus = 0;
 }
 
 
 //-----------------------------------------------------------------------------
-//    Find a junction's full demand
+//    Find a junction's actual demand flow and its derivative w.r.t. head
 //-----------------------------------------------------------------------------
-void Junction::findFullDemand(double multiplier, double patternFactor)
+double Junction::findActualDemand(Network* nw, double h, double &dqdh)
 {
-    fullDemand = 0.0;
-    for (Demand demand : demands)
-    {
-        fullDemand += demand.getFullDemand(multiplier, patternFactor);
-    }
-    actualDemand = fullDemand;
+    return nw->demandModel->findDemand(this, h-elev, dqdh);
 }
 
 
 //-----------------------------------------------------------------------------
-//    Find a junction's actual demand flow and its derivative w.r.t. head
+//    Set whether the junction's demand is constrained by its pressure
+//    at the start of a time period
 //-----------------------------------------------------------------------------
-double Junction::findActualDemand(Network* nw, double h, double &dqdh)
+void Junction::initDemandStatus(Network* nw)
 {
-    return nw->demandModel->findDemand(this, h-elev, dqdh);
+    nw->demandModel->initDemandStatus(this);
 }
 
 
 //-----------------------------------------------------------------------------
-//    Determine if there is not enough pressure to supply junction's demand
+//    Update whether the junction's demand is constrained by its pressure
 //-----------------------------------------------------------------------------
-bool Junction::isPressureDeficient(Network* nw)
+bool Junction::updateDemandStatus(Network* nw)
 {
-    return nw->demandModel->isPressureDeficient(this);
+    return nw->demandModel->updateDemandStatus(this);
 }
 
 
@@ -136,3 +137,23 @@ double Junction::findEmitterFlow(double h, double& dqdh)
     if ( emitter) return emitter->findFlowRate(h-elev, dqdh);
     return 0;
 }
+
+
+//-----------------------------------------------------------------------------
+//    Save and restore the junction's dynamic state
+//-----------------------------------------------------------------------------
+void Junction::saveState(SimState& state)
+{
+    Node::saveState(state);
+    state.put(pastHead);
+    state.put(ph);
+    state.put(demandStatus);
+}
+
+void Junction::restoreState(SimState& state)
+{
+    Node::restoreState(state);
+    pastHead = state.get();
+    ph = state.get();
+    demandStatus = state.getInt();
+}
@@ -33,10 +33,12 @@ class Junction: public Node
     int    type() { return Node::JUNCTION; }
     void   convertUnits(Network* nw);
     void   initialize(Network* nw);
-    void   findFullDemand(double multiplier, double patternFactor);
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
     double findActualDemand(Network* nw, double h, double& dqdh);
     double findEmitterFlow(double h, double& dqdh);
-    bool   isPressureDeficient(Network* nw);
+    void   initDemandStatus(Network* nw);
+    bool   updateDemandStatus(Network* nw);
     bool   hasEmitter() { return emitter != nullptr; }
 
     Demand            primaryDemand;   //!< primary demand
@@ -44,6 +46,7 @@ class Junction: public Node
     double            pMin;            //!< minimum pressure head to have demand (ft)
     double            pFull;           //!< pressure head required for full demand (ft)
     Emitter*          emitter;         //!< emitter object
+    int               demandStatus;    //!< pressure constraint on demand
 	double            pastHead;        //!< Head on the previous time step
 	double            ph;             //!< synonym of past head
 };
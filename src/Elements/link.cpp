@@ -6,11 +6,13 @@
  */
 
 #include "link.h"
+#include "node.h"
 #include "pipe.h"
 #include "pump.h"
 #include "valve.h"
 #include "Core/constants.h"
 #include "Core/network.h"
+#include "Core/simstate.h"
 #include "Utilities/mempool.h"
 
 #include <cmath>
@@ -93,6 +95,42 @@ void Link::initialize(bool reInitFlow)
 
 //-----------------------------------------------------------------------------
 
+void Link::saveState(SimState& state)
+{
+    state.put(status);
+    state.put(previousStatus);
+    state.put(flow);
+    state.put(pastFlow);
+    state.put(leakage);
+    state.put(hLoss);
+    state.put(pastHloss);
+    state.put(hGrad);
+    state.put(setting);
+    state.put(pastSetting);
+    state.put(quality);
+    state.put(inertialTerm);
+}
+
+//-----------------------------------------------------------------------------
+
+void Link::restoreState(SimState& state)
+{
+    status = state.getInt();
+    previousStatus = state.getInt();
+    flow = state.get();
+    pastFlow = state.get();
+    leakage = state.get();
+    hLoss = state.get();
+    pastHloss = state.get();
+    hGrad = state.get();
+    setting = state.get();
+    pastSetting = state.get();
+    quality = state.get();
+    inertialTerm = state.get();
+}
+
+//-----------------------------------------------------------------------------
+
 double Link::getUnitHeadLoss()
 {
     return hLoss;
@@ -100,6 +138,15 @@ double Link::getUnitHeadLoss()
 
 //-----------------------------------------------------------------------------
 
+//  Checks if either end node of the link is cut off from all water sources.
+
+bool Link::isIsolated()
+{
+    return fromNode->isolated || toNode->isolated;
+}
+
+//-----------------------------------------------------------------------------
+
 string Link::writeStatusChange(int oldStatus)
 {
     stringstream ss;
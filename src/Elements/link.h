@@ -20,6 +20,7 @@
 class Node;
 class Network;
 class MemPool;
+class SimState;
 
 //! \class Link
 //! \brief A conveyance element that connects two nodes together.
@@ -56,6 +57,10 @@ class Link: public Element
     virtual void   setResistance(Network* nw) {}
 	virtual void   setLossFactor() {}
 
+    // Saves and restores variables that change during a simulation
+    virtual void   saveState(SimState& state);
+    virtual void   restoreState(SimState& state);
+
     // Retrieves hydraulic variables
     virtual double getVelocity() {return 0.0;}
     virtual double getRe(const double q, const double viscos) {return 0.0;}
@@ -63,11 +68,10 @@ class Link: public Element
     virtual double getUnitHeadLoss();
     virtual double getSetting(Network* nw) { return setting; }
 
-    // Computes head loss, energy usage, and leakage
+    // Computes head loss and energy usage
 	virtual void   findHeadLoss(Network* nw, double q) = 0;
     virtual double updateEnergyUsage(Network* nw, int dt) { return 0.0; }
     virtual bool   canLeak() { return false; }
-    virtual double findLeakage(Network* nw, double h, double& dqdh) { return 0.0; }
 
 
     // Determines special types of links
@@ -91,6 +95,11 @@ class Link: public Element
     virtual void   applyControlPattern(std::ostream& msgLog) { }
     std::string    writeStatusChange(int oldStatus);
 
+    // Used to find parts of the network cut off from all water sources
+    // (a link is shut off if it is closed and the solver can't reopen it)
+    virtual bool   isShutOff() { return status == LINK_CLOSED; }
+    bool           isIsolated();
+
     // Used for water quality routing
     virtual double getVolume() { return 0.0; }
 
@@ -10,6 +10,7 @@
 #include "reservoir.h"
 #include "tank.h"
 #include "qualsource.h"
+#include "Core/simstate.h"
 #include "Utilities/mempool.h"
 
 using namespace std;
@@ -26,7 +27,9 @@ Node::Node(string name_) :
     yCoord(-1e20),
     initQual(0.0),
     qualSource(nullptr),
+    zone(-1),
     fixedGrade(false),
+    isolated(false),
     head(0.0),
 	h1ini(0.0),
 	h2ini(0.0),
@@ -35,6 +38,8 @@ Node::Node(string name_) :
     qGrad(0.0),
     fullDemand(0.0),
     actualDemand(0.0),
+    emitterFlow(0.0),
+    leakage(0.0),
     outflow(0.0),
     quality(0.0)
 {}
@@ -80,7 +85,60 @@ void Node::initialize(Network* nw)
     quality = initQual;
     if ( qualSource ) qualSource->quality = quality;
     actualDemand = 0.0;
+    emitterFlow = 0.0;
+    leakage = 0.0;
     outflow = 0.0;
     if ( type() == JUNCTION ) fixedGrade = false;
     else fixedGrade = true;
+    isolated = false;
+}
+
+//-----------------------------------------------------------------------------
+
+void Node::saveState(SimState& state)
+{
+    state.put(fixedGrade);
+    state.put(head);
+    state.put(h1ini);
+    state.put(h2ini);
+    state.put(pastHead);
+    state.put(ph);
+    state.put(qGrad);
+    state.put(fullDemand);
+    state.put(actualDemand);
+    state.put(emitterFlow);
+    state.put(leakage);
+    state.put(outflow);
+    state.put(quality);
+    if ( qualSource )
+    {
+        state.put(qualSource->strength);
+        state.put(qualSource->outflow);
+        state.put(qualSource->quality);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Node::restoreState(SimState& state)
+{
+    fixedGrade = state.getBool();
+    head = state.get();
+    h1ini = state.get();
+    h2ini = state.get();
+    pastHead = state.get();
+    ph = state.get();
+    qGrad = state.get();
+    fullDemand = state.get();
+    actualDemand = state.get();
+    emitterFlow = state.get();
+    leakage = state.get();
+    outflow = state.get();
+    quality = state.get();
+    if ( qualSource )
+    {
+        qualSource->strength = state.get();
+        qualSource->outflow = state.get();
+        qualSource->quality = state.get();
+    }
 }
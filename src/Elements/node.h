@@ -19,6 +19,7 @@ class Network;
 class Emitter;
 class QualSource;
 class MemPool;
+class SimState;
 
 //! \class Node
 //! \brief A connection point between links in a network.
@@ -42,12 +43,16 @@ class Node: public Element
     virtual void   convertUnits(Network* nw) = 0;
     virtual void   initialize(Network* nw);
 
+    // Saves and restores variables that change during a simulation
+    virtual void   saveState(SimState& state);
+    virtual void   restoreState(SimState& state);
+
     // Overridden for Junction nodes
-    virtual void   findFullDemand(double multiplier, double patternFactor) { }
     virtual double findActualDemand(Network* nw, double h, double& dqdh) { return 0; }
     virtual double findEmitterFlow(double h, double& dqdh) { return 0; }
     virtual void   setFixedGrade() { fixedGrade = false; }
-    virtual bool   isPressureDeficient(Network* nw) { return false; }
+    virtual void   initDemandStatus(Network* nw) { }
+    virtual bool   updateDemandStatus(Network* nw) { return false; }
     virtual bool   hasEmitter() { return false; }
 
     // Overridden for Tank nodes
@@ -65,9 +70,11 @@ class Node: public Element
     double         yCoord;        //!< Y-coordinate
     double         initQual;      //!< initial water quality concen.
     QualSource*    qualSource;    //!< water quality source information
+    int            zone;          //!< index of water balance zone (-1 if none)
 
     // Computed Variables
     bool           fixedGrade;    //!< fixed grade status
+    bool           isolated;      //!< true if cut off from all water sources
     double         head;          //!< hydraulic head (ft)
 	double         h1ini;         //!< hydraulic head of upstream node in the initial moment of iteration
 	double         h2ini;         //!< hydraulic head of downstream node in the initial moment of iteration
@@ -78,6 +85,8 @@ class Node: public Element
     double         qGrad;         //!< gradient of outflow w.r.t. head (cfs/ft)
     double         fullDemand;    //!< full demand required (cfs)
     double         actualDemand;  //!< actual demand delivered (cfs)
+    double         emitterFlow;   //!< emitter outflow (cfs)
+    double         leakage;       //!< pipe leakage assigned to node (cfs)
     double         outflow;       //!< demand + emitter + leakage flow (cfs)
     double         quality;       //!< water quality concen. (mass/ft3)
 };
@@ -6,6 +6,7 @@
  */
 
 #include "pattern.h"
+#include "Core/simstate.h"
 #include "Utilities/mempool.h"
 
 #include <limits>
@@ -56,6 +57,20 @@ double Pattern::currentFactor()
     return factors[currentIndex];
 }
 
+//-----------------------------------------------------------------------------
+
+//  Save and restore the Pattern's current time period.
+
+void Pattern::saveState(SimState& state)
+{
+    state.put(currentIndex);
+}
+
+void Pattern::restoreState(SimState& state)
+{
+    currentIndex = state.getInt();
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
@@ -86,12 +101,13 @@ void FixedPattern::init(int intrvl, int tStart)
 
 //-----------------------------------------------------------------------------
 
-//  Finds the time (sec) until the next change in a FixedPattern.
+//  Finds the elapsed time (sec) of the next change in a FixedPattern after
+//  time t (periods are counted from the pattern's start time).
 
 int FixedPattern::nextTime(int t)
 {
     int nPeriods = (startTime + t) / interval;
-    return (nPeriods + 1) * interval;
+    return (nPeriods + 1) * interval - startTime;
 }
 
 //-----------------------------------------------------------------------------
@@ -135,7 +151,7 @@ void VariablePattern::init(int intrvl, int tstart)
 
 //-----------------------------------------------------------------------------
 
-//  Finds the time (sec) until the next change in a VariablePattern.
+//  Finds the elapsed time (sec) of the next change in a VariablePattern.
 
 int VariablePattern::nextTime(int t)
 {
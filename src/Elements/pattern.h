@@ -17,6 +17,7 @@
 #include <vector>
 
 class MemPool;
+class SimState;
 
 //! \class Pattern
 //! \brief A set of multiplier factors associated with points in time.
@@ -49,6 +50,8 @@ class Pattern: public Element
     virtual void   init(int intrvl, int tstart) = 0;
     virtual int    nextTime(int t) = 0;
     virtual void   advance(int t) = 0;
+    void           saveState(SimState& state);
+    void           restoreState(SimState& state);
 
     // Properties
     int            type;                //!< type of time pattern
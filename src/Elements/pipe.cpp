@@ -149,14 +149,6 @@ void Pipe::findHeadLoss(Network* nw, double q)
 }
 
 
-//-----------------------------------------------------------------------------
-
-double Pipe::findLeakage(Network* nw, double h, double& dqdh)
-{
-    return nw->leakageModel->findFlow(leakCoeff1, leakCoeff2, length, h, dqdh);
-}
-
-
 //-----------------------------------------------------------------------------
 
 bool Pipe::changeStatus(int s, bool makeChange, const string reason, ostream& msgLog)
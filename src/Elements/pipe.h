@@ -50,7 +50,6 @@ class Pipe: public Link
 
 	void        findHeadLoss(Network* nw, double q);
     bool        canLeak() { return leakCoeff1 > 0.0; }
-    double      findLeakage(Network* nw, double h, double& dqdh);
     bool        changeStatus(int s, bool makeChange,
                             const std::string reason,
                             std::ostream& msgLog);
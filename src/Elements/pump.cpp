@@ -10,6 +10,7 @@
 #include "Core/constants.h"
 #include "Core/network.h"
 #include "Core/error.h"
+#include "Core/simstate.h"
 #include "Models/headlossmodel.h"
 
 using namespace std;
@@ -68,6 +69,35 @@ void Pump::setInitSetting(double s)
 
 //-----------------------------------------------------------------------------
 
+//  Save and restore the pump's speed and accumulated energy usage along
+//  with its hydraulic state.
+
+void Pump::saveState(SimState& state)
+{
+    Link::saveState(state);
+    state.put(speed);
+    state.put(pumpEnergy.hrsOnLine);
+    state.put(pumpEnergy.efficiency);
+    state.put(pumpEnergy.kwHrsPerCFS);
+    state.put(pumpEnergy.kwHrs);
+    state.put(pumpEnergy.maxKwatts);
+    state.put(pumpEnergy.totalCost);
+}
+
+void Pump::restoreState(SimState& state)
+{
+    Link::restoreState(state);
+    speed = state.get();
+    pumpEnergy.hrsOnLine = state.get();
+    pumpEnergy.efficiency = state.get();
+    pumpEnergy.kwHrsPerCFS = state.get();
+    pumpEnergy.kwHrs = state.get();
+    pumpEnergy.maxKwatts = state.get();
+    pumpEnergy.totalCost = state.get();
+}
+
+//-----------------------------------------------------------------------------
+
 void Pump::setInitFlow()
 {
     // ... initial flow is design point of pump curve
@@ -43,6 +43,8 @@ class Pump: public Link
     void        setInitFlow();
     void        setInitStatus(int s);
     void        setInitSetting(double s);
+    void        saveState(SimState& state);
+    void        restoreState(SimState& state);
 
     double      getSetting(Network* nw) { return speed; }
 
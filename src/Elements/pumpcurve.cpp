@@ -34,7 +34,8 @@ PumpCurve::PumpCurve() :
     r(0.0),
     n(0.0),
     qUcf(1.0),
-    hUcf(1.0)
+    hUcf(1.0),
+    segment(1)
 {
 }
 
@@ -257,7 +258,7 @@ void PumpCurve::customCurveHeadLoss(
 
     // ... find slope and intercept of curve segment
 
-    curve->findSegment(q / speed, r, h0);
+    curve->findSegment(q / speed, r, h0, segment);
 
     // ... adjust slope and intercept for pump speed
 
@@ -54,6 +54,7 @@ class PumpCurve
     double n;              //!< flow exponent for power function curve
     double qUcf;           //!< flow units conversion factor
     double hUcf;           //!< head units conversion factor
+    int    segment;        //!< custom curve segment of last look up
 
     void   setupConstHpCurve();
     int    setupPowerFuncCurve();
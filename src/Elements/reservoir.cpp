@@ -8,6 +8,7 @@
 #include "reservoir.h"
 #include "pattern.h"
 #include "Core/network.h"
+#include "Core/simstate.h"
 
 using namespace std;
 
@@ -47,3 +48,19 @@ void Reservoir::setFixedGrade()
     head = elev * f;
     fixedGrade = true;
 }
+
+//-----------------------------------------------------------------------------
+
+void Reservoir::saveState(SimState& state)
+{
+    Node::saveState(state);
+    state.put(pastHead);
+    state.put(ph);
+}
+
+void Reservoir::restoreState(SimState& state)
+{
+    Node::restoreState(state);
+    pastHead = state.get();
+    ph = state.get();
+}
@@ -36,6 +36,8 @@ class Reservoir: public Node
     int      type() { return Node::RESERVOIR; }
     void     convertUnits(Network* nw);
     void     setFixedGrade();
+    void     saveState(SimState& state);
+    void     restoreState(SimState& state);
 	double   pastHead;               //!< water elev. in previous time period (ft)
 	double   ph;                     //!< synonym of past head
 
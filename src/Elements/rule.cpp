@@ -0,0 +1,82 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "rule.h"
+#include "node.h"
+#include "link.h"
+#include "Core/network.h"
+#include "Utilities/utilities.h"
+
+#include <sstream>
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+const char* Rule::VariableWords[] =
+    {"DEMAND", "HEAD", "GRADE", "LEVEL", "PRESSURE", "FLOW", "STATUS",
+     "SETTING", "FILLTIME", "DRAINTIME", "TIME", "CLOCKTIME", 0};
+
+const char* Rule::RelationWords[] = {"=", "<>", "<=", ">=", "<", ">", 0};
+
+const char* Rule::StatusWords[] = {"CLOSED", "OPEN", "ACTIVE", 0};
+
+static const char* logicOpWords[] = {"IF", "AND", "OR"};
+
+//-----------------------------------------------------------------------------
+
+Rule::Rule(string name_) :
+    Element(name_),
+    priority(0.0)
+{
+}
+
+Rule::~Rule() {}
+
+//-----------------------------------------------------------------------------
+
+//  Produces a string representation of a rule in input file format.
+
+string Rule::toStr(Network* nw)
+{
+    stringstream s;
+    s << "RULE " << name << "\n";
+
+    for (Premise& p : premises)
+    {
+        s << logicOpWords[p.logicOp] << " ";
+        if ( p.objType == NODE_OBJ )      s << "NODE " << p.object->name << " ";
+        else if ( p.objType == LINK_OBJ ) s << "LINK " << p.object->name << " ";
+        else                              s << "SYSTEM ";
+        s << VariableWords[p.variable] << " " << RelationWords[p.relation] << " ";
+        if ( p.status != NO_STATUS )    s << StatusWords[p.status];
+        else if ( p.variable == TIME || p.variable == CLOCKTIME )
+        {
+            s << Utilities::getTime((int)p.value);
+        }
+        else s << p.value;
+        s << "\n";
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        vector<Action>& actions = (i == 0) ? thenActions : elseActions;
+        for (unsigned j = 0; j < actions.size(); j++)
+        {
+            Action& a = actions[j];
+            if ( j > 0 ) s << "AND ";
+            else s << (i == 0 ? "THEN " : "ELSE ");
+            s << "LINK " << a.link->name << " ";
+            if ( a.status != NO_STATUS ) s << "STATUS IS " << StatusWords[a.status];
+            else s << "SETTING IS " << a.setting;
+            s << "\n";
+        }
+    }
+
+    if ( priority != 0.0 ) s << "PRIORITY " << priority << "\n";
+    return s.str();
+}
@@ -0,0 +1,84 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file rule.h
+//! \brief Describes the Rule class.
+
+#ifndef RULE_H_
+#define RULE_H_
+
+#include "Elements/element.h"
+
+#include <string>
+#include <vector>
+
+class Link;
+class Network;
+
+//! \class Rule
+//! \brief A rule-based control that changes pumps and valves when a
+//!        combination of conditions holds.
+//!
+//! A rule is read from the [RULES] section of an input file in the form
+//!   RULE  id
+//!   IF    condition
+//!   AND/OR condition ...
+//!   THEN  action
+//!   AND   action ...
+//!   ELSE  action
+//!   AND   action ...
+//!   PRIORITY value
+//! where a condition compares a node, link or system variable with a value
+//! and an action sets a link's status or setting. Its conditions and actions
+//! are held here in the units they were read in; the RuleEngine compiles
+//! them into the form used during a simulation.
+
+class Rule: public Element
+{
+  public:
+
+    enum ObjectType {NODE_OBJ, LINK_OBJ, SYSTEM_OBJ};
+    enum Variable   {DEMAND, HEAD, GRADE, LEVEL, PRESSURE, FLOW, STATUS,
+                     SETTING, FILLTIME, DRAINTIME, TIME, CLOCKTIME};
+    enum Relation   {EQ, NE, LE, GE, LT, GT};
+    enum LogicOp    {IF, AND, OR};
+    enum StatusType {CLOSED_STATUS, OPEN_STATUS, ACTIVE_STATUS, NO_STATUS};
+
+    struct Premise
+    {
+        int      logicOp;     //!< how premise joins those before it
+        int      objType;     //!< type of object the premise refers to
+        Element* object;      //!< node or link (nullptr for the system)
+        int      variable;    //!< variable being compared
+        int      relation;    //!< relational operator
+        int      status;      //!< status compared to (or NO_STATUS)
+        double   value;       //!< value compared to (user units or sec)
+    };
+
+    struct Action
+    {
+        Link*    link;        //!< link whose status or setting is changed
+        int      status;      //!< new status (or NO_STATUS)
+        double   setting;     //!< new setting (user units)
+    };
+
+    static const char* VariableWords[];
+    static const char* RelationWords[];
+    static const char* StatusWords[];
+
+    Rule(std::string name_);
+    ~Rule();
+
+    std::string toStr(Network* network);
+
+    std::vector<Premise> premises;     //!< conditions in the IF clause
+    std::vector<Action>  thenActions;  //!< actions taken if premises hold
+    std::vector<Action>  elseActions;  //!< actions taken if they don't
+    double               priority;     //!< priority over conflicting rules
+};
+
+#endif
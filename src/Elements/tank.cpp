@@ -10,6 +10,7 @@
 #include "Core/network.h"
 #include "Core/constants.h"
 #include "Core/error.h"
+#include "Core/simstate.h"
 
 #include <algorithm>
 using namespace std;
@@ -27,6 +28,8 @@ Tank::Tank(string name_) :
     minVolume(0.0),
     bulkCoeff(MISSING),
     volCurve(nullptr),
+    depthSegment(1),
+    volumeSegment(1),
     maxVolume(0.0),
     volume(0.0),
     area(0.0),
@@ -134,7 +137,7 @@ double Tank::findVolume(double aHead)
 
         depth *= ucfLength;
         double slope, intercept;
-        volCurve->findSegment(depth, slope, intercept);
+        volCurve->findSegment(depth, slope, intercept, depthSegment);
 
         // ... compute volume and convert to ft3
 
@@ -163,7 +166,7 @@ void Tank::updateArea()
 
         double slope, intercept;
         double depth = head - elev;
-        volCurve->findSegment(depth*ucfLength, slope, intercept);
+        volCurve->findSegment(depth*ucfLength, slope, intercept, depthSegment);
 
         // ... curve segment slope (dV/dy) is avg. area over interval;
         //     convert to internal units
@@ -186,7 +189,7 @@ double Tank::findHead(double aVolume)
     {
         double ucfArea = ucfLength * ucfLength;
         aVolume *= ucfArea * ucfLength;
-        return elev + volCurve->getXofY(aVolume) / ucfLength;
+        return elev + volCurve->getXofY(aVolume, volumeSegment) / ucfLength;
     }
 
     // ... tank is cylindrical
@@ -269,3 +272,30 @@ void Tank::setFixedGrade()
     fixedGrade = true;
     //head = findHead(volume);
 }
+
+//-----------------------------------------------------------------------------
+
+//  Save and restore the tank's dynamic state (the state of its mixing
+//  model is handled by the water quality solver that owns its segments).
+
+void Tank::saveState(SimState& state)
+{
+    Node::saveState(state);
+    state.put(volume);
+    state.put(area);
+    state.put(pastHead);
+    state.put(pastVolume);
+    state.put(pastArea);
+    state.put(pastOutflow);
+}
+
+void Tank::restoreState(SimState& state)
+{
+    Node::restoreState(state);
+    volume = state.get();
+    area = state.get();
+    pastHead = state.get();
+    pastVolume = state.get();
+    pastArea = state.get();
+    pastOutflow = state.get();
+}
@@ -37,6 +37,8 @@ class Tank: public Node
     void   validate(Network* nw);
     void   convertUnits(Network* nw);
     void   initialize(Network* nw);
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
     bool   isReactive() { return bulkCoeff != 0.0; }
     bool   isFull()     { return head >= maxHead; }
     bool   isEmpty()    { return head <= minHead; }
@@ -59,6 +61,8 @@ class Tank: public Node
     double minVolume;              //!< minimum volume (ft3)
     double bulkCoeff;              //!< water quality reaction coeff. (per day)
     Curve* volCurve;               //!< volume v. water depth curve
+    int    depthSegment;           //!< volCurve segment of last depth look up
+    int    volumeSegment;          //!< volCurve segment of last volume look up
     TankMixModel mixingModel;      //!< mixing model used
 
     double maxVolume;              //!< maximum volume (ft3)
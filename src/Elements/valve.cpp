@@ -12,6 +12,7 @@
 #include "curve.h"
 #include "Core/network.h"
 #include "Core/constants.h"
+#include "Core/simstate.h"
 #include "Models/headlossmodel.h"
 
 #include <cmath>
@@ -37,8 +38,17 @@ Valve::Valve(string name_) :
     lossFactor(0.0),
 	remoteNode(nullptr),
 	settingPattern(0),
+    dprvOutletPressure(0.0),
+    Xm(0.0),
+    delta_Xm(0.0),
+    Xm_Last(0.0),
+    errorValve(0.0),
+    errorSumValve(0.0),
+    errorDifValve(0.0),
+    errorPreValve(0.0),
     hasFixedStatus(false),
-    elev(0.0)
+    elev(0.0),
+    curveSegment(1)
 {
     initStatus = VALVE_ACTIVE;
     initSetting = 0;
@@ -144,6 +154,39 @@ void Valve::initialize(bool reInitFlow)
 
 //-----------------------------------------------------------------------------
 
+//  Save and restore a valve's state, including the opening and controller
+//  errors of a dynamic pressure reducing valve.
+
+void Valve::saveState(SimState& state)
+{
+    Link::saveState(state);
+    state.put(hasFixedStatus);
+    state.put(dprvOutletPressure);
+    state.put(Xm);
+    state.put(delta_Xm);
+    state.put(Xm_Last);
+    state.put(errorValve);
+    state.put(errorSumValve);
+    state.put(errorDifValve);
+    state.put(errorPreValve);
+}
+
+void Valve::restoreState(SimState& state)
+{
+    Link::restoreState(state);
+    hasFixedStatus = state.getBool();
+    dprvOutletPressure = state.get();
+    Xm = state.get();
+    delta_Xm = state.get();
+    Xm_Last = state.get();
+    errorValve = state.get();
+    errorSumValve = state.get();
+    errorDifValve = state.get();
+    errorPreValve = state.get();
+}
+
+//-----------------------------------------------------------------------------
+
 //  Initialize a valve's flow rate.
 
 void Valve::setInitFlow()
@@ -469,7 +512,7 @@ void Valve::findGpvHeadLoss(Network* nw, double q)
 
     double qRaw = abs(q) * ucfFlow;
     double r, h0;
-    curve->findSegment(qRaw, r, h0);
+    curve->findSegment(qRaw, r, h0, curveSegment);
 
     // ... convert to internal units
 
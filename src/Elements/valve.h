@@ -64,9 +64,12 @@ class Valve: public Link
     void        setInitSetting(double s);
 	void		setLossFactor();
     void        initialize(bool initFlow);
+    void        saveState(SimState& state);
+    void        restoreState(SimState& state);
 
     bool        isPRV();
     bool        isPSV();
+    bool        isShutOff();
 
 	void        findHeadLoss(Network* nw, double q);
     void        updateStatus(double q, double h1, double h2);
@@ -123,6 +126,7 @@ class Valve: public Link
 
     bool        hasFixedStatus;   //!< true if Open/Closed status is fixed
     double      elev;             //!< elevation of PRV/PSV valve
+    int         curveSegment;     //!< GPV curve segment of last look up
 };
 
 //-----------------------------------------------------------------------------
@@ -138,4 +142,7 @@ bool Valve::isPRV() { return valveType == PRV; }
 inline
 bool Valve::isPSV() { return valveType == PSV; }
 
+inline
+bool Valve::isShutOff() { return hasFixedStatus && status == LINK_CLOSED; }
+
 #endif
@@ -5,9 +5,6 @@
  *
  */
 
- // TO DO:
- // - add support for Rule-Based controls
-
 #include "inputparser.h"
 #include "inputreader.h"
 #include "Core/network.h"
@@ -24,11 +21,15 @@ using namespace std;
 //  Input File Keywords
 //-----------------------------------------------------------------------------
 static const char* w_Pump = "PUMP";
-//static const char* w_Rule = "RULE";
+static const char* w_Rule = "RULE";
 static const char* w_Variable = "VARIABLE";
 static const char* w_Bulk = "BULK";
 static const char* w_Wall = "WALL";
 static const char* w_Tank = "TANK";
+static const char* w_Node = "NODE";
+static const char* w_Solver = "SOLVER";
+static const char* w_Tolerance = "TOLERANCE";
+static const char* w_Trace = "TRACE";
 
 //-----------------------------------------------------------------------------
 
@@ -191,24 +192,33 @@ void ObjectParser::parseLine(string& line, int section)
         }
         break;
 
-/*
+    case InputReader::SPECIES:
+        // A species can appear on several lines
+        network->speciesModel.addSpecies(s1);
+        break;
+
     case InputReader::RULE:
         // Check for Rule keyword
-        if (Utilities::match(s1, w_Rule))
+        if ( Utilities::match(s1, w_Rule) )
         {
             // Parse rule's name
-            sin >> s2;
-            if (sin.fail()) return InputError::TOO_FEW_ITEMS;
+            vector<string> ruleTokens = Utilities::split(line);
+            if ( ruleTokens.size() < 2 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+            s2 = ruleTokens[1];
 
             // Check if rule with same name already exists
-            if (network->indexOf(Element::CONTROL, s2) >= 0)
-                return InputError::DUPLICATE_ID;
+            if ( network->indexOf(Element::RULE, s2) >= 0 )
+            {
+                throw InputError(InputError::DUPLICATE_ID, s2);
+            }
 
             // Add new rule
-            network->addElement(Element::CONTROL, s2);
+            if ( !network->addElement(Element::RULE, 0, s2) )
+            {
+                throw InputError(InputError::CANNOT_CREATE_OBJECT, s2);
+            }
         }
         break;
-*/
     }
 }
 
@@ -244,6 +254,14 @@ void PropertyParser::parseLine(string& line, int section)
 	    return;
     }
 
+    // ... for Rule, apply rule parser
+
+    if ( section == InputReader::RULE )
+    {
+        ruleParser.parseRuleLine(line, network);
+        return;
+    }
+
     // ... split the input line into an array of string tokens
 
     tokens.clear();
@@ -281,10 +299,6 @@ void PropertyParser::parseLine(string& line, int section)
             curveParser.parseCurveData(network->curve(id), tokens);
 	        break;
 
-        // Rules
-        case InputReader::RULE:
-            break;
-
         // Node properties
         case InputReader::EMITTER:
         case InputReader::DEMAND:
@@ -329,6 +343,19 @@ void PropertyParser::parseLine(string& line, int section)
         case InputReader::REPORT:
             optionParser.parseReportOption(network, tokens);
             break;
+
+        // Object tags
+        case InputReader::TAG:
+            parseTagProperty(id);
+            break;
+
+        // Additional water quality species and their reaction kinetics
+        case InputReader::SPECIES:
+            parseSpecies();
+            break;
+        case InputReader::KINETICS:
+            parseKinetics();
+            break;
     }
 }
 
@@ -363,6 +390,9 @@ void PropertyParser::parseNodeProperty(int type, string& nodeName)
         case InputReader::REACTION:
             nodeParser.parseTankReact(node, tokens);
             break;
+        case InputReader::TAG:
+            nodeParser.parseZoneTag(node, network, tokens);
+            break;
     }
 }
 
@@ -405,3 +435,112 @@ void PropertyParser::parseReactProperty(string& reactType)
     }
     else optionParser.parseReactOption(network, tokens);
 }
+
+//-----------------------------------------------------------------------------
+
+//  Read an object's tag from an input stream (node tags define the zones
+//  used for water balance accounting while link tags are ignored).
+
+void PropertyParser::parseTagProperty(string& objType)
+{
+    if ( tokens.size() < 3 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    string name = tokens[1];
+    if ( Utilities::match(objType, w_Node) )
+    {
+        parseNodeProperty(InputReader::TAG, name);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Read the initial quality (or traced source) of a water quality species
+//  from an input stream
+
+void PropertyParser::parseSpecies()
+{
+    // Contents of tokens are:
+    // 0 - species name
+    // 1 - initial quality at all nodes
+    // or:
+    // 1 - node ID
+    // 2 - initial quality at this node
+    // or:
+    // 1 - TRACE keyword
+    // 2 - ID of the node whose flow the species traces
+
+    if ( tokens.size() < 2 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    if ( tokens.size() > 2 && Utilities::upperCase(tokens[1]) == w_Trace )
+    {
+        int node = network->indexOf(Element::NODE, tokens[2]);
+        if ( node < 0 ) throw InputError(InputError::UNDEFINED_OBJECT, tokens[2]);
+        if ( !network->speciesModel.setTraceNode(tokens[0], node) )
+        {
+            throw InputError(InputError::UNDEFINED_OBJECT, tokens[0]);
+        }
+        return;
+    }
+
+    int node = -1;
+    string* value = &tokens[1];
+    if ( tokens.size() > 2 )
+    {
+        node = network->indexOf(Element::NODE, tokens[1]);
+        if ( node < 0 ) throw InputError(InputError::UNDEFINED_OBJECT, tokens[1]);
+        value = &tokens[2];
+    }
+
+    double x;
+    if ( !Utilities::parseNumber(*value, x) || x < 0.0 )
+    {
+        throw InputError(InputError::INVALID_NUMBER, *value);
+    }
+    if ( !network->speciesModel.setInitQual(tokens[0], node, x) )
+    {
+        throw InputError(InputError::UNDEFINED_OBJECT, tokens[0]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Read a term of the reaction kinetics between species (or a kinetics
+//  solver option) from an input stream
+
+void PropertyParser::parseKinetics()
+{
+    // Contents of tokens are:
+    // 0 - name of species whose rate of change the term adds to
+    // 1 - rate coefficient (per day)
+    // 2... - names of the species whose concentrations multiply it
+    // or:
+    // 0 - SOLVER or TOLERANCE keyword
+    // 1 - name of solver or relative tolerance
+
+    if ( tokens.size() < 2 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    SpeciesModel& speciesModel = network->speciesModel;
+    string keyword = Utilities::upperCase(tokens[0]);
+    double x;
+
+    if ( keyword == w_Solver )
+    {
+        int i = Utilities::findMatch(tokens[1], SpeciesModel::SolverWords);
+        if ( i < 0 ) throw InputError(InputError::INVALID_KEYWORD, tokens[1]);
+        speciesModel.solver = i;
+    }
+    else if ( keyword == w_Tolerance )
+    {
+        if ( !Utilities::parseNumber(tokens[1], x) || x <= 0.0 )
+        {
+            throw InputError(InputError::INVALID_NUMBER, tokens[1]);
+        }
+        speciesModel.relTol = x;
+    }
+    else
+    {
+        if ( !Utilities::parseNumber(tokens[1], x) )
+        {
+            throw InputError(InputError::INVALID_NUMBER, tokens[1]);
+        }
+        vector<string> factors(tokens.begin() + 2, tokens.end());
+        speciesModel.addTerm(tokens[0], x, factors);
+    }
+}
@@ -17,6 +17,7 @@
 #include "Input/curveparser.h"
 #include "Input/optionparser.h"
 #include "Input/controlparser.h"
+#include "Input/ruleparser.h"
 
 #include <string>
 #include <vector>
@@ -71,11 +72,15 @@ class PropertyParser : public InputParser
     CurveParser    curveParser;
     OptionParser   optionParser;
     ControlParser  controlParser;
+    RuleParser     ruleParser;
     std::vector<std::string> tokens;
 
     void parseNodeProperty(int type, std::string& nodeName);
     void parseLinkProperty(int type, std::string& linkName);
     void parseReactProperty(std::string& reactType);
+    void parseTagProperty(std::string& objType);
+    void parseSpecies();
+    void parseKinetics();
 };
 
 #endif
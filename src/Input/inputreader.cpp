@@ -32,7 +32,8 @@ const char* sections[]  =
     "[ENERGY",          "[QUALITY",         "[SOURCE",          "[REACTION",
     "[MIXING",          "[OPTION",          "[TIME",            "[REPORT",
     "[COORD",           "[VERTICES",        "[LABEL",           "[MAP",
-    "[BACKDROP",        "[TAG",             "[END",             0
+    "[BACKDROP",        "[TAG",             "[SPECIES",         "[KINETICS",
+    "[END",             0
 };
 
 //-----------------------------------------------------------------------------
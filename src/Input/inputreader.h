@@ -38,7 +38,8 @@ class InputReader
         ENERGY,             QUALITY,            SOURCE,             REACTION,
         MIXING,             OPTION,             TIME,               REPORT,
         COORD,              VERTICES,           LABEL,              MAP,
-        BACKDROP,           TAG,                END
+        BACKDROP,           TAG,                SPECIES,            KINETICS,
+        END
     };
 
     InputReader();
@@ -236,6 +236,19 @@ void NodeParser::parseTankReact(Node* node, vector<string>& tokenList)
 
 //-----------------------------------------------------------------------------
 
+void NodeParser::parseZoneTag(Node* node, Network* nw, vector<string>& tokenList)
+{
+    // Contents of tokenList are:
+    // 0 - NODE keyword
+    // 1 - node ID
+    // 2 - tag (name of the node's zone)
+
+    if ( tokenList.size() < 3 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    node->zone = nw->waterBalance.addZone(tokenList[2]);
+}
+
+//-----------------------------------------------------------------------------
+
 void parseJuncData(Junction* junc, Network* nw, vector<string>& tokenList)
 {
     // Contents of tokenList are:
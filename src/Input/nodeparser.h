@@ -36,6 +36,7 @@ class NodeParser
     void parseQualSource(Node* node, Network* nw, std::vector<std::string>& tokens);
     void parseTankMixing(Node* node, std::vector<std::string>& tokens);
     void parseTankReact(Node* node, std::vector<std::string>& tokens);
+    void parseZoneTag(Node* node, Network* nw, std::vector<std::string>& tokens);
 };
 
 #endif
@@ -23,13 +23,16 @@ static const char* stringOptionKeywords[] =
      "", "", // placeholders for file names
      "MAP_FILE", "HEADLOSS_MODEL", "DEMAND_MODEL", "LEAKAGE_MODEL",
      "HYD_SOLVER", "STEP_SIZING", "VALVE_REP_TYPE", "MATRIX_SOLVER", "",
-     "QUALITY_MODEL", "QUALITY_NAME", "QUALITY_UNITS", 0};
+     "QUALITY_MODEL", "QUALITY_NAME", "QUALITY_UNITS",
+     "",  // placeholder for TRACE_NODE_NAME
+     "STATISTICS_FILE", 0};
 
 // ... Keywords for IndexOption enumeration in options.h
 static const char* indexOptionKeywords[] =
     {"",  // placeholder for UNIT_SYSTEM
      "FLOW_UNITS", "PRESSURE_UNITS", "MAXIMUM_TRIALS", "IF_UNBALANCED",
      "",  // reserved for hydraulics file mode
+     "FOREST_CORE", "TOPOLOGY_REDUCTION",
      "DEMAND_PATTERN",
      "",  // placeholder for ENERGY_PRICE_PATTERN
      "",  // placeholder for QUAL_TYPE
@@ -69,10 +72,14 @@ static const char* epanet2Keywords[] =
 static const char* epanetQualKeywords[] =
     {"NONE", "AGE", "TRACE", "CHEMICAL", 0};
 
+static const char* statisticKeywords[] =
+    {"NONE", "AVERAGE", "MINIMUM", "MAXIMUM", "RANGE", 0};
+
 //-----------------------------------------------------------------------------
 
 static const char* w_QUALITY = "QUALITY";
 static const char* w_CHEMICAL = "CHEMICAL";
+static const char* w_HYDRAULICS = "HYDRAULICS";
 //static const char* w_TRACE = "TRACE";
 static const char* w_DURATION = "DURATION";
 static const char* w_STATISTIC = "STATISTIC";
@@ -125,6 +132,15 @@ void OptionParser::parseOption(Network* network, vector<string>& tokenList)
         return;
     }
 
+    // ... check for EPANET2 "HYDRAULICS  USE/SAVE  filename" option
+    if ( s1.compare(w_HYDRAULICS) == 0 && tokenList.size() > 2 )
+    {
+        int err = network->options.setOption(Options::HYD_FILE_MODE, s2, network);
+        if ( err ) throw InputError(err, s2);
+        network->options.setOption(Options::HYD_FILE_NAME, value);
+        return;
+    }
+
     // ... get the equivalent EPANET3 keyword
     keyword = getEpanet3Keyword(s1, s2, value);
 
@@ -208,9 +224,15 @@ void OptionParser::parseTimeOption(Network* network, vector<string>& tokenList)
     int option = Utilities::findFullMatch(keyword, timeOptionKeywords);
     if ( option < 0 ) throw InputError(InputError::INVALID_KEYWORD, keyword);
 
-    // ... skip STATISTIC option
+    // ... STATISTIC option names the statistic rather than a time
 
-    if (option == Options::REPORT_STATISTIC) return;
+    if (option == Options::REPORT_STATISTIC)
+    {
+        int statistic = Utilities::findMatch(tokens[i], statisticKeywords);
+        if ( statistic < 0 ) throw InputError(InputError::INVALID_KEYWORD, tokens[i]);
+        network->options.setOption(Options::REPORT_STATISTIC, statistic);
+        return;
+    }
 
     // ... create strings to hold a time value and its units
 
@@ -398,8 +420,20 @@ void OptionParser::parseReportOption(Network* network, vector<string>& tokenList
         return;
     }
 
+    // ... parse which results are recorded in the binary output file
+    if ( Utilities::match(keyword, "RECORD") )
+    {
+        parseRecordItems(network, nTokens, tokens);
+    }
+
+    // ... parse which result statistics are accumulated
+    else if ( Utilities::match(keyword, "STATISTICS") )
+    {
+        parseStatisticsItems(network, nTokens, tokens);
+    }
+
     // ... parse which nodes & links are reported on
-    if ( Utilities::match(keyword, "NODES") )
+    else if ( Utilities::match(keyword, "NODES") )
     {
         parseReportItems(Element::NODE, network, nTokens, tokens);
     }
@@ -540,6 +574,113 @@ void OptionParser::parseReportItems(int nodeOrLink, Network* network,
 
 //-----------------------------------------------------------------------------
 
+void OptionParser::parseRecordItems(Network* network, int nTokens, string* tokens)
+{
+    if ( nTokens < 3 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    RecordPlan& plan = network->recordPlan;
+    string keyword = Utilities::upperCase(tokens[1]);
+
+    // ... process RECORD NODES/LINKS  ALL/NONE/id1 id2 etc. option
+    if ( keyword == "NODES" || keyword == "LINKS" )
+    {
+        bool isNodes = keyword == "NODES";
+        int value = Options::SOME;
+        if ( Utilities::match(tokens[2], "NONE") ) value = Options::NONE;
+        if ( Utilities::match(tokens[2], "ALL") )  value = Options::ALL;
+        if ( value != Options::SOME )
+        {
+            if ( isNodes ) plan.selectNodes(value);
+            else           plan.selectLinks(value);
+            return;
+        }
+        for (int i = 2; i < nTokens; i++)
+        {
+            int index = network->indexOf(isNodes ? Element::NODE : Element::LINK,
+                                         tokens[i]);
+            if ( index < 0 ) throw InputError(InputError::UNDEFINED_OBJECT, tokens[i]);
+            if ( isNodes ) plan.addNode(index);
+            else           plan.addLink(index);
+        }
+    }
+
+    // ... process RECORD NODE/LINK  variable  (YES/NO/interval) option
+    else if ( keyword == "NODE" || keyword == "LINK" )
+    {
+        bool isNode = keyword == "NODE";
+        string varName = Utilities::upperCase(tokens[2]);
+        int variable = Utilities::findFullMatch(varName, isNode ?
+            RecordPlan::NodeVariableWords : RecordPlan::LinkVariableWords);
+        if ( variable < 0 ) throw InputError(InputError::INVALID_KEYWORD, tokens[2]);
+
+        int interval = 1;
+        if ( nTokens > 3 )
+        {
+            if ( Utilities::match(tokens[3], "YES") ) interval = 1;
+            else if ( Utilities::match(tokens[3], "NO") ) interval = 0;
+            else if ( !Utilities::parseNumber(tokens[3], interval) || interval < 0 )
+            {
+                throw InputError(InputError::INVALID_NUMBER, tokens[3]);
+            }
+        }
+        if ( isNode ) plan.setNodeVariable(variable, interval);
+        else          plan.setLinkVariable(variable, interval);
+    }
+    else throw InputError(InputError::INVALID_KEYWORD, tokens[1]);
+}
+
+//-----------------------------------------------------------------------------
+
+void OptionParser::parseStatisticsItems(Network* network, int nTokens, string* tokens)
+{
+    ResultStats& stats = network->resultStats;
+
+    // ... process STATISTICS  YES/NO option
+    if ( Utilities::match(tokens[1], "YES") ) stats.enabled = true;
+    else if ( Utilities::match(tokens[1], "NO") ) stats.enabled = false;
+
+    // ... process STATISTICS  QUANTILES  q1 q2 etc. option
+    else if ( Utilities::match(tokens[1], "QUANTILES") )
+    {
+        vector<double> fractions;
+        for (int i = 2; i < nTokens; i++)
+        {
+            double q;
+            if ( !Utilities::parseNumber(tokens[i], q) || q <= 0.0 || q >= 1.0 ||
+                 (int)fractions.size() == ResultStats::MaxQuantiles )
+            {
+                throw InputError(InputError::INVALID_NUMBER, tokens[i]);
+            }
+            fractions.push_back(q);
+        }
+        stats.setQuantiles(fractions);
+        stats.enabled = true;
+    }
+
+    // ... process STATISTICS  variable  BELOW/ABOVE  value option
+    else
+    {
+        if ( nTokens < 4 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+        string varName = Utilities::upperCase(tokens[1]);
+        int variable = Utilities::findFullMatch(varName, ResultStats::VariableWords);
+        if ( variable < 0 ) throw InputError(InputError::INVALID_KEYWORD, tokens[1]);
+
+        double value;
+        if ( !Utilities::parseNumber(tokens[3], value) )
+        {
+            throw InputError(InputError::INVALID_NUMBER, tokens[3]);
+        }
+        double lower = stats.lowerLimit[variable];
+        double upper = stats.upperLimit[variable];
+        if ( Utilities::match(tokens[2], "BELOW") ) lower = value;
+        else if ( Utilities::match(tokens[2], "ABOVE") ) upper = value;
+        else throw InputError(InputError::INVALID_KEYWORD, tokens[2]);
+        stats.setLimits(variable, lower, upper);
+        stats.enabled = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void OptionParser::parseReportField(Network* network, int nTokens, string* tokens)
 {
     int    type = Element::NODE;
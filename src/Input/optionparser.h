@@ -43,6 +43,12 @@ class OptionParser
                                  Network* network,
                                  int nTokens,
                                  std::string* tokens);
+    void        parseRecordItems(Network* network,
+                                 int nTokens,
+                                 std::string* tokens);
+    void        parseStatisticsItems(Network* network,
+                                     int nTokens,
+                                     std::string* tokens);
     void        parseReportField(Network* network,
                                  int nTokens,
                                  std::string* tokens);
@@ -0,0 +1,271 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "ruleparser.h"
+#include "Core/network.h"
+#include "Core/error.h"
+#include "Elements/node.h"
+#include "Elements/link.h"
+#include "Elements/rule.h"
+#include "Utilities/utilities.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+//  Rule Keywords
+//-----------------------------------------------------------------------------
+static const char* w_RULE     = "RULE";
+static const char* w_IF       = "IF";
+static const char* w_AND      = "AND";
+static const char* w_OR       = "OR";
+static const char* w_THEN     = "THEN";
+static const char* w_ELSE     = "ELSE";
+static const char* w_PRIORITY = "PRIORITY";
+static const char* w_SYSTEM   = "SYSTEM";
+static const char* w_STATUS   = "STATUS";
+static const char* w_SETTING  = "SETTING";
+
+static const char* nodeWords[] = {"NODE", "JUNCTION", "RESERVOIR", "TANK", 0};
+static const char* linkWords[] = {"LINK", "PIPE", "PUMP", "VALVE", 0};
+
+// ... word forms of the relational operators, in Rule::Relation order
+static const char* relationWords[] = {"IS", "NOT", "", "", "BELOW", "ABOVE", 0};
+
+//-----------------------------------------------------------------------------
+
+RuleParser::RuleParser() :
+    rule(nullptr),
+    clauseType(PREMISES)
+{}
+
+//-----------------------------------------------------------------------------
+
+void RuleParser::parseRuleLine(string& line, Network* network)
+
+// Formats are:
+//   RULE id
+//   IF/AND/OR  NODE/LINK id variable relation value
+//   IF/AND/OR  SYSTEM variable relation value
+//   THEN/ELSE/AND  LINK id STATUS/SETTING IS value
+//   PRIORITY value
+// where NODE may also be JUNCTION, RESERVOIR or TANK and LINK may also be
+// PIPE, PUMP or VALVE.
+
+{
+    tokens.clear();
+    Utilities::split(tokens, line);
+    string& keyword = tokens[0];
+
+    // ... start a new rule (created when the input file was first read)
+
+    if ( Utilities::match(keyword, w_RULE) )
+    {
+        if ( tokens.size() < 2 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+        rule = network->rule(tokens[1]);
+        clauseType = PREMISES;
+        return;
+    }
+    if ( rule == nullptr ) throw InputError(InputError::INVALID_KEYWORD, keyword);
+
+    if ( Utilities::match(keyword, w_IF) )
+    {
+        if ( rule->premises.size() > 0 )
+        {
+            throw InputError(InputError::INVALID_KEYWORD, keyword);
+        }
+        parsePremise(Rule::IF, network);
+    }
+    else if ( Utilities::match(keyword, w_AND) )
+    {
+        if ( clauseType == PREMISES ) parsePremise(Rule::AND, network);
+        else parseAction(clauseType, network);
+    }
+    else if ( Utilities::match(keyword, w_OR) )
+    {
+        if ( clauseType != PREMISES ) throw InputError(InputError::INVALID_KEYWORD, keyword);
+        parsePremise(Rule::OR, network);
+    }
+    else if ( Utilities::match(keyword, w_THEN) )
+    {
+        if ( clauseType != PREMISES ) throw InputError(InputError::INVALID_KEYWORD, keyword);
+        clauseType = THEN_ACTIONS;
+        parseAction(clauseType, network);
+    }
+    else if ( Utilities::match(keyword, w_ELSE) )
+    {
+        if ( clauseType != THEN_ACTIONS ) throw InputError(InputError::INVALID_KEYWORD, keyword);
+        clauseType = ELSE_ACTIONS;
+        parseAction(clauseType, network);
+    }
+    else if ( Utilities::match(keyword, w_PRIORITY) )
+    {
+        if ( tokens.size() < 2 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+        if ( !Utilities::parseNumber(tokens[1], rule->priority) )
+        {
+            throw InputError(InputError::INVALID_NUMBER, tokens[1]);
+        }
+    }
+    else throw InputError(InputError::INVALID_KEYWORD, keyword);
+}
+
+//-----------------------------------------------------------------------------
+
+void RuleParser::parsePremise(int logicOp, Network* network)
+{
+    Rule::Premise p;
+    p.logicOp = logicOp;
+    p.object = nullptr;
+    p.status = Rule::NO_STATUS;
+    p.value = 0.0;
+
+    // ... identify the object the premise refers to
+
+    unsigned n = 2;
+    if ( tokens.size() < 5 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    if ( Utilities::match(tokens[1], w_SYSTEM) ) p.objType = Rule::SYSTEM_OBJ;
+    else
+    {
+        if ( tokens.size() < 6 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+        string& id = tokens[2];
+        if ( Utilities::findMatch(tokens[1], nodeWords) >= 0 )
+        {
+            p.objType = Rule::NODE_OBJ;
+            if ( network->indexOf(Element::NODE, id) < 0 )
+            {
+                throw InputError(InputError::UNDEFINED_OBJECT, id);
+            }
+            p.object = network->node(id);
+        }
+        else if ( Utilities::findMatch(tokens[1], linkWords) >= 0 )
+        {
+            p.objType = Rule::LINK_OBJ;
+            if ( network->indexOf(Element::LINK, id) < 0 )
+            {
+                throw InputError(InputError::UNDEFINED_OBJECT, id);
+            }
+            p.object = network->link(id);
+        }
+        else throw InputError(InputError::INVALID_KEYWORD, tokens[1]);
+        n = 3;
+    }
+
+    // ... identify the variable and check that the object has it
+
+    p.variable = Utilities::findMatch(tokens[n], Rule::VariableWords);
+    bool isValid = false;
+    switch (p.variable)
+    {
+    case Rule::DEMAND:
+        isValid = p.objType != Rule::LINK_OBJ;
+        break;
+    case Rule::HEAD:
+    case Rule::GRADE:
+    case Rule::LEVEL:
+    case Rule::PRESSURE:
+        isValid = p.objType == Rule::NODE_OBJ;
+        break;
+    case Rule::FILLTIME:
+    case Rule::DRAINTIME:
+        isValid = p.objType == Rule::NODE_OBJ &&
+                  static_cast<Node*>(p.object)->type() == Node::TANK;
+        break;
+    case Rule::FLOW:
+    case Rule::STATUS:
+    case Rule::SETTING:
+        isValid = p.objType == Rule::LINK_OBJ;
+        break;
+    case Rule::TIME:
+    case Rule::CLOCKTIME:
+        isValid = p.objType == Rule::SYSTEM_OBJ;
+        break;
+    }
+    if ( !isValid ) throw InputError(InputError::INVALID_KEYWORD, tokens[n]);
+
+    // ... identify the relational operator
+
+    string& relation = tokens[n+1];
+    p.relation = Utilities::findFullMatch(relation, Rule::RelationWords);
+    if ( p.relation < 0 )
+    {
+        for (int i = 0; relationWords[i]; i++)
+        {
+            if ( relationWords[i][0] && Utilities::match(relation, relationWords[i]) )
+            {
+                p.relation = i;
+                break;
+            }
+        }
+    }
+    if ( p.relation < 0 ) throw InputError(InputError::INVALID_KEYWORD, relation);
+
+    // ... parse the value being compared to
+
+    string& value = tokens[n+2];
+    if ( p.variable == Rule::STATUS )
+    {
+        p.status = Utilities::findMatch(value, Rule::StatusWords);
+        if ( p.status < 0 ) throw InputError(InputError::INVALID_KEYWORD, value);
+    }
+    else if ( p.variable == Rule::TIME || p.variable == Rule::CLOCKTIME )
+    {
+        string units = tokens.size() > n + 3 ? tokens[n+3] : "";
+        int seconds = Utilities::getSeconds(value, units);
+        if ( seconds < 0 ) throw InputError(InputError::INVALID_TIME, value + " " + units);
+        p.value = seconds;
+    }
+    else if ( !Utilities::parseNumber(value, p.value) )
+    {
+        throw InputError(InputError::INVALID_NUMBER, value);
+    }
+    rule->premises.push_back(p);
+}
+
+//-----------------------------------------------------------------------------
+
+void RuleParser::parseAction(int clause, Network* network)
+{
+    Rule::Action a;
+    a.status = Rule::NO_STATUS;
+    a.setting = 0.0;
+
+    // ... identify the link being acted on
+
+    if ( tokens.size() < 6 ) throw InputError(InputError::TOO_FEW_ITEMS, "");
+    if ( Utilities::findMatch(tokens[1], linkWords) < 0 )
+    {
+        throw InputError(InputError::INVALID_KEYWORD, tokens[1]);
+    }
+    string& id = tokens[2];
+    if ( network->indexOf(Element::LINK, id) < 0 )
+    {
+        throw InputError(InputError::UNDEFINED_OBJECT, id);
+    }
+    a.link = network->link(id);
+
+    // ... parse the new status or setting
+
+    string& value = tokens[5];
+    if ( Utilities::match(tokens[3], w_STATUS) )
+    {
+        a.status = Utilities::findMatch(value, Rule::StatusWords);
+        if ( a.status != Rule::OPEN_STATUS && a.status != Rule::CLOSED_STATUS )
+        {
+            throw InputError(InputError::INVALID_KEYWORD, value);
+        }
+    }
+    else if ( Utilities::match(tokens[3], w_SETTING) )
+    {
+        if ( !Utilities::parseNumber(value, a.setting) )
+        {
+            throw InputError(InputError::INVALID_NUMBER, value);
+        }
+    }
+    else throw InputError(InputError::INVALID_KEYWORD, tokens[3]);
+
+    if ( clause == THEN_ACTIONS ) rule->thenActions.push_back(a);
+    else rule->elseActions.push_back(a);
+}
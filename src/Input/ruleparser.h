@@ -0,0 +1,44 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file ruleparser.h
+//! \brief Describes the RuleParser class.
+
+#ifndef RULEPARSER_H_
+#define RULEPARSER_H_
+
+#include <string>
+#include <vector>
+
+class Rule;
+class Network;
+
+//! \class RuleParser
+//! \brief Parses the clauses of rule-based controls from lines of text.
+//!
+//! The lines of the [RULES] section are parsed one at a time, with each
+//! clause being added to the rule named by the most recent RULE line.
+
+class RuleParser
+{
+  public:
+    RuleParser();
+    ~RuleParser() {}
+    void parseRuleLine(std::string& line, Network* network);
+
+  private:
+    enum ClauseType {PREMISES, THEN_ACTIONS, ELSE_ACTIONS};
+
+    Rule*                    rule;         // rule being parsed
+    int                      clauseType;   // type of clause being parsed
+    std::vector<std::string> tokens;       // tokens of the line being parsed
+
+    void   parsePremise(int logicOp, Network* network);
+    void   parseAction(int clause, Network* network);
+};
+
+#endif
@@ -12,6 +12,11 @@
 #include <algorithm>
 using namespace std;
 
+//  Amount (ft) by which a constrained junction's head can fall short of its
+//  minimum pressure head because of round off in the solution
+
+static const double HMIN_TOL = 1.0e-4;
+
 //-----------------------------------------------------------------------------
 // Parent constructor and destructor
 //-----------------------------------------------------------------------------
@@ -64,16 +69,68 @@ FixedDemandModel::FixedDemandModel()
 ConstrainedDemandModel::ConstrainedDemandModel()
 {}
 
-bool ConstrainedDemandModel::isPressureDeficient(Junction* junc)
+//  A junction with insufficient pressure first becomes a fixed grade node
+//  with its head set at the minimum pressure. Once the solution converges
+//  its demand is reduced to the flow that reaches it and it becomes a
+//  variable head node again. If the pressure is still too low with the
+//  reduced demand then its demand is cut off completely. A junction only
+//  moves forward through these states within a time period, and returns to
+//  full demand at the start of a period once the flow it last received
+//  covers its full demand.
+
+void ConstrainedDemandModel::initDemandStatus(Junction* junc)
+{
+    // ... a junction that last received enough flow to meet its full
+    //     demand is no longer constrained
+
+    if ( junc->demandStatus != FULL_DEMAND &&
+         junc->actualDemand >= junc->fullDemand )
+    {
+        junc->demandStatus = FULL_DEMAND;
+    }
+
+    // ... a junction still constrained from the previous period starts out
+    //     at the minimum pressure (saving the trials needed to find it again)
+
+    if ( junc->demandStatus != FULL_DEMAND && junc->fullDemand > 0.0 )
+    {
+        junc->demandStatus = MIN_PRESSURE;
+        junc->fixedGrade = true;
+        junc->head = junc->elev + junc->pMin;
+    }
+    else junc->demandStatus = FULL_DEMAND;
+}
+
+bool ConstrainedDemandModel::updateDemandStatus(Junction* junc)
 {
-    //if ( junc->fixedGrade ||
     // ... return false if normal full demand is non-positive
     if (junc->fullDemand <= 0.0 ) return false;
-    double hMin = junc->elev + junc->pMin;
-    if ( junc->head < hMin )
+    double hMin = junc->elev + junc->pMin - HMIN_TOL;
+
+    switch (junc->demandStatus)
     {
+    // ... junction held at minimum pressure has its demand reduced to
+    //     the flow it receives (between 0 and its full demand)
+    case MIN_PRESSURE:
+        junc->fixedGrade = false;
+        junc->actualDemand = min(junc->actualDemand, junc->fullDemand);
+        junc->actualDemand = max(0.0, junc->actualDemand);
+        junc->demandStatus = REDUCED_DEMAND;
+        return true;
+
+    // ... junction with full demand is held at minimum pressure
+    case FULL_DEMAND:
+        if ( junc->head >= hMin ) return false;
         junc->fixedGrade = true;
-        junc->head = hMin;
+        junc->head = junc->elev + junc->pMin;
+        junc->demandStatus = MIN_PRESSURE;
+        return true;
+
+    // ... junction whose demand was already reduced has it cut off
+    case REDUCED_DEMAND:
+        if ( junc->head >= hMin || junc->actualDemand <= 0.0 ) return false;
+        junc->actualDemand = 0.0;
+        junc->demandStatus = NO_DEMAND;
         return true;
     }
     return false;
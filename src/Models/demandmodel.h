@@ -33,8 +33,12 @@ class DemandModel
     /// Finds demand flow and its derivative as a function of head.
     virtual double findDemand(Junction* junc, double h, double& dqdh);
 
-    /// Changes fixed grade status depending on pressure deficit.
-    virtual bool isPressureDeficient(Junction* junc) { return false; }
+    /// Sets a junction's demand constraint status at the start of a period.
+    virtual void initDemandStatus(Junction* junc) { }
+
+    /// Changes a junction's demand constraint status depending on its
+    /// pressure, returning true if the status changed.
+    virtual bool updateDemandStatus(Junction* junc) { return false; }
 
   protected:
     double expon;
@@ -56,13 +60,26 @@ class FixedDemandModel : public DemandModel
 //-----------------------------------------------------------------------------
 //! \class  ConstrainedDemandModel
 //! \brief A demand model where demands are reduced based on available pressure.
+//!
+//! A junction without enough pressure to supply its full demand has its
+//! demand reduced to the flow that reaches it with its head held at the
+//! minimum pressure, or to zero. These reductions are made along with link
+//! status changes inside the hydraulic solver's Newton iterations.
 //-----------------------------------------------------------------------------
 
 class ConstrainedDemandModel : public DemandModel
 {
   public:
+    enum DemandStatus {
+        FULL_DEMAND,      //!< full demand is supplied
+        MIN_PRESSURE,     //!< head is fixed at the minimum pressure
+        REDUCED_DEMAND,   //!< demand is reduced to the flow received
+        NO_DEMAND         //!< demand is cut off
+    };
+
     ConstrainedDemandModel();
-    bool isPressureDeficient(Junction* junc);
+    void initDemandStatus(Junction* junc);
+    bool updateDemandStatus(Junction* junc);
     double findDemand(Junction* junc, double p, double& dqdh);
 };
 
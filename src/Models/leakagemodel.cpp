@@ -7,12 +7,27 @@
 
 #include "leakagemodel.h"
 #include "Core/constants.h"
+#include "Core/network.h"
+#include "Elements/pipe.h"
 
 #include <cmath>
 using namespace std;
 
 const double C = 0.6 * sqrt(2*GRAVITY);
 
+//-----------------------------------------------------------------------------
+
+//  Raise a positive pressure head to a power, avoiding a call to pow()
+//  for the exponents most often used in leakage models.
+
+static inline double headPower(double h, double expon)
+{
+    if ( expon == 0.5 ) return sqrt(h);
+    if ( expon == 1.0 ) return h;
+    if ( expon == 1.5 ) return h * sqrt(h);
+    return pow(h, expon);
+}
+
 //-----------------------------------------------------------------------------
 // Parent constructor and destructor
 //-----------------------------------------------------------------------------
@@ -23,6 +38,26 @@ LeakageModel::LeakageModel() : lengthUcf(1.0), flowUcf(1.0)
 LeakageModel::~LeakageModel()
 {}
 
+//-----------------------------------------------------------------------------
+
+//  Precompute the leakage factors of each of a network's leaking pipes.
+
+void LeakageModel::init(Network* nw)
+{
+    int n = nw->leakingPipes.size();
+    factor1.resize(n);
+    factor2.resize(n);
+    head.assign(n, 0.0);
+    flow.assign(n, 0.0);
+    gradient.assign(n, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        Pipe* pipe = nw->leakingPipes[i];
+        findFactors(pipe->leakCoeff1, pipe->leakCoeff2, pipe->length,
+                    factor1[i], factor2[i]);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // Leakage model factory
 //-----------------------------------------------------------------------------
@@ -50,25 +85,33 @@ PowerLeakageModel::PowerLeakageModel(const double ucfLength_, const double ucfFl
     else                    pressureUcf = MperFT;
 }
 
-double PowerLeakageModel::findFlow(double a, double b, double length, double h,
-                                   double& dqdh)
+//  Leakage q = f1 * h^f2 where f1 folds the flow coeff., pipe length and the
+//  unit conversions for pressure, length and flow into a single constant.
+
+void PowerLeakageModel::findFactors(double a, double b, double length,
+                                    double& f1, double& f2)
 {
-    // no leakage for non-positive pressure head
-    if ( h <= 0.0 )
+    f1 = a * pow(pressureUcf, b) * length * lengthUcf / 1000.0 / flowUcf;
+    f2 = b;
+}
+
+void PowerLeakageModel::findFlows()
+{
+    int n = head.size();
+    for (int i = 0; i < n; i++)
     {
-        dqdh = 0.0;
-        return 0.0;
+        double h = head[i];
+        if ( h <= 0.0 )
+        {
+            flow[i] = 0.0;
+            gradient[i] = 0.0;
+            continue;
+        }
+        double b = factor2[i];
+        double q = factor1[i] * headPower(h, b);
+        flow[i] = q;
+        gradient[i] = b * q / h / 2.0;
     }
-
-    // ... find leakage using original units
-    double q = a * pow(h * pressureUcf, b) * length * lengthUcf / 1000.0;
-
-    // ... convert leakage to cfs
-    q /= flowUcf;
-
-    // ... compute half gradient in units of cfs/ft
-    dqdh = b * q / h / 2.0;
-    return q;
 }
 
 
@@ -81,29 +124,35 @@ FavadLeakageModel::FavadLeakageModel(const double ucfLength_)
     lengthUcf = ucfLength_;
 }
 
-double FavadLeakageModel::findFlow(double a, double m, double length, double h,
-                                   double& dqdh)
-{
-    // no leakage for non-positive pressure head
-    if ( h <= 0.0 )
-    {
-        dqdh = 0.0;
-        return 0.0;
-    }
+//  Leakage q = f1 * h^0.5 + f2 * h^1.5 where:
+//  'a' is leak area per 1000 pipe length units (converted to ft2 / 1000 ft),
+//  'm' is change in 'a' per change in head (dimensionless),
+//  C is the orifice constant, 0.6 * sqrt(2g).
 
-    // 'a' is leak area per 1000 pipe length units,
-    // 'm' is change in 'a' per change in head (dimensionless),
-    // convert 'a' to ft2 / 1000 ft
+void FavadLeakageModel::findFactors(double a, double m, double length,
+                                    double& f1, double& f2)
+{
     a /= lengthUcf;
+    f1 = a * C * length / 1000.0;
+    f2 = m * C * length / 1000.0;
+}
 
-    // compute fixed & variable head portions of leakage in cfs
-    // (C is orifice constant, 0.6 * sqrt(2g))
-    double q1 = a * C * pow(h, 0.5) * length / 1000.0;
-    double q2 = m * C * pow(h, 1.5) * length / 1000.0;
-
-    // find half-gradient of leakage flow
-    dqdh = (0.5 * q1 + 1.5 * q2) / h / 2.0;
-
-    // return total leakage flow rate
-    return q1 + q2;
+void FavadLeakageModel::findFlows()
+{
+    int n = head.size();
+    for (int i = 0; i < n; i++)
+    {
+        double h = head[i];
+        if ( h <= 0.0 )
+        {
+            flow[i] = 0.0;
+            gradient[i] = 0.0;
+            continue;
+        }
+        double s = sqrt(h);
+        double q1 = factor1[i] * s;
+        double q2 = factor2[i] * h * s;
+        flow[i] = q1 + q2;
+        gradient[i] = (0.5 * q1 + 1.5 * q2) / h / 2.0;
+    }
 }
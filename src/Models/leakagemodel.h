@@ -12,6 +12,9 @@
 #define LEAKAGEMODEL_H_
 
 #include <string>
+#include <vector>
+
+class Network;
 
 //! \class LeakageModel
 //! \brief The interface for a pipe leakage model.
@@ -20,6 +23,11 @@
 //! model is derived. Two such models are currently available -
 //! a power function model and a fixed-and-variable-areas discharge
 //! (FAVAD) model.
+//!
+//! Each model reduces a pipe's leakage coefficients and length to a pair
+//! of constant factors when it is initialized, so that the leakage along
+//! all of the network's leaking pipes can be found in a single pass with
+//! findFlows().
 
 class LeakageModel
 {
@@ -30,16 +38,26 @@ class LeakageModel
                                   const std::string model,
                                   const double ucfLength_,
                                   const double ucfFlow_);
-    virtual double findFlow(double c1,
-                            double c2,
-                            double length,
-                            double h,
-                            double& dqdh) = 0;
+    // Precomputes the leakage factors of a network's leaking pipes
+    void           init(Network* nw);
+
+    // Finds leakage and its half-gradient for all leaking pipes at
+    // the pressure heads held in the head array
+    virtual void   findFlows() = 0;
+
+    std::vector<double> head;      //!< pressure head along each leaking pipe (ft)
+    std::vector<double> flow;      //!< leakage flow from each leaking pipe (cfs)
+    std::vector<double> gradient;  //!< half-gradient of leakage w.r.t. head
 
   protected:
     double lengthUcf;
     double flowUcf;
     double pressureUcf;
+    std::vector<double> factor1;   //!< first leakage factor of each pipe
+    std::vector<double> factor2;   //!< second leakage factor of each pipe
+
+    virtual void   findFactors(double c1, double c2, double length,
+                               double& f1, double& f2) = 0;
 };
 
 //-----------------------------------------------------------------------------
@@ -51,8 +69,11 @@ class PowerLeakageModel : public LeakageModel
 {
   public:
     PowerLeakageModel(const double ucfLength_, const double ucfFlow_);
-    double findFlow(double flowCoeff, double expon, double length, double h,
-                    double& dqdh);
+    void   findFlows();
+
+  protected:
+    void   findFactors(double flowCoeff, double expon, double length,
+                       double& f1, double& f2);
 };
 
 //-----------------------------------------------------------------------------
@@ -65,7 +86,11 @@ class FavadLeakageModel : public LeakageModel
 {
   public:
     FavadLeakageModel(const double ucfLength_);
-    double findFlow(double area, double slope, double length, double h, double& dqdh);
+    void   findFlows();
+
+  protected:
+    void   findFactors(double area, double slope, double length,
+                       double& f1, double& f2);
 };
 
 #endif /* LEAKAGEMODEL_H_ */
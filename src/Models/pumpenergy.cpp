@@ -21,7 +21,8 @@ static const double NO_FLOW = 2.23e-4;    // cfs ( = 0.1 gpm)
 
 //-----------------------------------------------------------------------------
 
-PumpEnergy::PumpEnergy()
+PumpEnergy::PumpEnergy() :
+    efficSegment(1)
 {
     init();
 }
@@ -127,7 +128,7 @@ double PumpEnergy::findEfficiency(Pump* pump, Network* network)
         double q = pump->flow / pump->speed * network->ucf(Units::FLOW);
 
         // ... look up efficiency for the adjusted flow
-        effic = pump->efficCurve->getYofX(q);
+        effic = pump->efficCurve->getYofX(q, efficSegment);
 
         // ... apply the Sarbu and Borza pump speed adjustment
         effic = 100.0 - ((100.0-effic) * pow(1.0/pump->speed, 0.1));
@@ -38,6 +38,8 @@ class PumpEnergy
 
   private:
 
+    int    efficSegment;     //!< efficiency curve segment of last look up
+
     double findCostFactor(Pump* pump, Network* network);
     double findEfficiency(Pump* pump, Network* network);
 };
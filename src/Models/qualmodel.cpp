@@ -55,6 +55,7 @@ ChemModel::ChemModel() : QualModel(CHEM)
     diffus = DIFFUSIVITY;   // chemical's diffusivity (ft2/sec)
     viscos = VISCOSITY;     // water kin. viscosity (ft2/sec)
     Sc = 0.0;               // Schmidt number
+    Sc3 = 0.0;              // cube root of Schmidt number
     pipeOrder = 1.0;        // pipe bulk fluid reaction order
     tankOrder = 1.0;        // tank bulk fluid reaction order
     wallOrder = 1.0;        // pipe wall reaction order
@@ -85,6 +86,13 @@ void ChemModel::init(Network* nw)
     viscos = nw->option(Options::KIN_VISCOSITY);
     if ( diffus > 0.0 ) Sc = viscos / diffus;
     else Sc = 0.0;
+    Sc3 = pow(Sc, 1.0/3.0);
+
+    // clear the pipe reaction factors
+    int linkCount = nw->count(Element::LINK);
+    pipeFlow.assign(linkCount, 0.0);
+    pipeStep.assign(linkCount, -1.0);
+    pipeFactor.assign(linkCount, 1.0);
 
     // save concentration limit
     cLimit = nw->option(Options::LIMITING_CONCEN) / FT3perL;
@@ -135,7 +143,7 @@ void ChemModel::findMassTransCoeff(Pipe* pipe)
     else if ( Re >= 2300.0 )
     {
         //Sh = 0.0149 * pow(Re, 0.88) * pow(Sc, 0.333);
-        Sh = 0.026 * pow(Re, 0.8) * pow(Sc, 1.0/3.0);
+        Sh = 0.026 * pow(Re, 0.8) * Sc3;
     }
 
     // ... Sherwood No. for laminar flow
@@ -184,6 +192,47 @@ double ChemModel::tankReact(Tank* tank, double c, double tstep)
 
 //-----------------------------------------------------------------------------
 
+//  Find the factor by which first order reactions scale the concentration
+//  of a pipe's contents over a given time step.
+
+double ChemModel::findPipeFactor(Pipe* pipe, double tstep)
+{
+    if ( pipeOrder != 1.0 || cLimit != 0.0 ) return -1.0;
+    if ( pipe->wallCoeff != 0.0 && wallOrder != 1.0 ) return -1.0;
+
+    // ... use the factor found previously if flow & time step are unchanged
+
+    int k = pipe->index;
+    if ( pipe->flow == pipeFlow[k] && tstep == pipeStep[k] ) return pipeFactor[k];
+
+    // ... rate constant is bulk coeff. plus wall rate per unit concen.
+
+    double rate = pipe->bulkCoeff / SECperDAY * pipeUcf;
+    double kw = pipe->wallCoeff / SECperDAY;
+    if ( kw != 0.0 )
+    {
+        findMassTransCoeff(pipe);
+        rate += findWallRate(kw, pipe->diameter, wallOrder, 1.0);
+    }
+    pipeFlow[k] = pipe->flow;
+    pipeStep[k] = tstep;
+    pipeFactor[k] = exp(rate * tstep);
+    return pipeFactor[k];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find the factor by which a first order bulk reaction scales the
+//  concentration of a tank's contents over a given time step.
+
+double ChemModel::findTankFactor(Tank* tank, double tstep)
+{
+    if ( tankOrder != 1.0 || cLimit != 0.0 ) return -1.0;
+    return exp(tank->bulkCoeff / SECperDAY * tankUcf * tstep);
+}
+
+//-----------------------------------------------------------------------------
+
 //  Find the bulk reaction rate at a given chemical concentration.
 
 double ChemModel::findBulkRate(double kb, double order, double c)
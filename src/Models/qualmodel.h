@@ -12,6 +12,7 @@
 #define QUALMODEL_H_
 
 #include <string>
+#include <vector>
 
 class Network;
 class Pipe;
@@ -55,6 +56,14 @@ class QualModel
     virtual double tankReact(Tank* tank, double c, double tstep)
 	{ return c; }
 
+    // Factor that scales all concentrations in a pipe or tank over a time
+    // step when its reactions are first order (or -1 if they aren't)
+    virtual double findPipeFactor(Pipe* pipe, double tstep)
+	{ return -1.0; }
+
+    virtual double findTankFactor(Tank* tank, double tstep)
+	{ return -1.0; }
+
     virtual double findTracerAdded(Node* node, double qIn)
     { return 0.0; }
 
@@ -65,6 +74,13 @@ class QualModel
 //-----------------------------------------------------------------------------
 //! \class ChemModel
 //! \brief Reactive chemical model.
+//!
+//! First order bulk and wall reactions (with no limiting concentration)
+//! decay exponentially, so a pipe's or tank's contents are scaled by an
+//! exact factor over a time step rather than integrated with an Euler
+//! step. The rate constant and factor of each pipe are kept until its flow
+//! (on which the wall mass transfer coefficient depends) or the time step
+//! changes.
 //-----------------------------------------------------------------------------
 
 class ChemModel : public QualModel
@@ -76,12 +92,15 @@ class ChemModel : public QualModel
     void   findMassTransCoeff(Pipe* pipe);
     double pipeReact(Pipe* pipe, double c, double tstep);
     double tankReact(Tank* tank, double c, double tstep);
+    double findPipeFactor(Pipe* pipe, double tstep);
+    double findTankFactor(Tank* tank, double tstep);
 
   private:
     bool    reactive;         // true if chemical is reactive
     double  diffus;           // chemical's diffusuivity (ft2/sec)
     double  viscos;           // water kin. viscosity (ft2/sec)
     double  Sc;               // Schmidt number
+    double  Sc3;              // cube root of Schmidt number
     double  pipeOrder;        // pipe bulk fluid reaction order
     double  tankOrder;        // tank bulk fluid reaction order
     double  wallOrder;        // pipe wall reaction order
@@ -90,6 +109,10 @@ class ChemModel : public QualModel
     double  tankUcf;          // volume conversion factor for tanks
     double  cLimit;           // min/max concentration limit (mass/ft3)
 
+    std::vector<double> pipeFlow;    // flow each pipe's factor was found for
+    std::vector<double> pipeStep;    // time step it was found for
+    std::vector<double> pipeFactor;  // first order reaction factor of each pipe
+
     bool    setReactive(Network* nw);
     double  findBulkRate(double kb, double order, double c);
     double  findWallRate(double kw, double d, double order, double c);
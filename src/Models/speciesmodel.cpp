@@ -0,0 +1,629 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "speciesmodel.h"
+#include "Core/network.h"
+#include "Core/constants.h"
+#include "Core/error.h"
+#include "Elements/node.h"
+#include "Utilities/segpool.h"
+#include "Utilities/utilities.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+const char* SpeciesModel::SolverWords[] = {"RK5", "ROS2", 0};
+
+//  Limits on the integration step (sec)
+
+static const double MIN_STEP  = 1.0e-3;
+static const int    MAX_STEPS = 10000;
+
+//  Quality of a source being traced (100 percent in user units)
+
+static const double Ctrace = 100.0 * LperFT3;
+
+//  Cash-Karp coefficients of the embedded 4th/5th order Runge-Kutta method
+
+static const double B21 = 1.0/5.0;
+static const double B31 = 3.0/40.0,       B32 = 9.0/40.0;
+static const double B41 = 3.0/10.0,       B42 = -9.0/10.0,   B43 = 6.0/5.0;
+static const double B51 = -11.0/54.0,     B52 = 5.0/2.0,     B53 = -70.0/27.0,
+                    B54 = 35.0/27.0;
+static const double B61 = 1631.0/55296.0, B62 = 175.0/512.0, B63 = 575.0/13824.0,
+                    B64 = 44275.0/110592.0, B65 = 253.0/4096.0;
+static const double C1 = 37.0/378.0,      C3 = 250.0/621.0,  C4 = 125.0/594.0,
+                    C6 = 512.0/1771.0;
+static const double D1 = C1 - 2825.0/27648.0,  D3 = C3 - 18575.0/48384.0,
+                    D4 = C4 - 13525.0/55296.0, D5 = -277.0/14336.0,
+                    D6 = C6 - 0.25;
+
+//  Diagonal coefficient of the 2nd order Rosenbrock method
+
+static const double GAMMA = 1.0 + 1.0 / sqrt(2.0);
+
+//-----------------------------------------------------------------------------
+
+//  Constructor
+
+SpeciesModel::SpeciesModel() :
+    solver(RK5),
+    relTol(0.001),
+    absTol(0.0),
+    n(0)
+{}
+
+//-----------------------------------------------------------------------------
+
+//  Remove all species and kinetic terms.
+
+void SpeciesModel::clear()
+{
+    species.clear();
+    terms.clear();
+    factors.clear();
+    nodeValues.clear();
+    linkValues.clear();
+    solver = RK5;
+    relTol = 0.001;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Add a species, returning false if it already exists.
+
+bool SpeciesModel::addSpecies(const string& name)
+{
+    string s = Utilities::upperCase(name);
+    for (Species& sp : species)
+    {
+        if ( Utilities::upperCase(sp.name) == s ) return false;
+    }
+    Species sp;
+    sp.name = name;
+    sp.initQual = 0.0;
+    sp.traceNode = -1;
+    species.push_back(sp);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Set a species' initial quality at a single node (or at all nodes if the
+//  node index is negative), returning false if the species doesn't exist.
+
+bool SpeciesModel::setInitQual(const string& name, int node, double initQual)
+{
+    string s = Utilities::upperCase(name);
+    for (Species& sp : species)
+    {
+        if ( Utilities::upperCase(sp.name) != s ) continue;
+        if ( node < 0 )
+        {
+            sp.initQual = initQual;
+            return true;
+        }
+        for (size_t i = 0; i < sp.nodes.size(); i++)
+        {
+            if ( sp.nodes[i] == node )
+            {
+                sp.nodeQual[i] = initQual;
+                return true;
+            }
+        }
+        sp.nodes.push_back(node);
+        sp.nodeQual.push_back(initQual);
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Make a species trace the flow from a node, returning false if the species
+//  doesn't exist.
+
+bool SpeciesModel::setTraceNode(const string& name, int node)
+{
+    string s = Utilities::upperCase(name);
+    for (Species& sp : species)
+    {
+        if ( Utilities::upperCase(sp.name) != s ) continue;
+        sp.traceNode = node;
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Add a mass action term to the rate of change of a species (names are
+//  resolved by compile() once all input has been read).
+
+void SpeciesModel::addTerm(const string& name, double coeff,
+                           const vector<string>& factorNames)
+{
+    Term term;
+    term.name = name;
+    term.coeff = coeff;
+    term.factorNames = factorNames;
+    term.index = -1;
+    term.first = 0;
+    term.count = 0;
+    term.rate = 0.0;
+    terms.push_back(term);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Resolve the species named in each kinetic term.
+
+void SpeciesModel::compile(Network* nw)
+{
+    string qualName = Utilities::upperCase(nw->option(Options::QUAL_NAME));
+    for (Species& sp : species)
+    {
+        if ( Utilities::upperCase(sp.name) == qualName )
+        {
+            throw InputError(InputError::DUPLICATE_ID, sp.name);
+        }
+    }
+
+    factors.clear();
+    for (Term& term : terms)
+    {
+        term.index = indexOf(term.name, nw);
+        if ( term.index < 0 )
+        {
+            throw InputError(InputError::UNDEFINED_OBJECT, term.name);
+        }
+        term.first = (int)factors.size();
+        for (string& s : term.factorNames)
+        {
+            int i = indexOf(s, nw);
+            if ( i < 0 ) throw InputError(InputError::UNDEFINED_OBJECT, s);
+            factors.push_back(i);
+        }
+        term.count = (int)factors.size() - term.first;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write a number without losing the precision of small coefficients.
+
+static string numberStr(double x)
+{
+    ostringstream ss;
+    ss << setprecision(10) << x;
+    return ss.str();
+}
+
+//  Write the species and their kinetics to an input file.
+
+void SpeciesModel::write(ostream& out, Network* nw)
+{
+    if ( species.size() > 0 )
+    {
+        out << "\n[SPECIES]\n";
+        for (Species& sp : species)
+        {
+            if ( sp.traceNode >= 0 )
+            {
+                out << left << setw(16) << sp.name << setw(16) << "TRACE";
+                out << nw->node(sp.traceNode)->name << "\n";
+                continue;
+            }
+            out << left << setw(16) << sp.name << numberStr(sp.initQual) << "\n";
+            for (size_t i = 0; i < sp.nodes.size(); i++)
+            {
+                out << left << setw(16) << sp.name;
+                out << setw(16) << nw->node(sp.nodes[i])->name;
+                out << numberStr(sp.nodeQual[i]) << "\n";
+            }
+        }
+    }
+
+    if ( terms.size() > 0 )
+    {
+        out << "\n[KINETICS]\n";
+        for (Term& term : terms)
+        {
+            out << left << setw(16) << term.name;
+            out << setw(12) << numberStr(term.coeff);
+            for (string& s : term.factorNames) out << " " << s;
+            out << "\n";
+        }
+        out << left << setw(16) << "SOLVER" << SolverWords[solver] << "\n";
+        out << left << setw(16) << "TOLERANCE" << numberStr(relTol) << "\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find the index of a named species (or -1 if there is no such species).
+
+int SpeciesModel::indexOf(const string& name, Network* nw)
+{
+    string s = Utilities::upperCase(name);
+    if ( s == Utilities::upperCase(nw->option(Options::QUAL_NAME)) ) return 0;
+    for (size_t i = 0; i < species.size(); i++)
+    {
+        if ( Utilities::upperCase(species[i].name) == s ) return (int)i + 1;
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+std::string SpeciesModel::name(int index, Network* nw)
+{
+    if ( index == 0 ) return nw->option(Options::QUAL_NAME);
+    if ( index < 0 || index >= width() ) return "";
+    return species[index-1].name;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Assign initial quality to each node (source traces start out at zero
+//  until holdTraceSources() is called) and convert the kinetic rate
+//  coefficients to internal units.
+
+void SpeciesModel::init(Network* nw)
+{
+    int m = (int)species.size();
+    int nodeCount = nw->count(Element::NODE);
+    nodeValues.assign(nodeCount * m, 0.0);
+    linkValues.assign(nw->count(Element::LINK) * m, 0.0);
+
+    double ucf = nw->ucf(Units::CONCEN);
+    for (int j = 0; j < m; j++)
+    {
+        Species& sp = species[j];
+        if ( sp.traceNode >= 0 ) continue;
+        for (int i = 0; i < nodeCount; i++)
+        {
+            nodeValues[i*m + j] = sp.initQual / ucf;
+        }
+        for (size_t i = 0; i < sp.nodes.size(); i++)
+        {
+            nodeValues[sp.nodes[i]*m + j] = sp.nodeQual[i] / ucf;
+        }
+    }
+
+    // ... a term of order p changes concentration at a rate (in internal
+    //     units per second) of coeff * ucf^(p-1) / SECperDAY
+    for (Term& term : terms)
+    {
+        term.rate = term.coeff * pow(ucf, term.count - 1) / SECperDAY;
+    }
+    absTol = nw->option(Options::QUAL_TOLERANCE) / ucf;
+    if ( absTol <= 0.0 ) absTol = 1.0e-6;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Integrate the kinetics of the species in a list of volume segments over
+//  a time step, returning the mass of the quality model's constituent that
+//  reacted.
+
+double SpeciesModel::react(Segment* firstSeg, double tstep)
+{
+    // ... gather the segments' concentrations into a batch
+    n = 0;
+    for (Segment* seg = firstSeg; seg; seg = seg->next) n++;
+    if ( n == 0 ) return 0.0;
+    int w = width();
+    int size = w * n;
+    y.resize(size);
+    yTmp.resize(size);
+    yErr.resize(size);
+    prod.resize(n);
+    for (int i = 0; i < 6; i++) k[i].resize(size);
+
+    int j = 0;
+    for (Segment* seg = firstSeg; seg; seg = seg->next, j++)
+    {
+        double* c = seg->conc();
+        for (int i = 0; i < w; i++) y[i*n + j] = c[i];
+    }
+
+    // ... integrate the batch over the time step
+    bool solved;
+    if ( solver == ROS2 ) solved = integrateROS2(tstep);
+    else solved = integrateRK5(tstep);
+    if ( !solved ) throw SystemError(SystemError::QUALITY_SOLVER_FAILURE);
+
+    // ... return the new concentrations to the segments
+    double massReacted = 0.0;
+    j = 0;
+    for (Segment* seg = firstSeg; seg; seg = seg->next, j++)
+    {
+        double* c = seg->conc();
+        double c0 = c[0];
+        for (int i = 0; i < w; i++) c[i] = max(0.0, y[i*n + j]);
+        massReacted += (c0 - c[0]) * seg->v;
+    }
+    return massReacted;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Hold the quality of each source trace at 100 percent at its node.
+
+void SpeciesModel::holdTraceSources()
+{
+    int m = (int)species.size();
+    if ( nodeValues.empty() ) return;
+    for (int j = 0; j < m; j++)
+    {
+        int node = species[j].traceNode;
+        if ( node >= 0 ) nodeValues[node*m + j] = Ctrace;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Current quality of a species (other than the quality model's constituent)
+//  at a node and in a link.
+
+double SpeciesModel::nodeQual(int node, int index)
+{
+    int m = width() - 1;
+    if ( index < 1 || index > m || nodeValues.empty() ) return 0.0;
+    return nodeValues[node*m + index - 1];
+}
+
+double SpeciesModel::linkQual(int link, int index)
+{
+    int m = width() - 1;
+    if ( index < 1 || index > m || linkValues.empty() ) return 0.0;
+    return linkValues[link*m + index - 1];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Evaluate the rate of change dcdt of each species in a batch of segments
+//  with concentrations c.
+
+void SpeciesModel::findRates(const double* c, double* dcdt)
+{
+    fill(dcdt, dcdt + width() * n, 0.0);
+    for (const Term& term : terms)
+    {
+        for (int j = 0; j < n; j++) prod[j] = term.rate;
+        for (int f = term.first; f < term.first + term.count; f++)
+        {
+            const double* cf = c + factors[f] * n;
+            for (int j = 0; j < n; j++) prod[j] *= cf[j];
+        }
+        double* d = dcdt + term.index * n;
+        for (int j = 0; j < n; j++) d[j] += prod[j];
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find the largest error estimate (yErr) relative to the tolerance allowed
+//  for the concentrations in the batch.
+
+double SpeciesModel::findError()
+{
+    double errMax = 0.0;
+    int size = width() * n;
+    for (int i = 0; i < size; i++)
+    {
+        double scale = absTol + relTol * max(abs(y[i]), abs(yTmp[i]));
+        errMax = max(errMax, abs(yErr[i]) / scale);
+    }
+    return errMax;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Integrate the batch with the adaptive Cash-Karp Runge-Kutta method.
+
+bool SpeciesModel::integrateRK5(double tstep)
+{
+    int size = width() * n;
+    double* k1 = &k[0][0];
+    double* k2 = &k[1][0];
+    double* k3 = &k[2][0];
+    double* k4 = &k[3][0];
+    double* k5 = &k[4][0];
+    double* k6 = &k[5][0];
+    double t = 0.0;
+    double h = tstep;
+    bool newRates = true;
+
+    for (int steps = 0; t < tstep; steps++)
+    {
+        if ( steps >= MAX_STEPS ) return false;
+        h = min(h, tstep - t);
+
+        if ( newRates ) findRates(&y[0], k1);
+        for (int i = 0; i < size; i++) yTmp[i] = y[i] + h*B21*k1[i];
+        findRates(&yTmp[0], k2);
+        for (int i = 0; i < size; i++)
+            yTmp[i] = y[i] + h*(B31*k1[i] + B32*k2[i]);
+        findRates(&yTmp[0], k3);
+        for (int i = 0; i < size; i++)
+            yTmp[i] = y[i] + h*(B41*k1[i] + B42*k2[i] + B43*k3[i]);
+        findRates(&yTmp[0], k4);
+        for (int i = 0; i < size; i++)
+            yTmp[i] = y[i] + h*(B51*k1[i] + B52*k2[i] + B53*k3[i] + B54*k4[i]);
+        findRates(&yTmp[0], k5);
+        for (int i = 0; i < size; i++)
+            yTmp[i] = y[i] + h*(B61*k1[i] + B62*k2[i] + B63*k3[i] +
+                                B64*k4[i] + B65*k5[i]);
+        findRates(&yTmp[0], k6);
+        for (int i = 0; i < size; i++)
+        {
+            yTmp[i] = y[i] + h*(C1*k1[i] + C3*k3[i] + C4*k4[i] + C6*k6[i]);
+            yErr[i] = h*(D1*k1[i] + D3*k3[i] + D4*k4[i] + D5*k5[i] + D6*k6[i]);
+        }
+
+        // ... accept the step if its error is within tolerance, adjusting
+        //     the size of the next step to the error found
+        double err = findError();
+        if ( err <= 1.0 || h <= MIN_STEP )
+        {
+            t += h;
+            y.swap(yTmp);
+            newRates = true;
+            if ( err > 1.0e-4 ) h *= min(5.0, 0.9 * pow(err, -0.2));
+            else                h *= 5.0;
+        }
+        else
+        {
+            newRates = false;
+            h = max(MIN_STEP, h * max(0.1, 0.9 * pow(err, -0.25)));
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Integrate the batch with the adaptive 2nd order Rosenbrock method
+//  (ROS2) whose embedded 1st order solution provides an error estimate.
+
+bool SpeciesModel::integrateROS2(double tstep)
+{
+    int w = width();
+    int size = w * n;
+    jac.resize(w * w * n);
+    pivot.resize(w * n);
+    work.resize(w);
+    double* k1 = &k[0][0];
+    double* k2 = &k[1][0];
+    double t = 0.0;
+    double h = tstep;
+
+    for (int steps = 0; t < tstep; steps++)
+    {
+        if ( steps >= MAX_STEPS ) return false;
+        h = min(h, tstep - t);
+
+        // ... solve (I - gamma*h*J) k1 = f(y)
+        factorROS2(h);
+        findRates(&y[0], k1);
+        solveROS2(k1);
+
+        // ... solve (I - gamma*h*J) k2 = f(y + h*k1) - 2*k1
+        for (int i = 0; i < size; i++) yTmp[i] = y[i] + h*k1[i];
+        findRates(&yTmp[0], k2);
+        for (int i = 0; i < size; i++) k2[i] -= 2.0*k1[i];
+        solveROS2(k2);
+
+        for (int i = 0; i < size; i++)
+        {
+            yTmp[i] = y[i] + h*(1.5*k1[i] + 0.5*k2[i]);
+            yErr[i] = 0.5*h*(k1[i] + k2[i]);
+        }
+
+        double err = findError();
+        if ( err <= 1.0 || h <= MIN_STEP )
+        {
+            t += h;
+            y.swap(yTmp);
+            if ( err > 1.0e-4 ) h *= min(5.0, 0.9 / sqrt(err));
+            else                h *= 5.0;
+        }
+        else h = max(MIN_STEP, h * max(0.1, 0.9 / sqrt(err)));
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Form and factor the matrix I - gamma*h*J of each segment in the batch,
+//  where J is the Jacobian of the kinetics at the current concentrations.
+
+void SpeciesModel::factorROS2(double h)
+{
+    int w = width();
+    for (int j = 0; j < n; j++)
+    {
+        double* a = &jac[j * w * w];
+        int* p = &pivot[j * w];
+        fill(a, a + w * w, 0.0);
+
+        // ... each factor of a term contributes the product of the term's
+        //     other factors to the Jacobian
+        for (const Term& term : terms)
+        {
+            for (int m = term.first; m < term.first + term.count; m++)
+            {
+                double d = term.rate;
+                for (int f = term.first; f < term.first + term.count; f++)
+                {
+                    if ( f != m ) d *= y[factors[f] * n + j];
+                }
+                a[term.index * w + factors[m]] -= GAMMA * h * d;
+            }
+        }
+        for (int i = 0; i < w; i++) a[i * w + i] += 1.0;
+
+        // ... LU factorization with partial pivoting
+        for (int c = 0; c < w; c++)
+        {
+            int r = c;
+            for (int i = c + 1; i < w; i++)
+            {
+                if ( abs(a[i*w + c]) > abs(a[r*w + c]) ) r = i;
+            }
+            p[c] = r;
+            if ( r != c )
+            {
+                for (int i = 0; i < w; i++) swap(a[c*w + i], a[r*w + i]);
+            }
+            if ( a[c*w + c] == 0.0 ) a[c*w + c] = 1.0e-20;
+            for (int i = c + 1; i < w; i++)
+            {
+                double f = a[i*w + c] / a[c*w + c];
+                a[i*w + c] = f;
+                for (int l = c + 1; l < w; l++) a[i*w + l] -= f * a[c*w + l];
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Solve the factored system of each segment in the batch for a right hand
+//  side b, which is replaced by the solution.
+
+void SpeciesModel::solveROS2(double* b)
+{
+    int w = width();
+    double* x = &work[0];
+    for (int j = 0; j < n; j++)
+    {
+        const double* a = &jac[j * w * w];
+        const int* p = &pivot[j * w];
+        for (int i = 0; i < w; i++) x[i] = b[i * n + j];
+        for (int c = 0; c < w; c++)
+        {
+            if ( p[c] != c ) swap(x[c], x[p[c]]);
+        }
+        for (int c = 0; c < w; c++)
+        {
+            for (int i = c + 1; i < w; i++) x[i] -= a[i*w + c] * x[c];
+        }
+        for (int c = w - 1; c >= 0; c--)
+        {
+            for (int i = c + 1; i < w; i++) x[c] -= a[c*w + i] * x[i];
+            x[c] /= a[c*w + c];
+        }
+        for (int i = 0; i < w; i++) b[i * n + j] = x[i];
+    }
+}
@@ -0,0 +1,133 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file speciesmodel.h
+//! \brief Describes the SpeciesModel class.
+
+#ifndef SPECIESMODEL_H_
+#define SPECIESMODEL_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+class Network;
+struct Segment;
+
+//! \class SpeciesModel
+//! \brief Additional water quality species carried along with the
+//!        constituent of the network's quality model.
+//!
+//! Species are read from the [SPECIES] section of an input file, either as
+//!   name  initQual
+//! which gives the species' initial concentration at every node, or as
+//!   name  nodeID  initQual
+//! which overrides it at a single node (the concentration held by a
+//! reservoir is the supply concentration of the species), or as
+//!   name  TRACE  nodeID
+//! which makes the species a source trace: the percent of the water at
+//! each location that came from the node. Combined with an AGE or TRACE
+//! quality model this yields water age and the contribution of several
+//! sources from a single transport pass.
+//!
+//! The reactions between species are read from the [KINETICS] section as
+//! mass action terms of the form
+//!   species  coeff  factor1  factor2 ...
+//! each adding coeff * C(factor1) * C(factor2) ... (per day) to the rate of
+//! change of the species' concentration. Terms can refer to the quality
+//! model's own constituent by its name. The lines
+//!   SOLVER     RK5 / ROS2
+//!   TOLERANCE  value
+//! select the integrator (an adaptive 5th order Runge-Kutta method or a 2nd
+//! order Rosenbrock method for stiff kinetics) and its relative tolerance.
+//!
+//! The quality solver's volume segments carry the concentrations of all
+//! species contiguously, with the quality model's constituent first, and
+//! the kinetics are integrated over a batch of segments at a time.
+
+class SpeciesModel
+{
+  public:
+
+    enum Solver {RK5, ROS2};
+    static const char* SolverWords[];
+
+    SpeciesModel();
+
+    // Input data
+    void   clear();
+    bool   addSpecies(const std::string& name);
+    bool   setInitQual(const std::string& name, int node, double initQual);
+    bool   setTraceNode(const std::string& name, int node);
+    void   addTerm(const std::string& name, double coeff,
+                   const std::vector<std::string>& factors);
+    void   compile(Network* nw);
+    void   write(std::ostream& out, Network* nw);
+
+    // Species identification (index 0 is the quality model's constituent)
+    int          width() { return (int)species.size() + 1; }
+    int          indexOf(const std::string& name, Network* nw);
+    std::string  name(int index, Network* nw);
+    bool         hasKinetics() { return terms.size() > 0; }
+
+    // Simulation
+    void   init(Network* nw);
+    double react(Segment* firstSeg, double tstep);
+    void   holdTraceSources();
+    double nodeQual(int node, int index);
+    double linkQual(int link, int index);
+
+    int                 solver;       //!< integration method used
+    double              relTol;       //!< relative tolerance of integration
+    std::vector<double> nodeValues;   //!< current species quality at nodes
+    std::vector<double> linkValues;   //!< current species quality in links
+
+  private:
+
+    struct Species
+    {
+        std::string         name;     //!< species name
+        double              initQual; //!< initial quality (user units)
+        std::vector<int>    nodes;    //!< nodes with their own initial quality
+        std::vector<double> nodeQual; //!< initial quality at these nodes
+        int                 traceNode;//!< index of node traced (or -1)
+    };
+
+    struct Term
+    {
+        std::string         name;     //!< species whose rate the term adds to
+        double              coeff;    //!< rate coefficient (user units / day)
+        std::vector<std::string> factorNames;  //!< species multiplied
+        int                 index;    //!< index of species
+        int                 first;    //!< start of the term's factor indexes
+        int                 count;    //!< number of factors
+        double              rate;     //!< rate coefficient (internal units)
+    };
+
+    std::vector<Species> species;     //!< species other than constituent
+    std::vector<Term>    terms;       //!< mass action terms of the kinetics
+    std::vector<int>     factors;     //!< species index of each term factor
+    double               absTol;      //!< absolute tolerance (mass/ft3)
+
+    // Work arrays for a batch of n segments, stored by species (the
+    // concentration of species i in segment j is at y[i*n + j])
+    int                  n;           //!< number of segments in batch
+    std::vector<double>  y, yTmp, yErr, prod;
+    std::vector<double>  k[6];
+    std::vector<double>  work;        //!< quality of a single segment
+    std::vector<double>  jac;         //!< LU factors of each segment's matrix
+    std::vector<int>     pivot;       //!< row pivots of each segment's matrix
+
+    void   findRates(const double* c, double* dcdt);
+    double findError();
+    bool   integrateRK5(double tstep);
+    bool   integrateROS2(double tstep);
+    void   factorROS2(double h);
+    void   solveROS2(double* b);
+};
+
+#endif // SPECIESMODEL_H_
@@ -7,6 +7,7 @@
 
 #include "tankmixmodel.h"
 #include "Core/error.h"
+#include "Core/simstate.h"
 #include "Models/qualmodel.h"
 #include "Elements/tank.h"
 #include "Utilities/segpool.h"
@@ -24,7 +25,9 @@ TankMixModel::TankMixModel() :
     type(MIX1),
     cTol(0.0),
     fracMixed(0.0),
-    cTank(0.0),
+    width(1),
+    cTank(1, 0.0),
+    cIn(1, 0.0),
     vMixed(0.0),
     firstSeg(nullptr),
     lastSeg(nullptr)
@@ -35,18 +38,21 @@ TankMixModel::~TankMixModel()
 
 //-----------------------------------------------------------------------------
 
-//  Initialize a tank's mixing model.
+//  Initialize a tank's mixing model with the tank's initial quality c.
 
-void TankMixModel::init(Tank* tank, SegPool* segPool, double _cTol)
+void TankMixModel::init(Tank* tank, const double* c, SegPool* segPool,
+                        double _cTol)
 {
     // ... save project's quality tolerance, initial quality, and
     //     mixing zone volume (needed only for MIX2 model)
     cTol = _cTol;
-    cTank = tank->quality;
+    width = segPool->width();
+    cTank.assign(c, c + width);
+    cIn.assign(width, 0.0);
     vMixed = fracMixed * tank->maxVolume;
 
     // ... create a volume segment for the entire tank
-    firstSeg = segPool->getSegment(tank->volume, cTank);
+    firstSeg = segPool->getSegment(tank->volume, c);
     if ( firstSeg == nullptr )
         throw SystemError(SystemError::OUT_OF_MEMORY);
     lastSeg = firstSeg;
@@ -59,7 +65,7 @@ void TankMixModel::init(Tank* tank, SegPool* segPool, double _cTol)
         firstSeg->v = v;
 
         // ... lastSeg contains mixing zone
-        lastSeg = segPool->getSegment(tank->volume - v, cTank);
+        lastSeg = segPool->getSegment(tank->volume - v, c);
         if ( lastSeg == nullptr )
             throw SystemError(SystemError::OUT_OF_MEMORY);
         firstSeg->next = lastSeg;
@@ -68,18 +74,20 @@ void TankMixModel::init(Tank* tank, SegPool* segPool, double _cTol)
 
 //-----------------------------------------------------------------------------
 
-//  Update the quality of water released by a tank.
+//  Update the quality c of water released by a tank given its net volume
+//  change vNet, its inflow volume vIn and the mass wIn carried by it.
 
-double TankMixModel::findQuality(double vNet, double vIn,
-                                 double wIn, SegPool* segPool)
+void TankMixModel::findQuality(double vNet, double vIn, const double* wIn,
+                               double* c, SegPool* segPool)
 {
 	switch (type)
 	{
-    case MIX2: return findMIX2Quality(vNet, vIn, wIn);
-    case FIFO: return findFIFOQuality(vNet, vIn, wIn, segPool);
-    case LIFO: return findLIFOQuality(vNet, vIn, wIn, segPool);
-    default:   return findMIX1Quality(vNet, vIn, wIn);
+    case MIX2: findMIX2Quality(vNet, vIn, wIn); break;
+    case FIFO: findFIFOQuality(vNet, vIn, wIn, segPool); break;
+    case LIFO: findLIFOQuality(vNet, vIn, wIn, segPool); break;
+    default:   findMIX1Quality(vNet, vIn, wIn);
 	}
+    for (int i = 0; i < width; i++) c[i] = cTank[i];
 }
 
 //-----------------------------------------------------------------------------
@@ -90,11 +98,25 @@ double TankMixModel::react(Tank* tank, QualModel* qualModel, double tstep)
 {
     double massReacted = 0.0;
     Segment* seg = firstSeg;
+
+    // ... with a first order reaction, scale each segment by the same factor
+
+    double f = qualModel->findTankFactor(tank, tstep);
+    if ( f >= 0.0 )
+    {
+        for ( ; seg; seg = seg->next)
+        {
+            massReacted += seg->c() * seg->v;
+            seg->c() *= f;
+        }
+        return massReacted * (1.0 - f);
+    }
+
     while (seg)
     {
-        double c = seg->c;
-        seg->c = qualModel->tankReact(tank, c, tstep);
-        massReacted += (c - seg->c) * seg->v;
+        double c = seg->c();
+        seg->c() = qualModel->tankReact(tank, c, tstep);
+        massReacted += (c - seg->c()) * seg->v;
         seg = seg->next;
     }
     return massReacted;
@@ -110,7 +132,7 @@ double TankMixModel::storedMass()
     Segment* seg = firstSeg;
     while (seg)
     {
-        totalMass += seg->c * seg->v;
+        totalMass += seg->c() * seg->v;
         seg = seg->next;
     }
     return totalMass;
@@ -118,42 +140,92 @@ double TankMixModel::storedMass()
 
 //-----------------------------------------------------------------------------
 
+//  Save the tank's internal quality and its list of volume segments.
+
+void TankMixModel::saveState(SimState& state)
+{
+    for (double c : cTank) state.put(c);
+    state.put(vMixed);
+    int n = 0;
+    for (Segment* seg = firstSeg; seg; seg = seg->next) n++;
+    state.put(n);
+    for (Segment* seg = firstSeg; seg; seg = seg->next)
+    {
+        state.put(seg->v);
+        for (int i = 0; i < width; i++) state.put(seg->conc()[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Restore the tank's internal quality and rebuild its volume segments
+//  (segPool must have been reset by the quality solver beforehand).
+
+void TankMixModel::restoreState(SimState& state, SegPool* segPool)
+{
+    for (double& c : cTank) c = state.get();
+    vMixed = state.get();
+    int n = state.getInt();
+    firstSeg = nullptr;
+    lastSeg = nullptr;
+    for (int i = 0; i < n; i++)
+    {
+        double v = state.get();
+        for (double& c : cIn) c = state.get();
+        Segment* seg = segPool->getSegment(v, &cIn[0]);
+        if ( seg == nullptr ) throw SystemError(SystemError::OUT_OF_MEMORY);
+        if ( lastSeg ) lastSeg->next = seg;
+        else firstSeg = seg;
+        lastSeg = seg;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 //  Find the quality released from a completely mixed tank.
 
-double TankMixModel::findMIX1Quality(double vNet, double vIn, double wIn)
+void TankMixModel::findMIX1Quality(double vNet, double vIn, const double* wIn)
 {
+    double* c = firstSeg->conc();
     double vNew = firstSeg->v + vIn;
     if ( vNew > 0.0 )
     {
-        firstSeg->c = (firstSeg->c * firstSeg->v + wIn) / vNew;
+        for (int i = 0; i < width; i++)
+        {
+            c[i] = (c[i] * firstSeg->v + wIn[i]) / vNew;
+        }
     }
     firstSeg->v += vNet;
-    cTank = firstSeg->c;
-    return cTank;
+    for (int i = 0; i < width; i++) cTank[i] = c[i];
 }
 
 //-----------------------------------------------------------------------------
 
 //  Find the quality released from the mixing zone of a 2-compartment tank.
 
-double TankMixModel::findMIX2Quality(double vNet, double vIn, double wIn)
+void TankMixModel::findMIX2Quality(double vNet, double vIn, const double* wIn)
 {
     Segment* mixZone = lastSeg;    // mixing compartment
     Segment* stagZone = firstSeg;  // stagnant compartment
+    double* cMix = mixZone->conc();
+    double* cStag = stagZone->conc();
     double vTransfer = 0.0;        // volume transferred between compartments
 
     // ... tank is filling
     if ( vNet > 0.0 )
     {
         vTransfer = max(0.0, mixZone->v + vNet - vMixed);
-        if ( vIn > 0.0 )
-        {
-            mixZone->c = (mixZone->c * mixZone->v + wIn) / (mixZone->v + vIn);
-        }
-        if ( vTransfer > 0.0 )
+        for (int i = 0; i < width; i++)
         {
-            stagZone->c = (stagZone->c * stagZone->v + mixZone->c * vTransfer) /
-                          (stagZone->v + vTransfer);
+            if ( vIn > 0.0 )
+            {
+                cMix[i] = (cMix[i] * mixZone->v + wIn[i]) / (mixZone->v + vIn);
+            }
+            if ( vTransfer > 0.0 )
+            {
+                cStag[i] = (cStag[i] * stagZone->v + cMix[i] * vTransfer) /
+                           (stagZone->v + vTransfer);
+            }
         }
     }
 
@@ -166,9 +238,12 @@ double TankMixModel::findMIX2Quality(double vNet, double vIn, double wIn)
         }
         if ( vIn + vTransfer > 0.0 )
         {
-            mixZone->c = (mixZone->c * mixZone->v + wIn +
-                          stagZone->c * vTransfer) /
-                         (mixZone->v + vIn + vTransfer);
+            for (int i = 0; i < width; i++)
+            {
+                cMix[i] = (cMix[i] * mixZone->v + wIn[i] +
+                           cStag[i] * vTransfer) /
+                          (mixZone->v + vIn + vTransfer);
+            }
         }
     }
 
@@ -188,28 +263,27 @@ double TankMixModel::findMIX2Quality(double vNet, double vIn, double wIn)
     }
 
     // ... mixing zone quality is what leaves the tank
-    cTank = mixZone->c;
-    return cTank;
+    for (int i = 0; i < width; i++) cTank[i] = cMix[i];
 }
 
 //-----------------------------------------------------------------------------
 
 //  Find the quality leaving the the first segment of a plug flow (FIFO) tank.
 
-double TankMixModel::findFIFOQuality(double vNet, double vIn, double wIn,
-                                     SegPool* segPool)
+void TankMixModel::findFIFOQuality(double vNet, double vIn, const double* wIn,
+                                   SegPool* segPool)
 {
     // ... add new last segment for flow entering the tank
     if ( vIn > 0.0 )
     {
         // ... increase segment volume if inflow has same quality as segment
-        double cIn = wIn / vIn;
-        if ( lastSeg && abs(lastSeg->c - cIn ) < cTol ) lastSeg->v += vIn;
+        for (int i = 0; i < width; i++) cIn[i] = wIn[i] / vIn;
+        if ( lastSeg && sameQuality(lastSeg->conc(), &cIn[0]) ) lastSeg->v += vIn;
 
         // ... otherwise add a new last segment to the tank
         else
         {
-            Segment* seg = segPool->getSegment(vIn, cIn);
+            Segment* seg = segPool->getSegment(vIn, &cIn[0]);
             if ( seg == nullptr ) throw SystemError(SystemError::OUT_OF_MEMORY);
             if ( firstSeg == nullptr ) firstSeg = seg;
             if ( lastSeg ) lastSeg->next = seg;
@@ -217,10 +291,11 @@ double TankMixModel::findFIFOQuality(double vNet, double vIn, double wIn,
         }
     }
 
-    // ... withdraw flow from first segment
+    // ... withdraw flow from first segment (accumulating the mass
+    //     withdrawn in cTank)
     double vSum = 0.0;
-    double wSum = 0.0;
     double vOut = vIn - vNet;
+    for (int i = 0; i < width; i++) cTank[i] = 0.0;
     while (vOut > 0.0)
     {
         Segment* seg = firstSeg;
@@ -228,7 +303,7 @@ double TankMixModel::findFIFOQuality(double vNet, double vIn, double wIn,
         double vSeg = min(seg->v, vOut);
         if ( seg == lastSeg ) vSeg = vOut;
         vSum += vSeg;
-        wSum += seg->c * vSeg;
+        for (int i = 0; i < width; i++) cTank[i] += seg->conc()[i] * vSeg;
         vOut -= vSeg;
         if ( vOut >= 0.0 && vSeg >= seg->v && seg->next )
         {
@@ -239,43 +314,46 @@ double TankMixModel::findFIFOQuality(double vNet, double vIn, double wIn,
     }
 
     // ... return average quality withdrawn from 1st segment
-    if ( vSum > 0.0 ) cTank = wSum / vSum;
-    else if ( firstSeg == nullptr ) cTank = 0.0;
-    else  cTank = firstSeg->c;
-    return cTank;
+    for (int i = 0; i < width; i++)
+    {
+        if ( vSum > 0.0 ) cTank[i] = cTank[i] / vSum;
+        else if ( firstSeg == nullptr ) cTank[i] = 0.0;
+        else  cTank[i] = firstSeg->conc()[i];
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 //  Find the quality leaving the bottom (last) segment of a vertical FIFO tank.
 
-double TankMixModel::findLIFOQuality(double vNet, double vIn, double wIn,
-                                     SegPool* segPool)
+void TankMixModel::findLIFOQuality(double vNet, double vIn, const double* wIn,
+                                   SegPool* segPool)
 {
     // ... if filling then create a new first segment
     if ( vNet > 0.0 )
     {
         // ... increase current first segment volume if inflow has same quality
-        double cIn = wIn / vIn;
-        if ( firstSeg && abs(firstSeg->c - cIn ) < cTol ) firstSeg->v += vNet;
+        for (int i = 0; i < width; i++) cIn[i] = wIn[i] / vIn;
+        if ( firstSeg && sameQuality(firstSeg->conc(), &cIn[0]) ) firstSeg->v += vNet;
 
         // ... otherwise add a new first segment to the tank
         else
         {
-            Segment* seg = segPool->getSegment(vNet, cIn);
+            Segment* seg = segPool->getSegment(vNet, &cIn[0]);
             if ( seg == nullptr ) throw SystemError(SystemError::OUT_OF_MEMORY);
             seg->next = firstSeg;
             firstSeg = seg;
         }
-        cTank = firstSeg->c;
+        for (int i = 0; i < width; i++) cTank[i] = firstSeg->conc()[i];
     }
 
     // ... if emptying then remove first segments until vNet is reached
+    //     (accumulating the mass released in cTank)
     else if ( vNet < 0.0 )
     {
         double vSum = 0.0;
-        double wSum = 0.0;
         vNet = -vNet;
+        for (int i = 0; i < width; i++) cTank[i] = 0.0;
         while ( vNet > 0.0 )
         {
             Segment* seg = firstSeg;
@@ -283,7 +361,7 @@ double TankMixModel::findLIFOQuality(double vNet, double vIn, double wIn,
             double vSeg = min(seg->v, vNet);
             if ( seg->next == nullptr ) vSeg = vNet;
             vSum += vSeg;
-            wSum += seg->c * vSeg;
+            for (int i = 0; i < width; i++) cTank[i] += seg->conc()[i] * vSeg;
             vNet -= vSeg;
             if ( vNet >= 0.0 && vSeg >= seg->v && seg->next )
             {
@@ -295,7 +373,22 @@ double TankMixModel::findLIFOQuality(double vNet, double vIn, double wIn,
 
         // ... avg. quality released is mixture of quality in flow
         //     released and any inflow
-        cTank = (wSum + wIn) / (vSum + vIn);
+        for (int i = 0; i < width; i++)
+        {
+            cTank[i] = (cTank[i] + wIn[i]) / (vSum + vIn);
+        }
     }
-    return cTank;
- }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Check if two sets of concentrations agree to within the quality tolerance.
+
+bool TankMixModel::sameQuality(const double* c1, const double* c2)
+{
+    for (int i = 0; i < width; i++)
+    {
+        if ( abs(c1[i] - c2[i]) >= cTol ) return false;
+    }
+    return true;
+}
@@ -11,13 +11,21 @@
 #ifndef TANKMIXMODEL_H_
 #define TANKMIXMODEL_H_
 
+#include <vector>
+
 class Tank;
 class QualModel;
 class SegPool;
+class SimState;
 struct Segment;
 
 //! \class TankMixModel
 //! \brief The model used to compute mixing behavior within a storage tank.
+//!
+//! The tank's volume segments carry as many quantities as those of the
+//! SegPool they come from. Mass inflows and released concentrations are
+//! passed as arrays of this length, the first entry of which is always the
+//! constituent of the network's quality model.
 
 class TankMixModel
 {
@@ -37,10 +45,14 @@ class TankMixModel
     ~TankMixModel();
 
     // Methods
-    void   init(Tank* tank, SegPool* segPool, double _cTol);
-    double findQuality(double vNet, double vIn, double wIn, SegPool* segPool);
+    void   init(Tank* tank, const double* c, SegPool* segPool, double _cTol);
+    void   findQuality(double vNet, double vIn, const double* wIn, double* c,
+                       SegPool* segPool);
     double react(Tank* tank, QualModel* qualModel, double tstep);
     double storedMass();
+    Segment* segments() { return firstSeg; }
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state, SegPool* segPool);
 
     // Properties
     int      type;           //!< type of mixing model
@@ -49,13 +61,18 @@ class TankMixModel
 
   private:
     // Methods
-    double findMIX1Quality(double vNet, double vIn, double wIn);
-    double findMIX2Quality(double vNet, double vIn, double wIn);
-    double findFIFOQuality(double vNet, double vIn, double wIn, SegPool* segPool);
-    double findLIFOQuality(double vNet, double vIn, double wIn, SegPool* segPool);
+    void   findMIX1Quality(double vNet, double vIn, const double* wIn);
+    void   findMIX2Quality(double vNet, double vIn, const double* wIn);
+    void   findFIFOQuality(double vNet, double vIn, const double* wIn,
+                           SegPool* segPool);
+    void   findLIFOQuality(double vNet, double vIn, const double* wIn,
+                           SegPool* segPool);
+    bool   sameQuality(const double* c1, const double* c2);
 
     // Properties
-    double   cTank;          //!< internal quality within tank (mass/ft3)
+    int      width;          //!< number of quantities in each segment
+    std::vector<double> cTank; //!< quality released by the tank (mass/ft3)
+    std::vector<double> cIn;   //!< quality of the tank's inflow (mass/ft3)
     double   vMixed;         //!< mixing zone volume (ft3)
     Segment* firstSeg;       //!< first volume segment in tank
     Segment* lastSeg;        //!< last volume segment in tank
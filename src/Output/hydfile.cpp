@@ -0,0 +1,196 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "hydfile.h"
+#include "Core/network.h"
+#include "Core/constants.h"
+#include "Core/error.h"
+#include "Core/simstate.h"
+#include "Elements/node.h"
+#include "Elements/link.h"
+#include "Elements/pump.h"
+#include "Elements/tank.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+static const int HydVersion = 30000;
+static const int NumHydVars = 6;
+static const int NumNodeValues = 6;
+static const int NumLinkValues = 5;
+
+//-----------------------------------------------------------------------------
+
+HydFile::HydFile() :
+    mode(CLOSED),
+    network(nullptr),
+    recordCount(0),
+    recordSize(0)
+{}
+
+//-----------------------------------------------------------------------------
+
+HydFile::~HydFile()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Opens a hydraulics file for writing or reading results for a network,
+//  writing or checking its header.
+
+void HydFile::open(Network* nw, const string& fileName, bool reading)
+{
+    close();
+    network = nw;
+    recordCount = 0;
+    int nTanks = (int)nw->tanks.size();
+    int nPumps = (int)nw->pumps.size();
+    recordSize = 2 + NumNodeValues * nw->count(Element::NODE) +
+                 NumLinkValues * nw->count(Element::LINK) + nPumps + nTanks;
+    record.resize(recordSize);
+
+    int header[NumHydVars] = {MAGICNUMBER, HydVersion,
+        nw->count(Element::NODE), nw->count(Element::LINK), nTanks, nPumps};
+
+    if ( reading )
+    {
+        file.open(fileName.c_str(), ios::in | ios::binary);
+        if ( !file.is_open() ) throw FileError(FileError::CANNOT_OPEN_HYDRAULICS_FILE);
+        int fileHeader[NumHydVars];
+        file.read((char *)fileHeader, sizeof(fileHeader));
+        for (int i = 0; i < NumHydVars; i++)
+        {
+            if ( file.fail() || fileHeader[i] != header[i] )
+            {
+                file.close();
+                throw FileError(FileError::INCOMPATIBLE_HYDRAULICS_FILE);
+            }
+        }
+        mode = READING;
+    }
+    else
+    {
+        file.open(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+        if ( !file.is_open() ) throw FileError(FileError::CANNOT_OPEN_HYDRAULICS_FILE);
+        file.write((char *)header, sizeof(header));
+        mode = WRITING;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void HydFile::close()
+{
+    file.close();
+    file.clear();
+    mode = CLOSED;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Writes the network's current hydraulic state, computed at time t and
+//  holding for the next tstep seconds.
+
+void HydFile::writeResults(int t, int tstep)
+{
+    if ( mode != WRITING ) return;
+    double* x = &record[0];
+    *x++ = t;
+    *x++ = tstep;
+    for (Node* node : network->nodes)
+    {
+        *x++ = node->head;
+        *x++ = node->fullDemand;
+        *x++ = node->actualDemand;
+        *x++ = node->emitterFlow;
+        *x++ = node->leakage;
+        *x++ = node->outflow;
+    }
+    for (Link* link : network->links)
+    {
+        *x++ = link->flow;
+        *x++ = link->leakage;
+        *x++ = link->hLoss;
+        *x++ = link->status;
+        *x++ = link->setting;
+    }
+    for (Pump* pump : network->pumps) *x++ = pump->speed;
+    for (Tank* tank : network->tanks) *x++ = tank->volume;
+
+    file.write((char *)&record[0], recordSize * sizeof(double));
+    if ( file.fail() ) throw FileError(FileError::CANNOT_WRITE_TO_HYDRAULICS_FILE);
+    recordCount++;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Reads the next time period's hydraulic state into the network, checking
+//  that it was computed at time t, and returns the time step that follows it.
+
+int HydFile::readResults(int t)
+{
+    if ( mode != READING ) return 0;
+    file.read((char *)&record[0], recordSize * sizeof(double));
+    if ( file.fail() ) throw FileError(FileError::CANNOT_READ_HYDRAULICS_FILE);
+    double* x = &record[0];
+    if ( (int)x[0] != t ) throw FileError(FileError::INCOMPATIBLE_HYDRAULICS_FILE);
+    int tstep = (int)x[1];
+    x += 2;
+
+    for (Node* node : network->nodes)
+    {
+        node->head = *x++;
+        node->fullDemand = *x++;
+        node->actualDemand = *x++;
+        node->emitterFlow = *x++;
+        node->leakage = *x++;
+        node->outflow = *x++;
+    }
+    for (Link* link : network->links)
+    {
+        link->flow = *x++;
+        link->leakage = *x++;
+        link->hLoss = *x++;
+        link->status = (int)*x++;
+        link->setting = *x++;
+    }
+    for (Pump* pump : network->pumps) pump->speed = *x++;
+    for (Tank* tank : network->tanks) tank->volume = *x++;
+    recordCount++;
+    return tstep;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Saves the number of records written or read so far; restoring it moves
+//  the file back to the record that follows them.
+
+void HydFile::saveState(SimState& state)
+{
+    state.put(recordCount);
+}
+
+void HydFile::restoreState(SimState& state)
+{
+    recordCount = state.getInt();
+    if ( mode == WRITING ) file.seekp(recordOffset(recordCount));
+    if ( mode == READING )
+    {
+        file.clear();
+        file.seekg(recordOffset(recordCount));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+streamoff HydFile::recordOffset(int index)
+{
+    return NumHydVars * sizeof(int) + (streamoff)index * recordSize * sizeof(double);
+}
@@ -0,0 +1,64 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file hydfile.h
+//! \brief Description of the HydFile class.
+
+#ifndef HYDFILE_H_
+#define HYDFILE_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Network;
+class SimState;
+
+//! \class HydFile
+//! \brief Saves hydraulic results to, and reads them back from, a binary file.
+//!
+//! A hydraulics file lets water quality be rerun (e.g., with different
+//! reaction coefficients) without solving hydraulics again. It begins with
+//! NumHydVars integers (magic number, version and element counts) followed
+//! by one record for each hydraulic time period holding the period's time
+//! and the length of the time step that follows it, and then for every node
+//! its head, full and actual demand, emitter flow, leakage and outflow, for
+//! every link its flow, leakage, head loss, status and setting, for every
+//! pump its speed and for every tank its volume. Values are saved in double
+//! precision so that a rerun reproduces the hydraulics it was saved from.
+
+class HydFile
+{
+  public:
+
+    enum Mode {CLOSED, WRITING, READING};
+
+    HydFile();
+    ~HydFile();
+
+    void   open(Network* nw, const std::string& fileName, bool reading);
+    void   close();
+    bool   isReading() { return mode == READING; }
+    bool   isWriting() { return mode == WRITING; }
+
+    void   writeResults(int time, int tstep);
+    int    readResults(int time);
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
+
+  private:
+    Mode                mode;          //!< whether file is read or written
+    std::fstream        file;          //!< binary file stream
+    Network*            network;       //!< associated network
+    int                 recordCount;   //!< records written or read so far
+    int                 recordSize;    //!< number of values in a record
+    std::vector<double> record;        //!< a time period's results
+
+    std::streamoff recordOffset(int index);
+};
+
+#endif
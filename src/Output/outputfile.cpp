@@ -9,14 +9,17 @@
 #include "Core/network.h"
 #include "Core/constants.h"
 #include "Core/error.h"
+#include "Core/simstate.h"
 #include "Elements/node.h"
 #include "Elements/link.h"
 #include "Elements/pipe.h"
 #include "Elements/pump.h"
 #include "Elements/valve.h"
 #include "Elements/qualsource.h"
+#include "Output/recordplan.h"
 
 #include <cmath>
+#include <algorithm>
 using namespace std;
 
 static int findPumpCount(Network* nw);
@@ -29,12 +32,17 @@ OutputFile::OutputFile():
     nodeCount(0),
     linkCount(0),
     pumpCount(0),
+    speciesCount(0),
     timePeriodCount(0),
     reportStart(0),
     reportStep(0),
     energyResultsOffset(0),
-    networkResultsOffset(0)
+    networkResultsOffset(0),
+    sparse(false)
 {
+    static_assert(RecordPlan::NUM_NODE_VARS == NumNodeVars &&
+                  RecordPlan::NUM_LINK_VARS == NumLinkVars,
+                  "RecordPlan variables must match output file variables");
 }
 
 //-----------------------------------------------------------------------------
@@ -82,6 +90,12 @@ int OutputFile::initWriter()
     nodeCount = network->count(Element::NODE);
     linkCount = network->count(Element::LINK);
     pumpCount = findPumpCount(network);
+    speciesCount = 0;
+    if ( network->option(Options::QUAL_TYPE) != Options::NOQUAL )
+    {
+        speciesCount = network->speciesModel.width() - 1;
+    }
+    setRecordPlan(network->recordPlan);
 
     // ... retrieve reporting time steps
     timePeriodCount = 0;
@@ -89,14 +103,15 @@ int OutputFile::initWriter()
     reportStep = network->option(Options::REPORT_STEP);
 
     // ... compute byte offsets for where energy results and network results begin
-    energyResultsOffset = NumSysVars * IntSize;
+    energyResultsOffset = NumSysVars * IntSize + recordMapSize();
     networkResultsOffset = energyResultsOffset + pumpCount *
                            (IntSize + NumPumpVars * FloatSize) + FloatSize;
 
     // ... write system info to the output file
     int sysBuf[NumSysVars];
     sysBuf[0] = MAGICNUMBER;
-    sysBuf[1] = VERSION;
+    sysBuf[1] = speciesCount > 0 ? SPECIES_VERSION :
+                sparse ? SPARSE_VERSION : VERSION;
     sysBuf[2] = 0;                     // reserved for error code
     sysBuf[3] = 0;                     // reserved for warning flag
     sysBuf[4] = energyResultsOffset;
@@ -117,6 +132,20 @@ int OutputFile::initWriter()
     sysBuf[19] = NumLinkVars;
     sysBuf[20] = NumPumpVars;
     fwriter.write((char *)sysBuf, sizeof(sysBuf));
+
+    // ... write the record map of a sparse file
+    if ( sparse )
+    {
+        int n = (int)recNodes.size();
+        fwriter.write((char *)&n, IntSize);
+        fwriter.write((char *)recNodes.data(), n * IntSize);
+        n = (int)recLinks.size();
+        fwriter.write((char *)&n, IntSize);
+        fwriter.write((char *)recLinks.data(), n * IntSize);
+        fwriter.write((char *)nodeInterval, sizeof(nodeInterval));
+        fwriter.write((char *)linkInterval, sizeof(linkInterval));
+        if ( speciesCount > 0 ) fwriter.write((char *)&speciesCount, IntSize);
+    }
     if ( fwriter.fail() ) return FileError::CANNOT_WRITE_TO_OUTPUT_FILE;
 
     // ... position the file to where network results begins
@@ -190,15 +219,144 @@ int OutputFile::writeEnergyResults(double totalHrs, double peakKwatts)
 int OutputFile::writeNetworkResults()
 {
     if ( !fwriter.is_open() || !network ) return 0;
+    writeNodeResults(timePeriodCount);
+    writeLinkResults(timePeriodCount);
+    writeSpeciesResults(timePeriodCount);
     timePeriodCount++;
-    writeNodeResults();
-    writeLinkResults();
     if ( fwriter.fail() ) return FileError::CANNOT_WRITE_TO_OUTPUT_FILE;
     return 0;
 }
 
 //-----------------------------------------------------------------------------
 
+//  Save the number of time periods written so far. Restoring it moves the
+//  writer back so that periods written after the state was saved are
+//  overwritten (any left over past the last period written are ignored
+//  since readers only see timePeriodCount periods).
+
+void OutputFile::saveState(SimState& state)
+{
+    state.put(timePeriodCount);
+}
+
+void OutputFile::restoreState(SimState& state)
+{
+    timePeriodCount = state.getInt();
+    if ( !fwriter.is_open() ) return;
+    fwriter.seekp(periodOffset(timePeriodCount));
+}
+
+//-----------------------------------------------------------------------------
+
+//  Copy into this file the periods of results written so far to another
+//  output file with the same layout, leaving the writer positioned after
+//  them.
+
+int OutputFile::copyPeriods(OutputFile& source)
+{
+    if ( !fwriter.is_open() || !network ) return 0;
+    int count = source.timePeriodCount;
+    std::streamoff first = periodOffset(0);
+    std::streamoff last = periodOffset(count);
+    if ( !source.fwriter.is_open() ||
+         source.periodOffset(0) != first ||
+         source.periodOffset(count) != last )
+    {
+        return FileError::CANNOT_READ_OUTPUT_FILE;
+    }
+
+    source.fwriter.flush();
+    ifstream fin(source.fname.c_str(), ios::in | ios::binary);
+    if ( !fin.is_open() ) return FileError::CANNOT_OPEN_OUTPUT_FILE;
+    fin.seekg(first);
+    fwriter.seekp(first);
+    vector<char> buf(1 << 16);
+    for (std::streamoff n = last - first; n > 0; )
+    {
+        std::streamsize m = (std::streamsize)min(n, (std::streamoff)buf.size());
+        if ( !fin.read(&buf[0], m) ) return FileError::CANNOT_READ_OUTPUT_FILE;
+        fwriter.write(&buf[0], m);
+        n -= m;
+    }
+    timePeriodCount = count;
+    if ( fwriter.fail() ) return FileError::CANNOT_WRITE_TO_OUTPUT_FILE;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Offset in the file of the network results for a time period (counting
+//  from 0). A variable recorded every k periods has been written for
+//  ceil(period / k) of the periods before it.
+
+std::streamoff OutputFile::periodOffset(int period)
+{
+    std::streamoff n = 0;
+    for (int k : nodeInterval)
+    {
+        if ( k > 0 ) n += (std::streamoff)recNodes.size() * ((period + k - 1) / k);
+    }
+    for (int k : linkInterval)
+    {
+        if ( k > 0 ) n += (std::streamoff)recLinks.size() * ((period + k - 1) / k);
+    }
+    int k = nodeInterval[NumNodeVars-1];
+    if ( k > 0 )
+    {
+        n += (std::streamoff)recNodes.size() * speciesCount * ((period + k - 1) / k);
+    }
+    return networkResultsOffset + n * FloatSize;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Resolve a network's recording plan into the nodes, links and variable
+//  intervals recorded in the file.
+
+void OutputFile::setRecordPlan(RecordPlan& plan)
+{
+    sparse = !plan.isFull() || speciesCount > 0;
+
+    recNodes.clear();
+    if ( plan.nodeSelection == Options::ALL )
+    {
+        for (int i = 0; i < nodeCount; i++) recNodes.push_back(i);
+    }
+    else for (int i : plan.nodes) if ( i < nodeCount ) recNodes.push_back(i);
+
+    recLinks.clear();
+    if ( plan.linkSelection == Options::ALL )
+    {
+        for (int i = 0; i < linkCount; i++) recLinks.push_back(i);
+    }
+    else for (int i : plan.links) if ( i < linkCount ) recLinks.push_back(i);
+
+    copy(plan.nodeInterval, plan.nodeInterval + NumNodeVars, nodeInterval);
+    copy(plan.linkInterval, plan.linkInterval + NumLinkVars, linkInterval);
+    setRecordMasks();
+}
+
+void OutputFile::setRecordMasks()
+{
+    nodeMask.assign(nodeCount, 0);
+    for (int i : recNodes) nodeMask[i] = 1;
+    linkMask.assign(linkCount, 0);
+    for (int i : recLinks) linkMask[i] = 1;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Size in bytes of the record map that follows the system variables.
+
+int OutputFile::recordMapSize()
+{
+    if ( !sparse ) return 0;
+    return IntSize * (2 + (int)recNodes.size() + (int)recLinks.size() +
+                      NumNodeVars + NumLinkVars + (speciesCount > 0 ? 1 : 0));
+}
+
+//-----------------------------------------------------------------------------
+
 int findPumpCount(Network* nw)
 {
     int count = 0;
@@ -211,10 +369,20 @@ int findPumpCount(Network* nw)
 
 //-----------------------------------------------------------------------------
 
-void OutputFile::writeNodeResults()
+void OutputFile::writeNodeResults(int period)
 {
     if ( fwriter.fail() ) return;
 
+    // ... variables recorded in this period
+    int vars[NumNodeVars];
+    int nVars = 0;
+    for (int v = 0; v < NumNodeVars; v++)
+    {
+        if ( nodeInterval[v] > 0 && period % nodeInterval[v] == 0 ) vars[nVars++] = v;
+    }
+    if ( nVars == 0 ) return;
+    float values[NumNodeVars];
+
     // ... units conversion factors
     double lcf = network->ucf(Units::LENGTH);
     double pcf = network->ucf(Units::PRESSURE);
@@ -223,12 +391,22 @@ void OutputFile::writeNodeResults()
     double outflow;
     double quality;
 
-    // ... results for each node
-    for (Node* node: network->nodes)
+    // ... results for each recorded node
+    for (int index : recNodes)
     {
-        // ... head, pressure, & actual demand
-        nodeResults[0] = (float)(node->head*lcf);
-        nodeResults[1] = (float)((node->head - node->elev)*pcf);
+        Node* node = network->nodes[index];
+
+        // ... head, pressure (undefined at isolated nodes), & actual demand
+        if ( node->isolated )
+        {
+            nodeResults[0] = MissingResult;
+            nodeResults[1] = MissingResult;
+        }
+        else
+        {
+            nodeResults[0] = (float)(node->head*lcf);
+            nodeResults[1] = (float)((node->head - node->elev)*pcf);
+        }
         nodeResults[2] = (float)(node->actualDemand*qcf);
 
         // ... demand deficit
@@ -245,24 +423,44 @@ void OutputFile::writeNodeResults()
         else                    quality = node->quality;
         nodeResults[5] = (float)(quality*ccf);
 
-        fwriter.write((char *)nodeResults, sizeof(nodeResults));
+        if ( nVars == NumNodeVars )
+        {
+            fwriter.write((char *)nodeResults, sizeof(nodeResults));
+        }
+        else
+        {
+            for (int i = 0; i < nVars; i++) values[i] = nodeResults[vars[i]];
+            fwriter.write((char *)values, nVars * FloatSize);
+        }
     }
 }
 
 //-----------------------------------------------------------------------------
 
-void OutputFile::writeLinkResults()
+void OutputFile::writeLinkResults(int period)
 {
     if ( fwriter.fail() ) return;
 
+    // ... variables recorded in this period
+    int vars[NumLinkVars];
+    int nVars = 0;
+    for (int v = 0; v < NumLinkVars; v++)
+    {
+        if ( linkInterval[v] > 0 && period % linkInterval[v] == 0 ) vars[nVars++] = v;
+    }
+    if ( nVars == 0 ) return;
+    float values[NumLinkVars];
+
     // ... units conversion factors
     double lcf = network->ucf(Units::LENGTH);
     double qcf = network->ucf(Units::FLOW);
     double hloss;
 
-    // ... results for each link
-    for (Link* link: network->links)
+    // ... results for each recorded link
+    for (int index : recLinks)
     {
+        Link* link = network->links[index];
+
         linkResults[0] = (float)(link->flow*qcf);                    //flow
         linkResults[1] = (float)(link->leakage*qcf);                 //leakage
         linkResults[2] = (float)(link->getVelocity()*lcf);           //velocity
@@ -273,7 +471,38 @@ void OutputFile::writeLinkResults()
         linkResults[5] = (float)link->getSetting(network);           //setting
         linkResults[6] = (float)(link->quality*FT3perL);             //quality
 
-        fwriter.write((char *)linkResults, sizeof(linkResults));
+        if ( nVars == NumLinkVars )
+        {
+            fwriter.write((char *)linkResults, sizeof(linkResults));
+        }
+        else
+        {
+            for (int i = 0; i < nVars; i++) values[i] = linkResults[vars[i]];
+            fwriter.write((char *)values, nVars * FloatSize);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write the concentrations of the additional species at each recorded node
+//  in a period when node quality is recorded.
+
+void OutputFile::writeSpeciesResults(int period)
+{
+    if ( fwriter.fail() || speciesCount == 0 ) return;
+    int k = nodeInterval[NumNodeVars-1];
+    if ( k == 0 || period % k != 0 ) return;
+
+    double ccf = network->ucf(Units::CONCEN);
+    vector<float> values(speciesCount);
+    for (int index : recNodes)
+    {
+        for (int i = 0; i < speciesCount; i++)
+        {
+            values[i] = (float)(network->speciesModel.nodeQual(index, i+1) * ccf);
+        }
+        fwriter.write((char *)values.data(), speciesCount * FloatSize);
     }
 }
 
@@ -288,6 +517,39 @@ int OutputFile::initReader()
     freader.close();
     freader.open(fname.c_str(), ios::in | ios::binary);
     if ( !freader.is_open() ) return 0;
+
+    // ... read the file's layout from its system variables & record map
+    int sysBuf[NumSysVars];
+    freader.read((char *)sysBuf, sizeof(sysBuf));
+    if ( freader.fail() || sysBuf[0] != MAGICNUMBER ) return 0;
+    sparse = (sysBuf[1] == SPARSE_VERSION || sysBuf[1] == SPECIES_VERSION);
+    nodeCount = sysBuf[6];
+    linkCount = sysBuf[7];
+    speciesCount = 0;
+    if ( sparse )
+    {
+        int n;
+        freader.read((char *)&n, IntSize);
+        recNodes.resize(n);
+        freader.read((char *)recNodes.data(), n * IntSize);
+        freader.read((char *)&n, IntSize);
+        recLinks.resize(n);
+        freader.read((char *)recLinks.data(), n * IntSize);
+        freader.read((char *)nodeInterval, sizeof(nodeInterval));
+        freader.read((char *)linkInterval, sizeof(linkInterval));
+        if ( sysBuf[1] == SPECIES_VERSION ) freader.read((char *)&speciesCount, IntSize);
+        if ( freader.fail() ) return 0;
+    }
+    else
+    {
+        recNodes.resize(nodeCount);
+        for (int i = 0; i < nodeCount; i++) recNodes[i] = i;
+        recLinks.resize(linkCount);
+        for (int i = 0; i < linkCount; i++) recLinks[i] = i;
+        fill(nodeInterval, nodeInterval + NumNodeVars, 1);
+        fill(linkInterval, linkInterval + NumLinkVars, 1);
+    }
+    setRecordMasks();
     return 1;
 }
 
@@ -307,27 +569,68 @@ void OutputFile::readEnergyDemandCharge(float* demandCharge)
     freader.read((char *)demandCharge, FloatSize);
 }
 
-void OutputFile::seekNetworkOffset()
-{
-    freader.seekg(networkResultsOffset);
-}
-
-void OutputFile::readNodeResults()
-{
-    freader.read((char *)nodeResults, sizeof(nodeResults));
-}
+//  Read the values recorded in a period of a sparse file for a set of nodes
+//  (or links) into their places in a full array of values.
 
-void OutputFile::readLinkResults()
+static void readResults(istream& fin, int period, vector<int>& items,
+                        int* interval, int nVars, float* values)
 {
-    freader.read((char *)linkResults, sizeof(linkResults));
-}
+    int vars[NumLinkVars];
+    int n = 0;
+    for (int v = 0; v < nVars; v++)
+    {
+        if ( interval[v] > 0 && period % interval[v] == 0 ) vars[n++] = v;
+    }
+    if ( n == 0 ) return;
 
-void OutputFile::skipNodeResults()
-{
-    freader.seekg(nodeCount*sizeof(nodeResults), ios::cur);
+    vector<float> buf(items.size() * n);
+    fin.read((char *)buf.data(), buf.size() * FloatSize);
+    const float* x = buf.data();
+    for (int index : items)
+    {
+        float* y = values + index * nVars;
+        for (int i = 0; i < n; i++) y[vars[i]] = *x++;
+    }
 }
 
-void OutputFile::skipLinkResults()
+//  Read the node and link results of a time period from a stream positioned
+//  at the start of it (see periodOffset), expanding a sparse period into
+//  nodeCount * NumNodeVars node values and linkCount * NumLinkVars link
+//  values with MissingResult for those not recorded. The concentrations of
+//  any additional species are expanded into nodeCount * species() values
+//  if speciesValues is supplied and skipped over otherwise. (The stream is
+//  passed in so that several periods can be read concurrently.)
+
+void OutputFile::readNetworkResults(istream& fin, int period,
+                                    float* nodeValues, float* linkValues,
+                                    float* speciesValues)
 {
-    freader.seekg(linkCount*sizeof(linkResults), ios::cur);
+    if ( !sparse )
+    {
+        fin.read((char *)nodeValues, (streamsize)nodeCount * NumNodeVars * FloatSize);
+        fin.read((char *)linkValues, (streamsize)linkCount * NumLinkVars * FloatSize);
+        return;
+    }
+    fill(nodeValues, nodeValues + nodeCount * NumNodeVars, MissingResult);
+    fill(linkValues, linkValues + linkCount * NumLinkVars, MissingResult);
+    readResults(fin, period, recNodes, nodeInterval, NumNodeVars, nodeValues);
+    readResults(fin, period, recLinks, linkInterval, NumLinkVars, linkValues);
+    if ( speciesCount == 0 ) return;
+
+    int k = nodeInterval[NumNodeVars-1];
+    bool recorded = k > 0 && period % k == 0;
+    if ( speciesValues )
+    {
+        fill(speciesValues, speciesValues + nodeCount * speciesCount, MissingResult);
+        if ( !recorded ) return;
+        for (int index : recNodes)
+        {
+            fin.read((char *)(speciesValues + index * speciesCount),
+                     speciesCount * FloatSize);
+        }
+    }
+    else if ( recorded )
+    {
+        fin.seekg((streamoff)recNodes.size() * speciesCount * FloatSize, ios::cur);
+    }
 }
@@ -13,9 +13,12 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 
 class Network;
 class ReportWriter;
+class SimState;
+class RecordPlan;
 
 const    int   IntSize = sizeof(int);
 const    int   FloatSize = sizeof(float);
@@ -23,9 +26,27 @@ const    int   NumSysVars = 21;
 const    int   NumNodeVars = 6;
 const    int   NumLinkVars = 7;
 const    int   NumPumpVars = 6;
+const    float MissingResult = -3.4e38f;   // unrecorded or undefined result
 
 //! \class OutputFile
 //! \brief Manages the writing and reading of analysis results to a binary file.
+//!
+//! The file begins with NumSysVars integers describing its contents. When
+//! the network's RecordPlan records everything (the default) they are
+//! followed by the pump energy results and then, for each reporting period,
+//! NumNodeVars values for every node and NumLinkVars values for every link.
+//! Otherwise the file's version is SPARSE_VERSION and a record map follows
+//! the system variables: the number of recorded nodes and their indexes,
+//! the same for links, and the recording interval of each node and link
+//! variable. Each period then holds, for each recorded node and link in
+//! turn, only the variables whose interval divides the period's number
+//! (counting from 0).
+//!
+//! A run that carries water quality species besides the quality model's
+//! constituent is always written in the sparse layout, with version
+//! SPECIES_VERSION. Its record map ends with the number of those species,
+//! and each period in which node quality is recorded ends with that many
+//! concentrations for every recorded node.
 
 class OutputFile
 {
@@ -39,16 +60,21 @@ class OutputFile
     int    initWriter();
     int    writeEnergyResults(double totalHrs, double peakKwatts);
     int    writeNetworkResults();
+    void   saveState(SimState& state);
+    void   restoreState(SimState& state);
+    int    copyPeriods(OutputFile& source);
 
     int    initReader();
+    void   readNetworkResults(std::istream& fin, int period,
+                              float* nodeValues, float* linkValues,
+                              float* speciesValues = nullptr);
+    int    species() { return speciesCount; }
+    bool   nodeRecorded(int index) { return nodeMask[index] != 0; }
+    bool   linkRecorded(int index) { return linkMask[index] != 0; }
     void   seekEnergyOffset();
     void   readEnergyResults(int* pumpIndex);
     void   readEnergyDemandCharge(float* demandCharge);
-    void   seekNetworkOffset();
-    void   readNodeResults();
-    void   readLinkResults();
-    void   skipNodeResults();
-    void   skipLinkResults();
+    std::streamoff periodOffset(int period);
 
     friend ReportWriter;
 
@@ -60,6 +86,7 @@ class OutputFile
     int           nodeCount;                //!< number of network nodes
     int           linkCount;                //!< number of network links
     int           pumpCount;                //!< number of pump links
+    int           speciesCount;             //!< number of additional species
     int           timePeriodCount;          //!< number of time periods written
     int           reportStart;              //!< time when reporting starts (sec)
     int           reportStep;               //!< time between reporting periods (sec)
@@ -68,8 +95,19 @@ class OutputFile
     float         nodeResults[NumNodeVars]; //!< array of node results
     float         linkResults[NumLinkVars]; //!< array of link results
     float         pumpResults[NumPumpVars]; //!< array of pump results
-    void          writeNodeResults();
-    void          writeLinkResults();
+    bool          sparse;                   //!< true if written in sparse layout
+    std::vector<int>  recNodes;             //!< indexes of recorded nodes
+    std::vector<int>  recLinks;             //!< indexes of recorded links
+    std::vector<char> nodeMask;             //!< 1 if node is recorded
+    std::vector<char> linkMask;             //!< 1 if link is recorded
+    int           nodeInterval[NumNodeVars];//!< periods between node var records
+    int           linkInterval[NumLinkVars];//!< periods between link var records
+    void          setRecordPlan(RecordPlan& plan);
+    void          setRecordMasks();
+    int           recordMapSize();
+    void          writeNodeResults(int period);
+    void          writeLinkResults(int period);
+    void          writeSpeciesResults(int period);
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include "Elements/curve.h"
 #include "Elements/pattern.h"
 #include "Elements/control.h"
+#include "Elements/rule.h"
 #include "Elements/emitter.h"
 #include "Elements/qualsource.h"
 #include "Utilities/utilities.h"
@@ -60,11 +61,13 @@ int ProjectWriter::writeFile(const char* fname, Network* nw)
     writePatterns();
     writeCurves();
     writeControls();
+    writeRules();
     writeEnergy();
     writeQuality();
     writeSources();
     writeMixing();
     writeReactions();
+    writeSpecies();
     writeOptions();
     writeTimes();
     writeReport();
@@ -442,6 +445,18 @@ void ProjectWriter::writeControls()
 
 //-----------------------------------------------------------------------------
 
+void ProjectWriter::writeRules()
+{
+    if ( network->rules.size() == 0 ) return;
+    fout << "\n[RULES]\n";
+    for (Rule* rule : network->rules)
+    {
+        fout << rule->toStr(network) << "\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void ProjectWriter::writeEnergy()
 {
     fout << "\n[ENERGY]\n";
@@ -575,6 +590,13 @@ void ProjectWriter::writeReactions()
 
 //-----------------------------------------------------------------------------
 
+void ProjectWriter::writeSpecies()
+{
+    network->speciesModel.write(fout, network);
+}
+
+//-----------------------------------------------------------------------------
+
 void ProjectWriter::writeOptions()
 {
     fout << "\n[OPTIONS]\n";
@@ -599,10 +621,100 @@ void ProjectWriter::writeReport()
 {
     fout << "\n[REPORT]\n";
     fout << network->options.reportOptionsToStr();
+    writeRecordPlan();
+    writeResultStats();
+}
+
+void ProjectWriter::writeRecordPlan()
+{
+    RecordPlan& plan = network->recordPlan;
+    const char* selection[] = {"NONE", "ALL"};
+
+    fout << left;
+    if ( plan.nodeSelection != Options::SOME )
+    {
+        if ( plan.nodeSelection != Options::ALL )
+            fout << setw(26) << "RECORD NODES" << selection[plan.nodeSelection] << "\n";
+    }
+    else for (int index : plan.nodes)
+    {
+        fout << setw(26) << "RECORD NODES" << network->node(index)->name << "\n";
+    }
+
+    if ( plan.linkSelection != Options::SOME )
+    {
+        if ( plan.linkSelection != Options::ALL )
+            fout << setw(26) << "RECORD LINKS" << selection[plan.linkSelection] << "\n";
+    }
+    else for (int index : plan.links)
+    {
+        fout << setw(26) << "RECORD LINKS" << network->link(index)->name << "\n";
+    }
+
+    // ... once one variable is named only those named are recorded,
+    //     so all of them are written if any differs from the default
+    bool allNodeVars = true;
+    for (int i = 0; i < RecordPlan::NUM_NODE_VARS; i++)
+    {
+        if ( plan.nodeInterval[i] != 1 ) allNodeVars = false;
+    }
+    if ( !allNodeVars ) for (int i = 0; i < RecordPlan::NUM_NODE_VARS; i++)
+    {
+        fout << setw(12) << "RECORD NODE" << setw(14)
+             << RecordPlan::NodeVariableWords[i] << plan.nodeInterval[i] << "\n";
+    }
+
+    bool allLinkVars = true;
+    for (int i = 0; i < RecordPlan::NUM_LINK_VARS; i++)
+    {
+        if ( plan.linkInterval[i] != 1 ) allLinkVars = false;
+    }
+    if ( !allLinkVars ) for (int i = 0; i < RecordPlan::NUM_LINK_VARS; i++)
+    {
+        fout << setw(12) << "RECORD LINK" << setw(14)
+             << RecordPlan::LinkVariableWords[i] << plan.linkInterval[i] << "\n";
+    }
+}
+
+void ProjectWriter::writeResultStats()
+{
+    ResultStats& stats = network->resultStats;
+    if ( !stats.enabled ) return;
+
+    fout << left;
+    fout << setw(26) << "STATISTICS" << "YES\n";
+    if ( stats.fractions.size() > 0 )
+    {
+        fout << setw(26) << "STATISTICS QUANTILES";
+        for (double q : stats.fractions) fout << q << " ";
+        fout << "\n";
+    }
+    for (int i = 0; i < ResultStats::MAX_VARIABLES; i++)
+    {
+        string s = string("STATISTICS ") + ResultStats::VariableWords[i];
+        if ( stats.hasLowerLimit(i) )
+        {
+            fout << setw(20) << s << setw(6) << "BELOW" << stats.lowerLimit[i] << "\n";
+        }
+        if ( stats.hasUpperLimit(i) )
+        {
+            fout << setw(20) << s << setw(6) << "ABOVE" << stats.upperLimit[i] << "\n";
+        }
+    }
 }
 
 void ProjectWriter::writeTags()
 {
+    fout << "\n[TAGS]\n";
+    for (Node* node : network->nodes)
+    {
+        if ( node->zone >= 0 )
+        {
+            fout << left << setw(8) << "NODE";
+            fout << setw(16) << node->name << " ";
+            fout << network->waterBalance.zoneNames[node->zone] << "\n";
+        }
+    }
 }
 
 void ProjectWriter::writeCoords()
@@ -40,14 +40,18 @@ class ProjectWriter
     void writePatterns();
     void writeCurves();
     void writeControls();
+    void writeRules();
     void writeQuality();
     void writeSources();
     void writeMixing();
     void writeReactions();
+    void writeSpecies();
     void writeEnergy();
     void writeTimes();
     void writeOptions();
     void writeReport();
+    void writeRecordPlan();
+    void writeResultStats();
     void writeTags();
     void writeCoords();
     void writeAuxData();
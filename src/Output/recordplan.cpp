@@ -0,0 +1,119 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "recordplan.h"
+#include "Core/options.h"
+
+#include <algorithm>
+using namespace std;
+
+const char* RecordPlan::NodeVariableWords[] =
+    {"HEAD", "PRESSURE", "DEMAND", "DEFICIT", "OUTFLOW", "QUALITY", 0};
+
+const char* RecordPlan::LinkVariableWords[] =
+    {"FLOW", "LEAKAGE", "VELOCITY", "HEADLOSS", "STATUS", "SETTING", "QUALITY", 0};
+
+//-----------------------------------------------------------------------------
+
+RecordPlan::RecordPlan()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Return to recording every variable of every node and link at each
+//  reporting period.
+
+void RecordPlan::clear()
+{
+    nodeSelection = Options::ALL;
+    linkSelection = Options::ALL;
+    nodes.clear();
+    links.clear();
+    for (int i = 0; i < NUM_NODE_VARS; i++) nodeInterval[i] = 1;
+    for (int i = 0; i < NUM_LINK_VARS; i++) linkInterval[i] = 1;
+    nodeVariablesSet = false;
+    linkVariablesSet = false;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Check if the plan records everything (the standard output file layout).
+
+bool RecordPlan::isFull()
+{
+    if ( nodeSelection != Options::ALL || linkSelection != Options::ALL )
+        return false;
+    for (int i = 0; i < NUM_NODE_VARS; i++) if ( nodeInterval[i] != 1 ) return false;
+    for (int i = 0; i < NUM_LINK_VARS; i++) if ( linkInterval[i] != 1 ) return false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Record all or none of the nodes (or links).
+
+void RecordPlan::selectNodes(int selection)
+{
+    nodeSelection = selection;
+    nodes.clear();
+}
+
+void RecordPlan::selectLinks(int selection)
+{
+    linkSelection = selection;
+    links.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Add a node (or link) to those recorded.
+
+void RecordPlan::addNode(int index)
+{
+    if ( nodeSelection != Options::SOME ) selectNodes(Options::SOME);
+    if ( find(nodes.begin(), nodes.end(), index) == nodes.end() )
+        nodes.push_back(index);
+}
+
+void RecordPlan::addLink(int index)
+{
+    if ( linkSelection != Options::SOME ) selectLinks(Options::SOME);
+    if ( find(links.begin(), links.end(), index) == links.end() )
+        links.push_back(index);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Record a node (or link) variable every interval reporting periods
+//  (0 = not recorded). Once one variable is named only the variables
+//  named are recorded.
+
+int RecordPlan::setNodeVariable(int variable, int interval)
+{
+    if ( variable < 0 || variable >= NUM_NODE_VARS || interval < 0 ) return 203;
+    if ( !nodeVariablesSet )
+    {
+        for (int i = 0; i < NUM_NODE_VARS; i++) nodeInterval[i] = 0;
+        nodeVariablesSet = true;
+    }
+    nodeInterval[variable] = interval;
+    return 0;
+}
+
+int RecordPlan::setLinkVariable(int variable, int interval)
+{
+    if ( variable < 0 || variable >= NUM_LINK_VARS || interval < 0 ) return 203;
+    if ( !linkVariablesSet )
+    {
+        for (int i = 0; i < NUM_LINK_VARS; i++) linkInterval[i] = 0;
+        linkVariablesSet = true;
+    }
+    linkInterval[variable] = interval;
+    return 0;
+}
@@ -0,0 +1,59 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file recordplan.h
+//! \brief Description of the RecordPlan class.
+
+#ifndef RECORDPLAN_H_
+#define RECORDPLAN_H_
+
+#include <vector>
+
+//! \class RecordPlan
+//! \brief Describes which results are recorded in the binary output file.
+//!
+//! By default every variable of every node and link is recorded at each
+//! reporting period. A plan can narrow this to a subset of the nodes and
+//! links, to a subset of their variables, and can record a variable only at
+//! every k-th reporting period. OutputFile writes results recorded under a
+//! narrowed plan in a sparse layout.
+
+class RecordPlan
+{
+  public:
+
+    enum NodeVariable {HEAD, PRESSURE, DEMAND, DEFICIT, OUTFLOW, NODE_QUALITY,
+                       NUM_NODE_VARS};
+    enum LinkVariable {FLOW, LEAKAGE, VELOCITY, HEADLOSS, STATUS, SETTING,
+                       LINK_QUALITY, NUM_LINK_VARS};
+    static const char* NodeVariableWords[];
+    static const char* LinkVariableWords[];
+
+    RecordPlan();
+    void    clear();
+    bool    isFull();
+
+    void    selectNodes(int selection);
+    void    selectLinks(int selection);
+    void    addNode(int index);
+    void    addLink(int index);
+    int     setNodeVariable(int variable, int interval);
+    int     setLinkVariable(int variable, int interval);
+
+    int     nodeSelection;                   //!< Options::ALL, NONE or SOME
+    int     linkSelection;                   //!< Options::ALL, NONE or SOME
+    std::vector<int> nodes;                  //!< recorded nodes if SOME
+    std::vector<int> links;                  //!< recorded links if SOME
+    int     nodeInterval[NUM_NODE_VARS];     //!< periods between records (0 = none)
+    int     linkInterval[NUM_LINK_VARS];     //!< periods between records (0 = none)
+
+  private:
+    bool    nodeVariablesSet;                //!< true once a node variable is named
+    bool    linkVariablesSet;                //!< true once a link variable is named
+};
+
+#endif
@@ -0,0 +1,140 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "reportbuffer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+static const double powersOf10[] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+
+//-----------------------------------------------------------------------------
+
+ReportBuffer::ReportBuffer(ostream& out_, size_t capacity) :
+    out(out_), buf(capacity), len(0)
+{}
+
+ReportBuffer::~ReportBuffer()
+{
+    flush();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write the contents of the buffer to the output stream.
+
+void ReportBuffer::flush()
+{
+    if ( len > 0 ) out.write(buf.data(), len);
+    len = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Make room for n more characters, flushing the buffer when full.
+
+void ReportBuffer::reserve(size_t n)
+{
+    if ( len + n <= buf.size() ) return;
+    flush();
+    if ( n > buf.size() ) buf.resize(n);
+}
+
+//-----------------------------------------------------------------------------
+
+void ReportBuffer::putPadding(int n)
+{
+    if ( n <= 0 ) return;
+    memset(&buf[len], ' ', n);
+    len += n;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Append a string justified within a field of a given width.
+
+void ReportBuffer::putText(const string& s, int width, bool leftJustify)
+{
+    int n = (int)s.size();
+    int pad = width - n;
+    reserve(n + (pad > 0 ? pad : 0));
+    if ( !leftJustify ) putPadding(pad);
+    memcpy(&buf[len], s.data(), n);
+    len += n;
+    if ( leftJustify ) putPadding(pad);
+}
+
+void ReportBuffer::putText(const string& s)
+{
+    putText(s, 0, true);
+}
+
+//-----------------------------------------------------------------------------
+
+void ReportBuffer::endLine()
+{
+    reserve(1);
+    buf[len++] = '\n';
+}
+
+//-----------------------------------------------------------------------------
+
+//  Append a number right justified within a field of a given width, using
+//  the same rules as ReportWriter::writeNumber: values below 1.0e-4 in
+//  magnitude are written as zero, values above 1.0e5 in scientific format
+//  and all others in fixed format with the given number of decimals.
+
+void ReportBuffer::putNumber(float x, int width, int precision)
+{
+    char s[32];
+    int  n;
+
+    if ( x < 1.0e-4 && x > -1.e-4 ) x = 0.0;
+    double absX = fabs(x);
+
+    // ... scientific format or non-finite values are rare, so they are
+    //     left to the C library (whose output an iostream also uses)
+    if ( absX > 1.0e5 || !(absX == absX) || precision > 4 )
+    {
+        if ( absX > 1.0e5 ) n = snprintf(s, sizeof(s), "%#.*e", precision, (double)x);
+        else                n = snprintf(s, sizeof(s), "%#.*f", precision, (double)x);
+    }
+
+    // ... fixed format: a float scaled by at most 10^4 is exact in a double,
+    //     so rounding it to an integer (ties to even, as printf does) gives
+    //     the digits directly
+    else
+    {
+        unsigned long long digits =
+            (unsigned long long)nearbyint(absX * powersOf10[precision]);
+        char* p = s + sizeof(s);
+        for (int i = 0; i < precision; i++)
+        {
+            *--p = (char)('0' + digits % 10);
+            digits /= 10;
+        }
+        *--p = '.';
+        do
+        {
+            *--p = (char)('0' + digits % 10);
+            digits /= 10;
+        } while ( digits > 0 );
+        if ( x < 0.0 ) *--p = '-';
+        n = (int)(s + sizeof(s) - p);
+        memmove(s, p, n);
+    }
+
+    int pad = width - n;
+    reserve(n + (pad > 0 ? pad : 0));
+    putPadding(pad);
+    memcpy(&buf[len], s, n);
+    len += n;
+}
@@ -0,0 +1,48 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file reportbuffer.h
+//! \brief Description of the ReportBuffer class.
+
+#ifndef REPORTBUFFER_H_
+#define REPORTBUFFER_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+//! \class ReportBuffer
+//! \brief Formats rows of a report's results tables into a memory buffer.
+//!
+//! Numbers are converted with integer arithmetic rather than through an
+//! iostream (no locale or stream state is consulted) and the buffer is
+//! handed to the output stream in large blocks. The text produced is the
+//! same as that of the stream manipulators it replaces (setw, left/right,
+//! fixed/scientific with showpoint and setprecision).
+
+class ReportBuffer
+{
+  public:
+    ReportBuffer(std::ostream& out, size_t capacity = 1 << 16);
+    ~ReportBuffer();
+
+    void putText(const std::string& s, int width, bool leftJustify);
+    void putText(const std::string& s);
+    void putNumber(float x, int width, int precision);
+    void endLine();
+    void flush();
+
+  private:
+    std::ostream&     out;       //!< stream the buffer is written to
+    std::vector<char> buf;       //!< formatted text
+    size_t            len;       //!< number of characters in buf
+
+    void reserve(size_t n);
+    void putPadding(int n);
+};
+
+#endif
@@ -15,6 +15,10 @@
 
 #include <cmath>
 #include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <algorithm>
 using namespace std;
 
 //-----------------------------------------------------------------------------
@@ -22,6 +26,7 @@ using namespace std;
 static const string statusTxt[] = {"CLOSED", "OPEN", "ACTIVE", "CLOSED"};
 static const int width = 12;
 static const int precis = 3;
+static const long long MinRowsPerThread = 50000;
 
 //-----------------------------------------------------------------------------
 
@@ -162,11 +167,12 @@ int  ReportWriter::writeReport(string inpFileName, OutputFile* outFile)
         network->msgLog.str("");
     }
     writeEnergyResults(outFile);
-    writeSavedResults(outFile);
+    int err = writeSavedResults(outFile);
+    if ( !err ) writeResultStats();
 
     // ... close the secondary report file if used
     if ( usingRptFile2 ) sout.close();
-    return 0;
+    return err;
 }
 
 //-----------------------------------------------------------------------------
@@ -187,18 +193,33 @@ void ReportWriter::writeResults(int t)
         float nodeResults[NumNodeVars];
         sout << left;
         sout << endl << endl << "  Node Results at " << theTime << " hrs" << endl;
-        writeNodeHeader();
+        writeNodeHeader(sout);
+        ReportBuffer rows(sout);
         for (Node* node : network->nodes)
         {
-            nodeResults[0] = (float)(node->head * lcf);
-            nodeResults[1] = (float)((node->head - node->elev) * pcf);
+            if ( node->isolated )
+            {
+                nodeResults[0] = MissingResult;
+                nodeResults[1] = MissingResult;
+            }
+            else
+            {
+                nodeResults[0] = (float)(node->head * lcf);
+                nodeResults[1] = (float)((node->head - node->elev) * pcf);
+            }
             nodeResults[2] = (float)(node->actualDemand * qcf);
             nodeResults[3] = (float)((node->fullDemand - node->actualDemand) * qcf);
             outflow = node->outflow * qcf;
             if ( node->type() != Node::JUNCTION ) outflow = -outflow;
             nodeResults[4] = (float)(outflow);
             nodeResults[5] = (float)(node->quality*ccf);
-            writeNodeResults(node, nodeResults);
+            writeNodeResults(rows, node, nodeResults);
+        }
+        endTable(rows);
+        if ( network->speciesModel.width() > 1 &&
+             network->option(Options::QUAL_TYPE) != Options::NOQUAL )
+        {
+            writeSpeciesResults(theTime);
         }
     }
     if (network->option(Options::REPORT_LINKS))
@@ -206,7 +227,8 @@ void ReportWriter::writeResults(int t)
         float linkResults[NumLinkVars];
         sout << left;
         sout << endl << endl << "  Link Results at " << theTime << " hrs" << endl;
-        writeLinkHeader();
+        writeLinkHeader(sout);
+        ReportBuffer rows(sout);
         for (Link* link : network->links)
         {
             linkResults[0] = (float)(link->flow * qcf);
@@ -216,8 +238,9 @@ void ReportWriter::writeResults(int t)
             if ( link->type() != Link::PIPE ) uhl *= lcf;
             linkResults[3] = (float)uhl;
             linkResults[4] = (float)link->status;
-            writeLinkResults(link, linkResults);
+            writeLinkResults(rows, link, linkResults);
         }
+        endTable(rows);
     }
 }
 
@@ -303,139 +326,473 @@ void ReportWriter::writePumpResults(Link* link, float* x)
 //-----------------------------------------------------------------------------
 
 //  Write saved results to the formatted report file at each report time period.
-
-void ReportWriter::writeSavedResults(OutputFile* outFile)
+//  Once the output file is complete its periods are independent of one
+//  another, so when there are enough results to make it worthwhile they are
+//  formatted concurrently in rounds: each thread formats its own range of a
+//  batch of consecutive periods into a text, and the texts are written to
+//  the report in order before the next batch is started. Only one batch of
+//  formatted text is held in memory at a time.
+
+int ReportWriter::writeSavedResults(OutputFile* outFile)
 {
     int nPeriods = outFile->timePeriodCount;
-    int reportStep = outFile->reportStep;
-    outFile->seekNetworkOffset();
-    int t = outFile->reportStart;
-    for (int i = 1; i <= nPeriods; i++)
+    int nThreads = findThreadCount(outFile);
+    if ( nThreads <= 1 )
+    {
+        outFile->freader.seekg(outFile->periodOffset(0));
+        ReportBuffer rows(sout);
+        bool ok = writePeriods(outFile->freader, outFile, 0, nPeriods, rows);
+        endTable(rows);
+        if ( !ok ) return FileError::CANNOT_READ_OUTPUT_FILE;
+        if ( sout.fail() ) return FileError::CANNOT_WRITE_TO_REPORT_FILE;
+        return 0;
+    }
+
+    // ... each thread reads the output file through its own stream
+    vector<ifstream> streams(nThreads);
+    for (ifstream& fin : streams)
+    {
+        fin.open(outFile->fname.c_str(), ios::in | ios::binary);
+        if ( !fin.is_open() ) return FileError::CANNOT_OPEN_OUTPUT_FILE;
+    }
+
+    // ... each thread's range holds about MinRowsPerThread rows
+    int periodsPerThread =
+        (int)max(1LL, MinRowsPerThread / findRowsPerPeriod(outFile));
+    vector<string> texts(nThreads);
+    vector<char> readFailed(nThreads);
+
+    for (int batch = 0; batch < nPeriods; batch += nThreads * periodsPerThread)
+    {
+        vector<thread> threads;
+        for (int i = 0; i < nThreads; i++)
+        {
+            int first = min(nPeriods, batch + i * periodsPerThread);
+            int last = min(nPeriods, first + periodsPerThread);
+            auto task = [this, outFile, first, last, &streams, &texts,
+                         &readFailed, i]()
+            {
+                ifstream& fin = streams[i];
+                fin.seekg(outFile->periodOffset(first));
+                ostringstream text;
+                {
+                    ReportBuffer rows(text);
+                    readFailed[i] = !writePeriods(fin, outFile, first, last, rows);
+                }
+                texts[i] = text.str();
+            };
+
+            if ( first == last )
+            {
+                threads.push_back(thread());
+                continue;
+            }
+
+            // ... a range whose thread can't be started is formatted here
+            try
+            {
+                threads.push_back(thread(task));
+            }
+            catch (...)
+            {
+                threads.push_back(thread());
+                task();
+            }
+        }
+
+        // ... write each range's text once it's been formatted, stopping
+        //     at the first range that couldn't be read
+        int err = 0;
+        for (int i = 0; i < nThreads; i++)
+        {
+            if ( threads[i].joinable() ) threads[i].join();
+            if ( readFailed[i] ) err = FileError::CANNOT_READ_OUTPUT_FILE;
+            if ( !err ) sout.write(texts[i].data(), texts[i].size());
+            texts[i].clear();
+        }
+        if ( err ) return err;
+        if ( sout.fail() ) return FileError::CANNOT_WRITE_TO_REPORT_FILE;
+    }
+    sout << left << fixed << showpoint << setprecision(precis);
+    sout.flush();
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find how many rows of node and link results each period is reported with.
+
+long long ReportWriter::findRowsPerPeriod(OutputFile* outFile)
+{
+    long long rowsPerPeriod = 0;
+    if ( network->option(Options::REPORT_NODES) ) rowsPerPeriod += outFile->nodeCount;
+    if ( network->option(Options::REPORT_LINKS) ) rowsPerPeriod += outFile->linkCount;
+    return max(rowsPerPeriod, 1LL);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Find how many threads to format the saved results with, giving each at
+//  least MinRowsPerThread rows of node and link results.
+
+int ReportWriter::findThreadCount(OutputFile* outFile)
+{
+    long long rows = findRowsPerPeriod(outFile) * outFile->timePeriodCount;
+
+    long long n = thread::hardware_concurrency();
+    n = min(n, rows / MinRowsPerThread);
+    n = min(n, (long long)outFile->timePeriodCount);
+    return (int)max(n, 1LL);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Format the saved results for time periods first through last-1, read from
+//  a stream positioned at the first of them. Returns false if the results
+//  couldn't be read.
+
+bool ReportWriter::writePeriods(
+    istream& fin, OutputFile* outFile, int first, int last, ReportBuffer& rows)
+{
+    // ... a table is written only if some of its elements were recorded
+    bool reportNodes = network->option(Options::REPORT_NODES) &&
+                       !outFile->recNodes.empty();
+    bool reportLinks = network->option(Options::REPORT_LINKS) &&
+                       !outFile->recLinks.empty();
+
+    // ... table headers are the same for every period
+    ostringstream nodeHeader;
+    ostringstream linkHeader;
+    if ( reportNodes ) writeNodeHeader(nodeHeader);
+    if ( reportLinks ) writeLinkHeader(linkHeader);
+
+    // ... any additional species are reported with the node results
+    int nSpecies = reportNodes ? outFile->species() : 0;
+    int speciesInterval = outFile->nodeInterval[NumNodeVars-1];
+    ostringstream speciesHeader;
+    if ( nSpecies > 0 ) writeSpeciesHeader(speciesHeader);
+
+    int nNodes = outFile->nodeCount;
+    int nLinks = outFile->linkCount;
+    vector<float> nodeResults(nNodes * NumNodeVars);
+    vector<float> linkResults(nLinks * NumLinkVars);
+    vector<float> speciesResults(nNodes * nSpecies);
+
+    int t = outFile->reportStart + first * outFile->reportStep;
+    for (int i = first; i < last; i++)
     {
         string theTime = Utilities::getTime(t);
+        outFile->readNetworkResults(fin, i, nodeResults.data(), linkResults.data(),
+                                    nSpecies > 0 ? speciesResults.data() : nullptr);
+        if ( !fin ) return false;
+
+        if ( reportNodes )
+        {
+            rows.putText("\n\n  Node Results at " + theTime + " hrs\n");
+            rows.putText(nodeHeader.str());
+            for (int j = 0; j < nNodes; j++)
+            {
+                if ( !outFile->nodeRecorded(j) ) continue;
+                writeNodeResults(rows, network->node(j), &nodeResults[j * NumNodeVars]);
+            }
+        }
 
-        if (network->option(Options::REPORT_NODES))
+        if ( nSpecies > 0 && speciesInterval > 0 && i % speciesInterval == 0 )
         {
-            sout << left;
-            sout << endl << endl << "  Node Results at " << theTime << " hrs" << endl;
-            writeNodeHeader();
-            for (Node* node : network->nodes)
+            rows.putText("\n\n  Node Species at " + theTime + " hrs\n");
+            rows.putText(speciesHeader.str());
+            for (int j = 0; j < nNodes; j++)
             {
-                outFile->readNodeResults();
-                writeNodeResults(node, outFile->nodeResults);
+                if ( !outFile->nodeRecorded(j) ) continue;
+                rows.putText("  ");
+                rows.putText(network->node(j)->name, 24, true);
+                putResult(rows, nodeResults[j * NumNodeVars + NumNodeVars-1]);
+                for (int k = 0; k < nSpecies; k++)
+                {
+                    putResult(rows, speciesResults[j * nSpecies + k]);
+                }
+                rows.endLine();
             }
         }
-        else outFile->skipNodeResults();
 
-        if (network->option(Options::REPORT_LINKS))
+        if ( reportLinks )
         {
-            sout << left;
-            sout << endl << endl << "  Link Results at " << theTime << " hrs" << endl;
-            writeLinkHeader();
-            for (Link* link : network->links)
+            rows.putText("\n\n  Link Results at " + theTime + " hrs\n");
+            rows.putText(linkHeader.str());
+            for (int j = 0; j < nLinks; j++)
             {
-                outFile->readLinkResults();
-                writeLinkResults(link, outFile->linkResults);
+                if ( !outFile->linkRecorded(j) ) continue;
+                writeLinkResults(rows, network->link(j), &linkResults[j * NumLinkVars]);
             }
         }
-        else outFile->skipLinkResults();
 
-        t += reportStep;
+        t += outFile->reportStep;
     }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 
-void ReportWriter::writeNodeResults(Node* node, float* x)
+//  Write tables of the result statistics accumulated during the run for the
+//  types of elements being reported on.
+
+void ReportWriter::writeResultStats()
 {
-    sout << left;
-    sout << "  " << setw(24) << node->name;
-    sout << right << fixed << showpoint;
-    for (int i = 0; i < NumNodeVars-1; i++) writeNumber(x[i], width, precis);
+    // ... column code for the range (maximum - minimum) of a variable
+    const int RangeColumn = -1;
+
+    ResultStats& stats = network->resultStats;
+    if ( !stats.isActive() ) return;
+
+    const char* titles[] = {"Node Pressure", "Node Quality", "Link Flow",
+                            "Link Velocity", "Link Leakage"};
+    string units[] = {network->getUnits(Units::PRESSURE),
+                      network->option(Options::QUAL_UNITS_NAME),
+                      network->getUnits(Units::FLOW),
+                      network->getUnits(Units::VELOCITY),
+                      network->getUnits(Units::FLOW)};
+    int nq = stats.fractions.size();
+
+    for (int v = 0; v < ResultStats::MAX_VARIABLES; v++)
+    {
+        bool isNodeVar = v < ResultStats::FLOW;
+        if ( isNodeVar && !network->option(Options::REPORT_NODES) ) continue;
+        if ( !isNodeVar && !network->option(Options::REPORT_LINKS) ) continue;
+        if ( v == ResultStats::QUALITY &&
+             network->option(Options::QUAL_TYPE) == Options::NOQUAL ) continue;
+
+        // ... the statistics making up the table's columns (only the one
+        //     chosen by the STATISTIC option unless the full set of
+        //     statistics was requested)
+        vector<int> columns = {ResultStats::MINIMUM, ResultStats::MAXIMUM,
+                               ResultStats::MEAN, ResultStats::STDDEV};
+        vector<string> labels = {"Minimum", "Maximum", "Mean", "Std. Dev."};
+        if ( !stats.enabled )
+        {
+            switch (network->option(Options::REPORT_STATISTIC))
+            {
+            case Options::AVERAGE:
+                columns = {ResultStats::MEAN};
+                labels = {"Average"};
+                break;
+            case Options::MINIMUM:
+                columns = {ResultStats::MINIMUM};
+                labels = {"Minimum"};
+                break;
+            case Options::MAXIMUM:
+                columns = {ResultStats::MAXIMUM};
+                labels = {"Maximum"};
+                break;
+            case Options::RANGE:
+                columns = {RangeColumn};
+                labels = {"Range"};
+                break;
+            }
+        }
+        for (int k = 0; stats.enabled && k < nq; k++)
+        {
+            ostringstream label;
+            label << stats.fractions[k] * 100.0 << "%";
+            columns.push_back(ResultStats::QUANTILE + k);
+            labels.push_back(label.str());
+        }
+        if ( stats.hasLowerLimit(v) )
+        {
+            columns.push_back(ResultStats::TIME_BELOW);
+            labels.push_back("Hrs Below");
+        }
+        if ( stats.hasUpperLimit(v) )
+        {
+            columns.push_back(ResultStats::TIME_ABOVE);
+            labels.push_back("Hrs Above");
+        }
+
+        // ... table header
+        string s1(24 + 12 * columns.size(), '-');
+        sout << left;
+        sout << endl << endl << "  " << titles[v] << " Statistics (" << units[v]
+             << ") over " << stats.hours() << " Hours" << endl;
+        sout << "  " << s1 << endl;
+        sout << setw(26) << (isNodeVar ? "  Node" : "  Link");
+        sout << right;
+        for (string& label : labels) sout << setw(12) << label;
+        sout << endl;
+        sout << left;
+        sout << "  " << s1 << endl;
+
+        // ... a row for each element
+        ReportBuffer rows(sout);
+        int n = stats.elementCount(v);
+        for (int i = 0; i < n; i++)
+        {
+            rows.putText("  ");
+            if ( isNodeVar ) rows.putText(network->node(i)->name, 24, true);
+            else             rows.putText(network->link(i)->name, 24, true);
+            for (int statistic : columns)
+            {
+                // ... pressure limits only apply to junctions
+                if ( v == ResultStats::PRESSURE &&
+                     statistic >= ResultStats::TIME_BELOW &&
+                     statistic <= ResultStats::TIME_ABOVE &&
+                     network->node(i)->type() != Node::JUNCTION )
+                {
+                    rows.putText("", width, false);
+                    continue;
+                }
+                double x;
+                if ( statistic == RangeColumn )
+                {
+                    double xmin;
+                    stats.getValue(v, i, ResultStats::MAXIMUM, &x);
+                    stats.getValue(v, i, ResultStats::MINIMUM, &xmin);
+                    x -= xmin;
+                }
+                else stats.getValue(v, i, statistic, &x);
+                rows.putNumber((float)x, width, precis);
+            }
+            rows.endLine();
+        }
+        endTable(rows);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void ReportWriter::writeNodeResults(ReportBuffer& rows, Node* node, float* x)
+{
+    rows.putText("  ");
+    rows.putText(node->name, 24, true);
+    for (int i = 0; i < NumNodeVars-1; i++) putResult(rows, x[i]);
     if ( network->option(Options::QUAL_TYPE) != Options::NOQUAL )
     {
-        writeNumber(x[NumNodeVars-1], width, precis);
+        putResult(rows, x[NumNodeVars-1]);
     }
-    sout << endl;
+    rows.endLine();
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write the current quality of every species at each node.
+
+void ReportWriter::writeSpeciesResults(const string& theTime)
+{
+    SpeciesModel& speciesModel = network->speciesModel;
+    int m = speciesModel.width();
+    double ccf = network->ucf(Units::CONCEN);
+
     sout << left;
+    sout << endl << endl << "  Node Species at " << theTime << " hrs" << endl;
+    writeSpeciesHeader(sout);
+
+    ReportBuffer rows(sout);
+    for (Node* node : network->nodes)
+    {
+        rows.putText("  ");
+        rows.putText(node->name, 24, true);
+        putResult(rows, (float)(node->quality*ccf));
+        for (int i = 1; i < m; i++)
+        {
+            putResult(rows, (float)(speciesModel.nodeQual(node->index, i)*ccf));
+        }
+        rows.endLine();
+    }
+    endTable(rows);
 }
 
 //-----------------------------------------------------------------------------
 
-void ReportWriter::writeNodeHeader()
+void ReportWriter::writeSpeciesHeader(ostream& out)
+{
+    SpeciesModel& speciesModel = network->speciesModel;
+    int m = speciesModel.width();
+    string s1(24 + 12*m, '-');
+
+    out << left;
+    out << "  " << s1 << endl;
+    out << setw(26) << "  Node";
+    out << right;
+    for (int i = 0; i < m; i++) out << setw(12) << speciesModel.name(i, network);
+    out << endl;
+    out << left;
+    out << "  " << s1 << endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void ReportWriter::writeNodeHeader(ostream& out)
 {
     bool hasQual = network->option(Options::QUAL_TYPE) != Options::NOQUAL;
-    sout << left;
+    out << left;
     string s1(84, '-');
     string s2 = "";
     if ( hasQual ) s2 = "------------";
-    sout << "  " << s1 << s2 << endl;
+    out << "  " << s1 << s2 << endl;
 
-    sout << setw(26) << " ";
-    sout << "        Head    Pressure      Demand     Deficit     Outflow";
+    out << setw(26) << " ";
+    out << "        Head    Pressure      Demand     Deficit     Outflow";
     if ( hasQual )
     {
-        sout << right;
-        sout << setw(12) << network->option(Options::QUAL_NAME);
+        out << right;
+        out << setw(12) << network->option(Options::QUAL_NAME);
     }
-    sout << endl;
-
-    sout << left;
-    sout << setw(26) << "  Node";
-    sout << right;
-    sout << setw(12) << network->getUnits(Units::LENGTH);
-    sout << setw(12) << network->getUnits(Units::PRESSURE);
-    sout << setw(12) << network->getUnits(Units::FLOW);
-    sout << setw(12) << network->getUnits(Units::FLOW);
-    sout << setw(12) << network->getUnits(Units::FLOW);
-    if ( hasQual ) sout << setw(12) << network->option(Options::QUAL_UNITS_NAME);
-    sout << endl;
-
-    sout << left;
-    sout << "  " << s1 << s2 << endl;
+    out << endl;
+
+    out << left;
+    out << setw(26) << "  Node";
+    out << right;
+    out << setw(12) << network->getUnits(Units::LENGTH);
+    out << setw(12) << network->getUnits(Units::PRESSURE);
+    out << setw(12) << network->getUnits(Units::FLOW);
+    out << setw(12) << network->getUnits(Units::FLOW);
+    out << setw(12) << network->getUnits(Units::FLOW);
+    if ( hasQual ) out << setw(12) << network->option(Options::QUAL_UNITS_NAME);
+    out << endl;
+
+    out << left;
+    out << "  " << s1 << s2 << endl;
 }
 
 //-----------------------------------------------------------------------------
 
-void ReportWriter::writeLinkResults(Link* link, float* x)
+void ReportWriter::writeLinkResults(ReportBuffer& rows, Link* link, float* x)
 {
-    sout << left;
-    sout << "  " << setw(24) << link->name;
-    sout << right << fixed << showpoint;
+    rows.putText("  ");
+    rows.putText(link->name, 24, true);
 
-    writeNumber(x[0], width, precis);
-    writeNumber(x[1], width, precis);
-    writeNumber(x[2], width, precis);
-    writeNumber(x[3], width, precis);
+    putResult(rows, x[0]);
+    putResult(rows, x[1]);
+    putResult(rows, x[2]);
+    putResult(rows, x[3]);
 
-    sout << setw(12) << statusTxt[(int)x[4]];
-    sout << left;
+    if ( x[4] == MissingResult ) rows.putText("", width, false);
+    else rows.putText(statusTxt[(int)x[4]], 12, false);
     if ( link->type() != Link::PIPE )
     {
-        sout << "/" << link->typeStr();
+        rows.putText("/");
+        rows.putText(link->typeStr());
     }
-    sout << endl;
+    rows.endLine();
 }
 
 //-----------------------------------------------------------------------------
 
-void ReportWriter::writeLinkHeader()
+void ReportWriter::writeLinkHeader(ostream& out)
 {
-    sout << left;
+    out << left;
     string s1(72, '-');
-    sout << "  " << s1 << endl;
-    sout << setw(26) << " ";
-    sout << "   Flow Rate     Leakage    Velocity   Head Loss      Status" << endl;
-
-    sout << setw(26) << "  Link";
-    sout << right;
-    sout << setw(12) << network->getUnits(Units::FLOW);
-    sout << setw(12) << network->getUnits(Units::FLOW);
-    sout << setw(12) << network->getUnits(Units::VELOCITY);
-    sout << setw(12) << network->getUnits(Units::HEADLOSS) << endl;
-
-    sout << left;
-    sout << "  " << s1 << endl;
+    out << "  " << s1 << endl;
+    out << setw(26) << " ";
+    out << "   Flow Rate     Leakage    Velocity   Head Loss      Status" << endl;
+
+    out << setw(26) << "  Link";
+    out << right;
+    out << setw(12) << network->getUnits(Units::FLOW);
+    out << setw(12) << network->getUnits(Units::FLOW);
+    out << setw(12) << network->getUnits(Units::VELOCITY);
+    out << setw(12) << network->getUnits(Units::HEADLOSS) << endl;
+
+    out << left;
+    out << "  " << s1 << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -455,3 +812,26 @@ void ReportWriter::writeNumber(float x, int w, int p)
     sout << setw(w) << setprecision(p) << x;
     sout << fixed;
 }
+
+//-----------------------------------------------------------------------------
+
+//  Write a result to a table row, leaving its field blank if the result
+//  was not recorded in the output file.
+
+void ReportWriter::putResult(ReportBuffer& rows, float x)
+{
+    if ( x == MissingResult ) rows.putText("", width, false);
+    else rows.putNumber(x, width, precis);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Write the rows of a results table to the report file, leaving the stream
+//  formatted as the rows would have left it.
+
+void ReportWriter::endTable(ReportBuffer& rows)
+{
+    rows.flush();
+    sout << left << fixed << showpoint << setprecision(precis);
+    sout.flush();
+}
@@ -11,6 +11,8 @@
 #ifndef REPORTWRITER_H_
 #define REPORTWRITER_H_
 
+#include "Output/reportbuffer.h"
+
 #include <string>
 #include <fstream>
 #include <iostream>
@@ -39,12 +41,21 @@ class ReportWriter
     void writeEnergyResults(OutputFile* outFile);
     void writeEnergyHeader();
     void writePumpResults(Link* link, float* x);
-    void writeSavedResults(OutputFile* outFile);
-    void writeLinkHeader();
-    void writeLinkResults(Link* link, float* x);
-    void writeNodeHeader();
-    void writeNodeResults(Node* node, float* x);
+    int  writeSavedResults(OutputFile* outFile);
+    long long findRowsPerPeriod(OutputFile* outFile);
+    int  findThreadCount(OutputFile* outFile);
+    bool writePeriods(std::istream& fin, OutputFile* outFile, int first,
+                      int last, ReportBuffer& rows);
+    void writeResultStats();
+    void writeLinkHeader(std::ostream& out);
+    void writeLinkResults(ReportBuffer& rows, Link* link, float* x);
+    void writeNodeHeader(std::ostream& out);
+    void writeNodeResults(ReportBuffer& rows, Node* node, float* x);
+    void writeSpeciesHeader(std::ostream& out);
+    void writeSpeciesResults(const std::string& theTime);
     void writeNumber(float x, int width, int precis);
+    void putResult(ReportBuffer& rows, float x);
+    void endTable(ReportBuffer& rows);
 };
 
 #endif
@@ -0,0 +1,197 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+#include "forestcoresolver.h"
+#include "Utilities/graph.h"
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+ForestCoreSolver::ForestCoreSolver(MatrixSolver* coreSolver, bool reduceSeries) :
+    core(coreSolver),
+    series(reduceSeries)
+{}
+
+ForestCoreSolver::~ForestCoreSolver()
+{
+    delete core;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds the rows to eliminate and initializes the core solver with the
+//  rows and reduced off-diagonals that remain.
+
+int ForestCoreSolver::init(int nrows, int nnz, int* xrow, int* xcol)
+{
+    diag.assign(nrows, 0.0);
+    rhs.assign(nrows, 0.0);
+    offDiag.assign(nnz, 0.0);
+    d.resize(nrows);
+    b.resize(nrows);
+
+    // ... find the rows to eliminate in the order they can be eliminated
+
+    Graph graph;
+    GraphReduction r;
+    graph.createAdjLists(nrows, nnz, xrow, xcol);
+    graph.findReduction(series ? 2 : 1, r);
+    linkMap = r.linkMap;
+    elimRows = r.nodes;
+    link1 = r.link1;
+    link2 = r.link2;
+    fill = r.fill;
+    a.resize(r.linkNode1.size());
+
+    int nElim = (int)elimRows.size();
+    nbr1.resize(nElim);
+    nbr2.resize(nElim);
+    vector<char> isElim(nrows, 0);
+    for (int m = 0; m < nElim; m++)
+    {
+        int i = elimRows[m];
+        int k = link1[m];
+        nbr1[m] = r.linkNode1[k] == i ? r.linkNode2[k] : r.linkNode1[k];
+        nbr2[m] = -1;
+        k = link2[m];
+        if ( k >= 0 ) nbr2[m] = r.linkNode1[k] == i ? r.linkNode2[k] : r.linkNode1[k];
+        isElim[i] = 1;
+    }
+
+    // ... the reduced links not joining an eliminated row belong to the core
+    //     (a self-loop off-diag. has no reduced link and is ignored)
+
+    coreLinks.clear();
+    vector<int> degree(nrows, 0);
+    int nLinks = (int)r.linkNode1.size();
+    for (int k = 0; k < nLinks; k++)
+    {
+        if ( isElim[r.linkNode1[k]] || isElim[r.linkNode2[k]] ) continue;
+        coreLinks.push_back(k);
+        degree[r.linkNode1[k]]++;
+        degree[r.linkNode2[k]]++;
+    }
+
+    // ... rows with off-diags. left are solved by the core solver, while
+    //     the roots of fully eliminated components are solved on their own
+
+    vector<int> coreIndex(nrows, -1);
+    coreRows.clear();
+    rootRows.clear();
+    for (int i = 0; i < nrows; i++)
+    {
+        if ( isElim[i] ) continue;
+        if ( degree[i] == 0 ) rootRows.push_back(i);
+        else
+        {
+            coreIndex[i] = (int)coreRows.size();
+            coreRows.push_back(i);
+        }
+    }
+    xCore.resize(coreRows.size());
+    if ( coreRows.empty() ) return 1;
+
+    int nCoreLinks = (int)coreLinks.size();
+    vector<int> row(nCoreLinks);
+    vector<int> col(nCoreLinks);
+    for (int m = 0; m < nCoreLinks; m++)
+    {
+        row[m] = coreIndex[r.linkNode1[coreLinks[m]]];
+        col[m] = coreIndex[r.linkNode2[coreLinks[m]]];
+    }
+    return core->init((int)coreRows.size(), nCoreLinks, &row[0], &col[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+void ForestCoreSolver::reset()
+{
+    diag.assign(diag.size(), 0.0);
+    rhs.assign(rhs.size(), 0.0);
+    offDiag.assign(offDiag.size(), 0.0);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Solves the system, returning -1 if successful or the index of the row
+//  where the matrix was found to be ill-conditioned.
+
+int ForestCoreSolver::solve(int n, double x[])
+{
+    d = diag;
+    b = rhs;
+
+    // ... sum the off-diags. of parallel links into their reduced link
+
+    a.assign(a.size(), 0.0);
+    int nnz = (int)offDiag.size();
+    for (int k = 0; k < nnz; k++)
+    {
+        if ( linkMap[k] >= 0 ) a[linkMap[k]] += offDiag[k];
+    }
+
+    // ... fold each eliminated row into the rows of its neighbours
+
+    int nElim = (int)elimRows.size();
+    for (int m = 0; m < nElim; m++)
+    {
+        int i = elimRows[m];
+        if ( d[i] <= 0.0 ) return i;
+        double a1 = a[link1[m]];
+        d[nbr1[m]] -= a1 * a1 / d[i];
+        b[nbr1[m]] -= a1 * b[i] / d[i];
+        if ( nbr2[m] >= 0 )
+        {
+            double a2 = a[link2[m]];
+            d[nbr2[m]] -= a2 * a2 / d[i];
+            b[nbr2[m]] -= a2 * b[i] / d[i];
+            a[fill[m]] -= a1 * a2 / d[i];
+        }
+    }
+
+    // ... solve the roots of fully eliminated components directly
+
+    for (int i : rootRows)
+    {
+        if ( d[i] <= 0.0 ) return i;
+        x[i] = b[i] / d[i];
+    }
+
+    // ... solve the looped core
+
+    int nCore = (int)coreRows.size();
+    if ( nCore > 0 )
+    {
+        core->setStats(stats);
+        core->reset();
+        for (int c = 0; c < nCore; c++)
+        {
+            core->setDiag(c, d[coreRows[c]]);
+            core->setRhs(c, b[coreRows[c]]);
+        }
+        int nCoreLinks = (int)coreLinks.size();
+        for (int m = 0; m < nCoreLinks; m++)
+        {
+            core->addToOffDiag(m, a[coreLinks[m]]);
+        }
+        int errorRow = core->solve(nCore, &xCore[0]);
+        if ( errorRow >= 0 ) return coreRows[errorRow];
+        for (int c = 0; c < nCore; c++) x[coreRows[c]] = xCore[c];
+    }
+
+    // ... sweep outward from the core to recover the eliminated rows
+
+    for (int m = nElim - 1; m >= 0; m--)
+    {
+        int i = elimRows[m];
+        double sum = b[i] - a[link1[m]] * x[nbr1[m]];
+        if ( nbr2[m] >= 0 ) sum -= a[link2[m]] * x[nbr2[m]];
+        x[i] = sum / d[i];
+    }
+    return -1;
+}
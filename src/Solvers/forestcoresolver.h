@@ -0,0 +1,82 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file forestcoresolver.h
+//! \brief Description of the ForestCoreSolver class.
+
+#ifndef FORESTCORESOLVER_H_
+#define FORESTCORESOLVER_H_
+
+#include "matrixsolver.h"
+
+#include <vector>
+
+//! \class ForestCoreSolver
+//! \brief Solves Ax = b by eliminating the tree-shaped part of a network
+//!        before passing its looped core to another matrix solver.
+//!
+//! The rows of A belonging to the forest (branched) part of the network
+//! are found with the Graph class and eliminated leaf by leaf, each leaf
+//! folding its equation into that of its parent node. This accumulates the
+//! demands of a branch onto the node it hangs from. When series reduction
+//! is chosen the interior nodes of chains of links in series are eliminated
+//! as well, which leaves the two ends of a chain joined by the equivalent
+//! conductance of its links. Only the rows of the looped core are factorized
+//! by the wrapped solver (e.g., SPARSPAK); the heads of the eliminated nodes
+//! are then recovered by a single sweep outward from the core. The
+//! elimination is exact, so the solution is the same as that of the full
+//! system.
+
+class ForestCoreSolver: public MatrixSolver
+{
+  public:
+
+    // Constructor/Destructor
+
+    ForestCoreSolver(MatrixSolver* coreSolver, bool reduceSeries);
+    ~ForestCoreSolver();
+
+    // Methods
+
+    int    init(int nrows, int nnz, int* xrow, int* xcol);
+    void   reset();
+
+    double getDiag(int i)    { return diag[i]; }
+    double getOffDiag(int i) { return offDiag[i]; }
+    double getRhs(int i)     { return rhs[i]; }
+
+    void   setDiag(int i, double a)     { diag[i] = a; }
+    void   setRhs(int i, double b)      { rhs[i] = b; }
+    void   addToDiag(int i, double a)   { diag[i] += a; }
+    void   addToOffDiag(int j, double a){ offDiag[j] += a; }
+    void   addToRhs(int i, double b)    { rhs[i] += b; }
+    int    solve(int n, double x[]);
+
+  private:
+
+    MatrixSolver*       core;        // solver for the looped core rows
+    bool                series;      // true if series nodes are eliminated
+    std::vector<int>    linkMap;     // reduced link of each off-diag.
+    std::vector<int>    elimRows;    // eliminated rows in order
+    std::vector<int>    nbr1;        // first row each one is folded into
+    std::vector<int>    nbr2;        // second row it is folded into (or -1)
+    std::vector<int>    link1;       // reduced link joining it to nbr1
+    std::vector<int>    link2;       // reduced link joining it to nbr2
+    std::vector<int>    fill;        // reduced link joining nbr1 and nbr2
+    std::vector<int>    coreRows;    // rows solved by the core solver
+    std::vector<int>    rootRows;    // rows left with no off-diags. after elimination
+    std::vector<int>    coreLinks;   // reduced links between core rows
+    std::vector<double> diag;        // diagonal coeffs. of A
+    std::vector<double> offDiag;     // off-diag. coeffs. of A
+    std::vector<double> rhs;         // right hand side vector
+    std::vector<double> d;           // work array of reduced diagonal
+    std::vector<double> b;           // work array of reduced r.h.s.
+    std::vector<double> a;           // work array of reduced off-diags.
+    std::vector<double> xCore;       // solution of the core rows
+};
+
+#endif
@@ -138,6 +138,10 @@ int GGASolver::solve(double tstep_, int& trials, int currentTime)
 
         oldErrorNorm = errorNorm;
 
+        // ... determine which nodes are cut off from all water sources
+
+        if ( statusChanged ) findIsolatedNodes();
+
         // ... determine which nodes have fixed heads (e.g., PRVs)
 
         setFixedGradeNodes();
@@ -320,20 +324,20 @@ void GGASolver::setFixedGradeNodes()
 
     // ... change fixed grade status for PRV/PSV nodes
 
-    for (Link* link : network->links)
+    for (Valve* valve : network->valves)
     {
-        // ... check if link is a PRV or PSV
+        // ... check if valve is a PRV or PSV
 
-        if      ( link->isPRV() ) node = link->toNode;
-        else if ( link->isPSV() ) node = link->fromNode;
+        if      ( valve->isPRV() ) node = valve->toNode;
+        else if ( valve->isPSV() ) node = valve->fromNode;
         else continue;
 
         // ... set the fixed grade status of the valve's control node
 
-        if ( link->status == Link::VALVE_ACTIVE )
+        if ( valve->status == Link::VALVE_ACTIVE )
         {
             node->fixedGrade = true;
-            node->head = link->setting + node->elev;
+            node->head = valve->setting + node->elev;
         }
         else node->fixedGrade = false;
     }
@@ -343,10 +347,7 @@ void GGASolver::setFixedGradeNodes()
 
     if ( theta > 0.0 && tstep > 0.0 )
     {
-        for (Node* tankNode : network->nodes)
-        {
-            if ( tankNode->type() == Node::TANK ) tankNode->fixedGrade = false;
-        }
+        for (Tank* tank : network->tanks) tank->fixedGrade = false;
     }
 
 }
@@ -359,7 +360,9 @@ int GGASolver::findHeadChanges()
 {
     // ... setup the coeff. matrix of the GGA linearized system
 
+    network->solverStats.startTimer(SolverStats::ASSEMBLY);
     setMatrixCoeffs();
+    network->solverStats.stopTimer(SolverStats::ASSEMBLY);
 
     // ... temporarily use the head change array dH[] to store new heads
 
@@ -400,6 +403,10 @@ void GGASolver::findFlowChanges()
         int n1 = link->fromNode->index;
         int n2 = link->toNode->index;
 
+        // ... links attached to isolated nodes carry no flow
+
+        if ( link->isIsolated() ) continue;
+
         // ... flow change for pressure regulating valves
 
         if ( link->hGrad == 0.0 )
@@ -433,6 +440,8 @@ void GGASolver::findFlowChanges()
 
 double GGASolver::findStepSize(int trials, int currentTime)
 {
+    int evalCount = hLossEvalCount;
+
     // ... find the new error norm at full step size
 
     double lamda = 1.0;
@@ -490,8 +499,12 @@ double GGASolver::findStepSize(int trials, int currentTime)
 			}
 			minErrorNorm = testError;
 		}
+		network->solverStats.count(SolverStats::STEP_SIZE_EVALS,
+		                           hLossEvalCount - evalCount);
 		return lamda;
 	}
+	network->solverStats.count(SolverStats::STEP_SIZE_EVALS,
+	                           hLossEvalCount - evalCount);
 	return lamda;
 }
 
@@ -593,9 +606,10 @@ void GGASolver::setLinkCoeffs()
     {
         // ... skip links with zero head gradient
         //     (e.g. active pressure regulating valves)
+        //     or attached to isolated nodes
 
         Link* link = network->link(j);
-        if ( link->hGrad == 0.0 ) continue;
+        if ( link->hGrad == 0.0 || link->isIsolated() ) continue;
 
         // ... identify end nodes of link
 
@@ -665,7 +679,7 @@ void  GGASolver::setNodeCoeffs()
         // ... if node's head not fixed
 
         Node* node = network->node(i);
-        if ( !node->fixedGrade )
+        if ( !node->fixedGrade && !node->isolated )
         {
             // ... for dynamic tanks, add area terms to row i
             //     of the head solution matrix & r.h.s. vector
@@ -694,7 +708,8 @@ void  GGASolver::setNodeCoeffs()
             matrixSolver->addToRhs(i, (double)xQ[i]);
         }
 
-        // ... if node has fixed head, force solution to produce it
+        // ... if node has fixed head (or is isolated), force solution
+        //     to produce it
 
         else
         {
@@ -714,7 +729,7 @@ void  GGASolver::setValveCoeffs()
     {
         // ... skip links that are not active pressure regulating valves
 
-        if ( link->hGrad > 0.0 ) continue;
+        if ( link->hGrad > 0.0 || link->isIsolated() ) continue;
 
         // ... determine end node indexes of link
 
@@ -748,6 +763,10 @@ bool GGASolver::linksChangedStatus()
     bool result = false;
     for (Link* link : network->links)
     {
+        // ... isolated links keep their status
+
+        if ( link->isIsolated() ) continue;
+
         // ... get head at each end of link
 
         double h1 = link->fromNode->head;
@@ -780,13 +799,29 @@ bool GGASolver::linksChangedStatus()
                 network->msgLog << endl << link->writeStatusChange(oldStatus);
             }
             result = true;
+            network->solverStats.count(SolverStats::STATUS_CHANGES);
+        }
+    }
+
+    // ... check for junctions whose demands become (or stop being)
+    //     constrained by available pressure
+
+    for (Node* node : network->nodes)
+    {
+        if ( node->isolated ) continue;
+        if ( node->updateDemandStatus(network) )
+        {
+            result = true;
+            network->solverStats.count(SolverStats::STATUS_CHANGES);
         }
     }
 	//if ( result && reportTrials ) network->msgLog << endl;
 
     // --- look for status changes caused by pressure switch controls
+    network->solverStats.startTimer(SolverStats::CONTROLS);
     if (Control::applyPressureControls(network))
         result = true;
+    network->solverStats.stopTimer(SolverStats::CONTROLS);
 
     return result;
 }
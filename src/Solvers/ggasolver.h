@@ -20,6 +20,11 @@ class HydSolver;
 
 //! \class GGASolver
 //! \brief A hydraulic solver based on Todini's Global Gradient Algorithm.
+//!
+//! Nodes cut off from every tank and reservoir by links that are shut off
+//! (see HydSolver::findIsolatedNodes) are left out of the linearized
+//! system: their heads are held fixed and the links attached to them carry
+//! no flow.
 
 class GGASolver : public HydSolver
 {
@@ -29,7 +34,7 @@ class GGASolver : public HydSolver
     ~GGASolver();
     int solve(double tstep, int& trials, int currentTime);
 
-  private:
+  protected:
 
     int        nodeCount;         // number of network nodes
     int        linkCount;         // number of network links
@@ -65,8 +70,8 @@ class GGASolver : public HydSolver
     void   setValveCoeffs();
 
     // Functions that update the hydraulic solution
-    int    findHeadChanges();
-    void   findFlowChanges();
+    virtual int  findHeadChanges();
+    virtual void findFlowChanges();
 	double findStepSize(int trials, int currentTime);
     void   updateSolution(double lamda);
 
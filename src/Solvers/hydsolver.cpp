@@ -10,12 +10,23 @@
 // Include header files for the different hydraulic solvers here.
 #include "ggasolver.h"
 #include "rwcggasolver.h"
+#include "nullspacesolver.h"
 
+#include "Core/network.h"
+#include "Elements/node.h"
+#include "Elements/link.h"
+
+#include <vector>
 using namespace std;
 
+static const string s_Isolated    = " nodes are cut off from all water sources.";
+static const string s_Reconnected = "    All nodes are connected to a water source.";
+
 HydSolver::HydSolver(Network* nw, MatrixSolver* ms) :
-    network(nw), matrixSolver(ms)
-{}
+    network(nw), matrixSolver(ms), isolatedCount(0)
+{
+    graph.createAdjLists(network);
+}
 
 HydSolver::~HydSolver() {}
 
@@ -25,6 +36,69 @@ HydSolver* HydSolver::factory(const string name, Network* nw, MatrixSolver* ms)
     // return nullptr;
 	
 	else if (name == "RWCGGA") return new RWCGGASolver(nw, ms); 
+    else if (name == "NULLSPACE") return new NullSpaceSolver(nw, ms);
     return nullptr;	
 	
 }
+
+//-----------------------------------------------------------------------------
+
+//  Identify nodes cut off from all tanks and reservoirs by links that are
+//  shut off, and give the links attached to them zero flow.
+
+void HydSolver::findIsolatedNodes()
+{
+    // ... update the connected components of the links that are not shut off
+
+    int linkCount = network->count(Element::LINK);
+    if ( !graph.hasComponents() )
+    {
+        vector<char> linkOpen(linkCount);
+        for (int k = 0; k < linkCount; k++)
+        {
+            linkOpen[k] = !network->link(k)->isShutOff();
+        }
+        graph.findComponents(linkOpen);
+    }
+    else for (int k = 0; k < linkCount; k++)
+    {
+        bool open = !network->link(k)->isShutOff();
+        if ( open == graph.isOpen(k) ) continue;
+        if ( open ) graph.openLink(k);
+        else graph.closeLink(k);
+    }
+
+    // ... nodes in a component without a tank or reservoir are isolated
+
+    vector<char> supplied(graph.componentLimit(), 0);
+    for (Node* node : network->nodes)
+    {
+        if ( node->type() != Node::JUNCTION )
+        {
+            supplied[graph.component(node->index)] = 1;
+        }
+    }
+    int count = 0;
+    for (Node* node : network->nodes)
+    {
+        node->isolated = !supplied[graph.component(node->index)];
+        if ( node->isolated ) count++;
+    }
+    for (Link* link : network->links)
+    {
+        if ( link->isIsolated() )
+        {
+            link->flow = 0.0;
+            link->hLoss = 0.0;
+        }
+    }
+
+    // ... report a change in the number of isolated nodes
+
+    if ( count != isolatedCount )
+    {
+        if ( count > 0 ) network->msgLog << endl << "    " << count << s_Isolated;
+        else network->msgLog << endl << s_Reconnected;
+        isolatedCount = count;
+    }
+}
@@ -11,6 +11,8 @@
 #ifndef HYDSOLVER_H_
 #define HYDSOLVER_H_
 
+#include "Utilities/graph.h"
+
 #include <string>
 
 class Network;
@@ -21,7 +23,11 @@ class MatrixSolver;
 //!
 //! This is an abstract class that defines an interface for a
 //! specific algorithm used for solving pipe network hydraulics at a
-//! given instance in time.
+//! given instance in time. It also identifies the nodes that links which
+//! are shut off cut off from every tank and reservoir, which each solver
+//! must leave out of its linearized system. They are found from the
+//! connected components of the open links, which a Graph object updates as
+//! individual links are opened or closed.
 
 class HydSolver
 {
@@ -42,6 +48,10 @@ class HydSolver
 
     Network*       network;
     MatrixSolver*  matrixSolver;
+    Graph          graph;          // components of the network's open links
+    int            isolatedCount;  // number of nodes cut off from all sources
+
+    void findIsolatedNodes();
 
 };
 
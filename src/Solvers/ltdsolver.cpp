@@ -13,8 +13,10 @@
 #include "Core/network.h"
 #include "Core/qualbalance.h"
 #include "Core/error.h"
+#include "Core/simstate.h"
 #include "Models/qualmodel.h"
 #include "Models/tankmixmodel.h"
+#include "Models/speciesmodel.h"
 #include "Elements/qualsource.h"
 #include "Elements/junction.h"
 #include "Elements/tank.h"
@@ -28,14 +30,18 @@ using namespace std;
 
 //  Constructor
 
-LTDSolver::LTDSolver(Network* nw) : QualSolver(nw)
+LTDSolver::LTDSolver(Network* nw) :
+    QualSolver(nw),
+    segPool(nw->usesHugePages())
 {
     nodeCount = network->count(Element::NODE);
     linkCount = network->count(Element::LINK);
+    width = 1;
     firstSegment.resize(linkCount, nullptr);
     lastSegment.resize(linkCount, nullptr);
     volIn.resize(nodeCount, 0);
     massIn.resize(nodeCount, 0);
+    cBuf.resize(width, 0);
     cTol = network->option(Options::QUAL_TOLERANCE) /
            network->ucf(Units::CONCEN);
     tstep = 0.0;
@@ -57,24 +63,28 @@ LTDSolver::~LTDSolver()
 
 void LTDSolver::init()
 {
+    // ... segments carry the quality model's constituent and any
+    //     additional species
+    width = network->speciesModel.width();
+    massIn.assign(nodeCount * width, 0.0);
+    cBuf.assign(width, 0.0);
+    segPool.init(width);
+
     // ... add one segment with downstream node quality to each pipe
-    segPool.init();
     for (int k = 0; k < linkCount; k++)
     {
         firstSegment[k] = nullptr;
         lastSegment[k] = nullptr;
         Link* link = network->link(k);
         double v = link->getVolume();
-        addSegment(k, v, link->toNode->quality);
+        getNodeQuality(link->toNode, &cBuf[0]);
+        addSegment(k, v, &cBuf[0]);
     }
 
-    for (Node* node : network->nodes)
+    for (Tank* tank : network->tanks)
     {
-        if ( node->type() == Node::TANK )
-        {
-            Tank* tank = static_cast<Tank *>(node);
-            tank->mixingModel.init(tank, &segPool, cTol);
-        }
+        getNodeQuality(tank, &cBuf[0]);
+        tank->mixingModel.init(tank, &cBuf[0], &segPool, cTol);
     }
 
     // ... initialize mass balance quantities
@@ -84,6 +94,60 @@ void LTDSolver::init()
 
 //-----------------------------------------------------------------------------
 
+//  Save the volume segments in each link and tank (along with the quality
+//  of any additional species at nodes and links).
+
+void LTDSolver::saveState(SimState& state)
+{
+    for (int k = 0; k < linkCount; k++)
+    {
+        int n = 0;
+        for (Segment* seg = firstSegment[k]; seg; seg = seg->next) n++;
+        state.put(n);
+        for (Segment* seg = firstSegment[k]; seg; seg = seg->next)
+        {
+            state.put(seg->v);
+            for (int i = 0; i < width; i++) state.put(seg->conc()[i]);
+        }
+    }
+    for (Tank* tank : network->tanks) tank->mixingModel.saveState(state);
+    for (double c : network->speciesModel.nodeValues) state.put(c);
+    for (double c : network->speciesModel.linkValues) state.put(c);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Rebuild the volume segments in each link and tank from a saved state.
+
+void LTDSolver::restoreState(SimState& state)
+{
+    segPool.init(width);
+    for (int k = 0; k < linkCount; k++)
+    {
+        firstSegment[k] = nullptr;
+        lastSegment[k] = nullptr;
+        int n = state.getInt();
+        for (int i = 0; i < n; i++)
+        {
+            double v = state.get();
+            for (double& c : cBuf) c = state.get();
+            Segment* seg = segPool.getSegment(v, &cBuf[0]);
+            if ( seg == nullptr ) throw SystemError(SystemError::OUT_OF_MEMORY);
+            if ( lastSegment[k] ) lastSegment[k]->next = seg;
+            else firstSegment[k] = seg;
+            lastSegment[k] = seg;
+        }
+    }
+    for (Tank* tank : network->tanks)
+    {
+        tank->mixingModel.restoreState(state, &segPool);
+    }
+    for (double& c : network->speciesModel.nodeValues) c = state.get();
+    for (double& c : network->speciesModel.linkValues) c = state.get();
+}
+
+//-----------------------------------------------------------------------------
+
 //  Reverse the order of the segments in a pipe to accommodate a flow reversal
 
 void LTDSolver::reverseFlow(int k)
@@ -113,13 +177,14 @@ int LTDSolver::solve(int* sortedLinks, int timeStep)
 
     // ... initialize node accumulators
     memset(&volIn[0], 0, nodeCount*sizeof(double));
-    memset(&massIn[0], 0, nodeCount*sizeof(double));
+    memset(&massIn[0], 0, nodeCount*width*sizeof(double));
 
    // ... release constituent mass flow from upstream node of each link
     for (int i = 0; i < linkCount; i++) release(sortedLinks[i]);
 
     // ... react contents of each pipe and tank
-    if ( network->qualModel->isReactive() ) react();
+    if ( network->qualModel->isReactive() ||
+         network->speciesModel.hasKinetics() ) react();
 
     // ... add mass & flow volume from each link to its downstream node
     for (int i = 0; i < linkCount; i++) transport(sortedLinks[i]);
@@ -133,6 +198,7 @@ int LTDSolver::solve(int* sortedLinks, int timeStep)
 
     // ... update the mass balance with mass outflows and final storage
     updateMassBalance();
+    network->solverStats.setPoolStats(SolverStats::SEGMENT_POOL, segPool.stats());
     return errCode;
 }
 
@@ -142,36 +208,78 @@ int LTDSolver::solve(int* sortedLinks, int timeStep)
 
 void LTDSolver::react()
 {
+    QualModel* qualModel = network->qualModel;
+    SpeciesModel& speciesModel = network->speciesModel;
+    bool isReactive = qualModel->isReactive();
+    bool hasKinetics = speciesModel.hasKinetics();
+
     // ... react contents of each pipe
     for (int i = 0; i < linkCount; i++)
     {
         // ... only pipe links have reactions in them
         Link* link = network->link(i);
         if ( link->type() != Link::PIPE ) continue;
-        Pipe* pipe = static_cast<Pipe *>(link);
+        if ( isReactive ) reactPipe(i);
 
-        // ... react contents of each pipe segment
-        network->qualModel->findMassTransCoeff(pipe);
-        Segment* seg = firstSegment[i];
-        while ( seg )
+        // ... integrate the kinetics of all species over the pipe's segments
+        if ( hasKinetics )
         {
-            double c = seg->c;
-            seg->c = network->qualModel->pipeReact(pipe, seg->c, tstep);
-            network->qualBalance.updateReacted( (c - seg->c) * seg->v );
-            seg = seg->next;
+            network->qualBalance.updateReacted(
+                speciesModel.react(firstSegment[i], tstep));
         }
     }
 
     // ... react contents of each tank
-    for (Node* node : network->nodes)
+    for (Tank* tank : network->tanks)
     {
-        if ( node->type() == Node::TANK )
+        if ( isReactive )
         {
- 	        Tank * tank = static_cast<Tank *>(node);
- 	        double massReacted =
- 	            tank->mixingModel.react(tank, network->qualModel, tstep);
+            double massReacted =
+                tank->mixingModel.react(tank, qualModel, tstep);
             network->qualBalance.updateReacted(massReacted);
         }
+        if ( hasKinetics )
+        {
+            network->qualBalance.updateReacted(
+                speciesModel.react(tank->mixingModel.segments(), tstep));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  React the quality model's constituent within a pipe
+
+void LTDSolver::reactPipe(int k)
+{
+    Pipe* pipe = static_cast<Pipe *>(network->link(k));
+
+    // ... with first order reactions, scale the contents of each
+    //     pipe segment by the same factor
+
+    double f = network->qualModel->findPipeFactor(pipe, tstep);
+    if ( f == 1.0 ) return;
+    if ( f >= 0.0 )
+    {
+        double mass = 0.0;
+        for (Segment* seg = firstSegment[k]; seg; seg = seg->next)
+        {
+            mass += seg->c() * seg->v;
+            seg->c() *= f;
+        }
+        network->qualBalance.updateReacted(mass * (1.0 - f));
+        return;
+    }
+
+    // ... otherwise react contents of each pipe segment
+    network->qualModel->findMassTransCoeff(pipe);
+    Segment* seg = firstSegment[k];
+    while ( seg )
+    {
+        double c = seg->c();
+        seg->c() = network->qualModel->pipeReact(pipe, seg->c(), tstep);
+        network->qualBalance.updateReacted( (c - seg->c()) * seg->v );
+        seg = seg->next;
     }
 }
 
@@ -190,14 +298,15 @@ void LTDSolver::release(int k)
     // ... find index (n) & quality (c) of release node
     Node* node = link->fromNode;
     if ( q < 0.0 ) node = link->toNode;
-    double c = node->quality;
-    double c1 = c;
+    double* c = &cBuf[0];
+    getNodeQuality(node, c);
+    double c1 = c[0];
 
     // ... modify node quality c to include any source input
     if ( node->qualSource && network->qualModel->type == QualModel::CHEM )
     {
-        c = node->qualSource->getQuality(node);
-        network->qualBalance.updateInflow( (c - c1) * v );
+        c[0] = node->qualSource->getQuality(node);
+        network->qualBalance.updateInflow( (c[0] - c1) * v );
     }
 
     // ... update mass balance with inflow from reservoirs
@@ -225,7 +334,7 @@ void LTDSolver::release(int k)
     {
         // ... if node quality close to segment quality
         //     then simply increase segment volume
-        if ( abs(seg->c - c) < cTol ) seg->v += v;
+        if ( sameQuality(seg->conc(), c) ) seg->v += v;
 
         // ... otherwise add a new segment at upstream end of link
         else addSegment(k, v, c);
@@ -268,7 +377,9 @@ void LTDSolver::transport(int k)
 
         // ... update volume & mass entering downstream node
         volIn[j] += vSeg;
-        massIn[j] += vSeg * seg->c;
+        double* c = seg->conc();
+        double* m = &massIn[j * width];
+        for (int i = 0; i < width; i++) m[i] += vSeg * c[i];
 
         // ... reduce remaining flow volume by amount transported
         v -= vSeg;
@@ -314,18 +425,29 @@ void LTDSolver::updateNodeQuality()
                 }
 
                 // ... new concen. is mass inflow / volume inflow
-                if ( volIn[i] > 0.0 ) node->quality = massIn[i] / volIn[i];
+                if ( volIn[i] > 0.0 )
+                {
+                    for (int j = 0; j < width; j++)
+                    {
+                        cBuf[j] = massIn[i*width + j] / volIn[i];
+                    }
+                    setNodeQuality(node, &cBuf[0]);
+                }
             }
 
             else if ( node->type() == Node::TANK )
             {
                 Tank* tank = static_cast<Tank *> (node);
-                node->quality = tank->mixingModel.findQuality(
-                                tank->outflow * tstep, volIn[i], massIn[i], &segPool);
+                tank->mixingModel.findQuality(tank->outflow * tstep, volIn[i],
+                    &massIn[i*width], &cBuf[0], &segPool);
+                setNodeQuality(node, &cBuf[0]);
             }
 
         }
     }
+
+    // ... nodes whose flow is being traced remain at full strength
+    network->speciesModel.holdTraceSources();
 }
 
 //-----------------------------------------------------------------------------
@@ -334,29 +456,45 @@ void LTDSolver::updateNodeQuality()
 
 void LTDSolver::updateLinkQuality()
 {
+    int m = width - 1;
+    double* values = network->speciesModel.linkValues.data();
+    double* nodeValues = network->speciesModel.nodeValues.data();
+    double* mass = &cBuf[0];
     for (int i = 0; i < linkCount; i++)
     {
         Link* link = network->link(i);
         double volume = 0.0;
-        double mass = 0.0;
+        for (int j = 0; j < width; j++) mass[j] = 0.0;
 
         // ... add up volume & mass in each link segment
         Segment* seg = firstSegment[i];
         while ( seg )
         {
             volume += seg->v;
-            mass += seg->c * seg->v;
+            double* c = seg->conc();
+            for (int j = 0; j < width; j++) mass[j] += c[j] * seg->v;
             seg = seg->next;
         }
 
         // ... average quality is link total mass / link total volume
-        if ( volume > 0.0 ) link->quality = mass / volume;
+        if ( volume > 0.0 )
+        {
+            link->quality = mass[0] / volume;
+            for (int j = 0; j < m; j++) values[i*m + j] = mass[j+1] / volume;
+        }
 
         // ... if there are no volume segments use avg. of end node quality
         else
         {
             link->quality = (link->fromNode->quality +
                              link->toNode->quality) / 2.0;
+            int n1 = link->fromNode->index;
+            int n2 = link->toNode->index;
+            for (int j = 0; j < m; j++)
+            {
+                values[i*m + j] = (nodeValues[n1*m + j] +
+                                   nodeValues[n2*m + j]) / 2.0;
+            }
         }
     }
 }
@@ -372,14 +510,10 @@ double LTDSolver::findStoredMass()
     {
         totalMass += link->quality * link->getVolume();
     }
-    for (Node* node : network->nodes)
+    // ... only Tanks store WQ mass
+    for (Tank* tank : network->tanks)
     {
-        // ... only Tanks store WQ mass
-        if ( node->type() == Node::TANK )
-        {
-  	        Tank * tank = static_cast<Tank *>(node);
-            totalMass += max(0.0, tank->mixingModel.storedMass());
-        }
+        totalMass += max(0.0, tank->mixingModel.storedMass());
     }
     return totalMass;
 }
@@ -407,7 +541,7 @@ void LTDSolver::updateMassBalance()
 
 //  Add a new segment to the end of a pipe
 
-void LTDSolver::addSegment(int k, double v, double c)
+void LTDSolver::addSegment(int k, double v, const double* c)
 {
     // ... do nothing if there's no volume to add
     if ( v == 0.0 ) return;
@@ -424,3 +558,40 @@ void LTDSolver::addSegment(int k, double v, double c)
     if ( lastSeg ) lastSeg->next = seg;
     lastSegment[k] = seg;
 }
+
+//-----------------------------------------------------------------------------
+
+//  Get the quality of each quantity carried by the segments at a node
+
+void LTDSolver::getNodeQuality(Node* node, double* c)
+{
+    c[0] = node->quality;
+    if ( width == 1 ) return;
+    int m = width - 1;
+    const double* values = &network->speciesModel.nodeValues[node->index * m];
+    for (int i = 0; i < m; i++) c[i+1] = values[i];
+}
+
+//  Set the quality of each quantity carried by the segments at a node
+
+void LTDSolver::setNodeQuality(Node* node, const double* c)
+{
+    node->quality = c[0];
+    if ( width == 1 ) return;
+    int m = width - 1;
+    double* values = &network->speciesModel.nodeValues[node->index * m];
+    for (int i = 0; i < m; i++) values[i] = c[i+1];
+}
+
+//-----------------------------------------------------------------------------
+
+//  Check if two sets of concentrations agree to within the quality tolerance
+
+bool LTDSolver::sameQuality(const double* c1, const double* c2)
+{
+    for (int i = 0; i < width; i++)
+    {
+        if ( abs(c1[i] - c2[i]) >= cTol ) return false;
+    }
+    return true;
+}
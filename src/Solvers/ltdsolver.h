@@ -16,9 +16,14 @@
 #include <vector>
 
 class Network;
+class Node;
 
 //! \class LTDSolver
 //! \brief A water quality solver based on the Lagrangian Time Driven method.
+//!
+//! Each volume segment carries the concentration of the quality model's
+//! constituent followed by those of any additional species, so that all of
+//! them are transported by a single walk through the network's segments.
 
 class LTDSolver : public QualSolver
 {
@@ -30,27 +35,35 @@ class LTDSolver : public QualSolver
     void init();
     void reverseFlow(int k);
     int  solve(int* sortedLinks, int timeStep);
+    void saveState(SimState& state);
+    void restoreState(SimState& state);
 
   private:
 	int                    nodeCount;        // number of nodes
 	int                    linkCount;        // number of links
+	int                    width;            // quantities carried by a segment
 	double                 cTol;             // quality tolerance (mass/ft3)
 	double                 tstep;            // time step (sec)
 
 	std::vector<double>    volIn;            // volume inflow to each node
-	std::vector<double>    massIn;           // mass inflow to each node
+	std::vector<double>    massIn;           // mass inflow of each quantity to each node
+	std::vector<double>    cBuf;             // quality of a single node or segment
 	std::vector<Segment *> firstSegment;     // ptr. to first segment in each link
 	std::vector<Segment *> lastSegment;      // ptr. to last segment in each link
 	SegPool                segPool;          // pool of pipe segment objects
 
 	void   react();
+	void   reactPipe(int k);
 	void   release(int k);
 	void   transport(int k);
 	void   updateNodeQuality();
 	void   updateLinkQuality();
 	double findStoredMass();
 	void   updateMassBalance();
-    void   addSegment(int k, double v, double c);
+    void   addSegment(int k, double v, const double* c);
+    void   getNodeQuality(Node* node, double* c);
+    void   setNodeQuality(Node* node, const double* c);
+    bool   sameQuality(const double* c1, const double* c2);
 
 };
 
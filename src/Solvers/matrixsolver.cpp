@@ -13,7 +13,7 @@
 
 using namespace std;
 
-MatrixSolver::MatrixSolver() {}
+MatrixSolver::MatrixSolver() : stats(nullptr) {}
 
 MatrixSolver::~MatrixSolver() {}
 
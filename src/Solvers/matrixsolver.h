@@ -14,6 +14,8 @@
 #include <string>
 #include <ostream>
 
+struct SolverStats;
+
 //! \class MatrixSolver
 //! \brief Abstract class for solving a set of linear equations.
 //!
@@ -47,6 +49,11 @@ class MatrixSolver
     virtual int    solve(int nRows, double x[]) = 0;
 
     virtual void  debug(std::ostream& out) {}
+
+    void           setStats(SolverStats* s) { stats = s; }
+
+  protected:
+    SolverStats*   stats;           //!< collects factorization timing
 };
 
 #endif
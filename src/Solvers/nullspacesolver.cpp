@@ -0,0 +1,564 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Distributed under the MIT License (see the LICENSE file for details).
+ *
+ */
+
+ ////////////////////////////////////////////////////
+ //  Implementation of the null space (loop flow)  //
+ //  formulation of the GGA hydraulic solver.      //
+ ////////////////////////////////////////////////////
+
+#include "nullspacesolver.h"
+#include "matrixsolver.h"
+#include "Core/network.h"
+#include "Core/constants.h"
+#include "Core/error.h"
+#include "Elements/node.h"
+#include "Elements/tank.h"
+#include "Elements/link.h"
+#include "Utilities/graph.h"
+
+#include <cstring>
+#include <unordered_map>
+using namespace std;
+
+//-----------------------------------------------------------------------------
+
+//  Constructor/Destructor
+
+NullSpaceSolver::NullSpaceSolver(Network* nw, MatrixSolver* ms) :
+    GGASolver(nw, ms),
+    loopSolver(nullptr),
+    groundNode(nodeCount),
+    loopCount(0),
+    built(false)
+{
+    signature.resize(nodeCount + linkCount, 0);
+    newHead.resize(nodeCount + 1, 0.0);
+    netInflow.resize(nodeCount + 1, 0.0);
+    demand.resize(nodeCount + 1, 0.0);
+    demandGrad.resize(nodeCount + 1, 0.0);
+    parentFlow.resize(nodeCount + 1, 0.0);
+    parentGrad.resize(nodeCount + 1, 0.0);
+}
+
+NullSpaceSolver::~NullSpaceSolver()
+{
+    delete loopSolver;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds new heads and flows for the current trial by solving the linearized
+//  equations for loop flow corrections.
+
+int NullSpaceSolver::findHeadChanges()
+{
+    // ... rebuild the loops if the edges of the graph have changed
+
+    network->solverStats.startTimer(SolverStats::ASSEMBLY);
+    if ( structureChanged() )
+    {
+        int errorCode = buildLoops();
+        if ( errorCode >= 0 )
+        {
+            network->solverStats.stopTimer(SolverStats::ASSEMBLY);
+            return errorCode;
+        }
+    }
+
+    // ... find flows that satisfy continuity along the spanning tree
+
+    setEdgeValues();
+    findTreeFlows();
+    network->solverStats.stopTimer(SolverStats::ASSEMBLY);
+
+    // ... correct them around each loop and find the heads they produce
+
+    int errorCode = findLoopFlows();
+    if ( errorCode >= 0 ) return errorCode;
+    findTreeHeads();
+
+    for (int i = 0; i < nodeCount; i++)
+    {
+        dH[i] = newHead[i] - network->node(i)->head;
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds the changes in link flows from the new flows found for the trial.
+
+void NullSpaceSolver::findFlowChanges()
+{
+    for (int i = 0; i < linkCount; i++)
+    {
+        dQ[i] = 0.0;
+        Link* link = network->link(i);
+        int n1 = link->fromNode->index;
+        int n2 = link->toNode->index;
+        if ( link->isIsolated() ) continue;
+
+        // ... flow change for pressure regulating valves (as in GGASolver)
+
+        if ( linkEdge[i] < 0 )
+        {
+            if ( link->isPRV() ) dQ[i] = -xQ[n2] - link->flow;
+            if ( link->isPSV() ) dQ[i] = xQ[n1] - link->flow;
+            continue;
+        }
+
+        // ... special case to prevent negative flow in constant HP pumps
+
+        double dq = link->flow - newFlow[linkEdge[i]];
+        if ( link->isHpPump() &&
+             link->status == Link::LINK_OPEN &&
+             dq > link->flow ) dq = link->flow / 2.0;
+        dQ[i] = -dq;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds the external outflow of a node with variable head and the outflow's
+//  gradient with respect to head, as used by GGASolver::setNodeCoeffs.
+
+void NullSpaceSolver::findOutflow(Node* node, double& outflow, double& gradient)
+{
+    outflow = 0.0;
+    gradient = 0.0;
+    if ( node->type() == Node::TANK && theta != 0.0 )
+    {
+        Tank* tank = static_cast<Tank*>(node);
+        gradient = tank->area / (theta * tstep);
+        outflow = gradient * (tank->head - tank->pastHead) -
+                  (1.0 - theta) * tank->pastOutflow / theta;
+    }
+    else if ( node->type() == Node::JUNCTION )
+    {
+        outflow = node->outflow;
+        gradient = node->qGrad;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Checks if the nodes joined to ground or the active pressure regulating
+//  valves have changed since the loops were built. Isolated nodes are treated
+//  as fixed grade nodes and the links attached to them are left out of the
+//  graph, like active pressure regulating valves. A tank keeps its edge to
+//  ground whether or not its level is fixed, so the structure stays the same
+//  from one time step to the next.
+
+bool NullSpaceSolver::structureChanged()
+{
+    bool changed = !built;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        Node* node = network->node(i);
+        char grounded = node->fixedGrade || node->isolated ||
+                        node->type() == Node::TANK;
+        if ( signature[i] != grounded ) changed = true;
+        signature[i] = grounded;
+    }
+    for (int k = 0; k < linkCount; k++)
+    {
+        Link* link = network->link(k);
+        char removed = link->hGrad == 0.0 || link->isIsolated();
+        if ( signature[nodeCount + k] != removed ) changed = true;
+        signature[nodeCount + k] = removed;
+    }
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Builds the graph's edges, its spanning tree, the loops formed by the edges
+//  not in the tree and the symbolic factorization of the loop equations.
+//  Returns the index of a node that can't be reached from a fixed grade node
+//  or a tank, or -1 if there is none.
+
+int NullSpaceSolver::buildLoops()
+{
+    // ... the edges are the links with a head loss gradient, plus an edge
+    //     to the ground node from each fixed grade node or tank
+
+    built = false;
+    edgeType.clear();
+    edgeRef.clear();
+    edgeFrom.clear();
+    edgeTo.clear();
+    linkEdge.assign(linkCount, -1);
+    for (int k = 0; k < linkCount; k++)
+    {
+        if ( signature[nodeCount + k] ) continue;
+        Link* link = network->link(k);
+        linkEdge[k] = (int)edgeType.size();
+        edgeType.push_back(LINK_EDGE);
+        edgeRef.push_back(k);
+        edgeFrom.push_back(link->fromNode->index);
+        edgeTo.push_back(link->toNode->index);
+    }
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if ( signature[i] == 0 ) continue;
+        edgeType.push_back(FIXED_EDGE);
+        edgeRef.push_back(i);
+        edgeFrom.push_back(i);
+        edgeTo.push_back(groundNode);
+    }
+    int edgeCount = (int)edgeType.size();
+    resist.resize(edgeCount);
+    drop.resize(edgeCount);
+    flow.resize(edgeCount);
+    newFlow.resize(edgeCount);
+
+    // ... find a breadth-first spanning tree rooted at the ground node
+    //     (which places every fixed grade node's edge in the tree)
+
+    Graph edgeGraph;
+    edgeGraph.createAdjLists(nodeCount + 1, edgeCount, &edgeFrom[0], &edgeTo[0]);
+    edgeGraph.findSpanningTree(groundNode, treeOrder, parentEdge);
+    if ( (int)treeOrder.size() < nodeCount + 1 )
+    {
+        for (int i = 0; i < nodeCount; i++)
+        {
+            if ( parentEdge[i] < 0 ) return i;
+        }
+    }
+
+    vector<int> depth(nodeCount + 1, 0);
+    treeEdge.assign(edgeCount, 0);
+    for (int i : treeOrder)
+    {
+        int t = parentEdge[i];
+        if ( t < 0 ) continue;
+        int p = edgeFrom[t] == i ? edgeTo[t] : edgeFrom[t];
+        depth[i] = depth[p] + 1;
+        treeEdge[t] = 1;
+    }
+
+    // ... each edge not in the tree closes a loop with the tree path
+    //     between its end nodes
+
+    loopBeg.assign(1, 0);
+    loopEdges.clear();
+    loopSigns.clear();
+    for (int c = 0; c < edgeCount; c++)
+    {
+        if ( treeEdge[c] ) continue;
+        loopEdges.push_back(c);
+        loopSigns.push_back(1);
+        int a = edgeFrom[c];
+        int b = edgeTo[c];
+        while ( a != b )
+        {
+            if ( depth[b] >= depth[a] )
+            {
+                int t = parentEdge[b];
+                loopEdges.push_back(t);
+                loopSigns.push_back(edgeFrom[t] == b ? 1 : -1);
+                b = edgeFrom[t] == b ? edgeTo[t] : edgeFrom[t];
+            }
+            else
+            {
+                int t = parentEdge[a];
+                loopEdges.push_back(t);
+                loopSigns.push_back(edgeFrom[t] == a ? -1 : 1);
+                a = edgeFrom[t] == a ? edgeTo[t] : edgeFrom[t];
+            }
+        }
+        loopBeg.push_back((int)loopEdges.size());
+    }
+    loopCount = (int)loopBeg.size() - 1;
+    loopFlow.resize(loopCount);
+
+    // ... list the loops passing through each edge
+
+    vector<int> edgeLoopBeg(edgeCount + 1, 0);
+    for (int e : loopEdges) edgeLoopBeg[e + 1]++;
+    for (int e = 0; e < edgeCount; e++) edgeLoopBeg[e + 1] += edgeLoopBeg[e];
+    vector<int> edgeLoops(loopEdges.size());
+    vector<int> edgeSigns(loopEdges.size());
+    vector<int> next(edgeLoopBeg.begin(), edgeLoopBeg.end() - 1);
+    for (int l = 0; l < loopCount; l++)
+    {
+        for (int m = loopBeg[l]; m < loopBeg[l + 1]; m++)
+        {
+            int n = next[loopEdges[m]]++;
+            edgeLoops[n] = l;
+            edgeSigns[n] = loopSigns[m];
+        }
+    }
+
+    // ... each pair of loops sharing an edge has an off-diagonal coeff.
+
+    unordered_map<long long, int> pairIndex;
+    vector<int> pairRow;
+    vector<int> pairCol;
+    pairTerms.clear();
+    pairEdges.clear();
+    pairSigns.clear();
+    for (int e = 0; e < edgeCount; e++)
+    {
+        for (int m1 = edgeLoopBeg[e]; m1 < edgeLoopBeg[e + 1]; m1++)
+        {
+            for (int m2 = m1 + 1; m2 < edgeLoopBeg[e + 1]; m2++)
+            {
+                int l1 = edgeLoops[m1];
+                int l2 = edgeLoops[m2];
+                long long key = (long long)min(l1, l2) * loopCount + max(l1, l2);
+                auto it = pairIndex.find(key);
+                int index;
+                if ( it == pairIndex.end() )
+                {
+                    index = (int)pairRow.size();
+                    pairIndex[key] = index;
+                    pairRow.push_back(l1);
+                    pairCol.push_back(l2);
+                }
+                else index = it->second;
+                pairTerms.push_back(index);
+                pairEdges.push_back(e);
+                pairSigns.push_back(edgeSigns[m1] * edgeSigns[m2]);
+            }
+        }
+    }
+
+    // ... create the loop equation solver and factorize symbolically
+    //     (loops that share no edges are solved directly)
+
+    delete loopSolver;
+    loopSolver = nullptr;
+    if ( !pairRow.empty() )
+    {
+        loopSolver = MatrixSolver::factory(
+            network->option(Options::MATRIX_SOLVER), network->msgLog);
+        if ( loopSolver == nullptr ||
+             !loopSolver->init(loopCount, (int)pairRow.size(), &pairRow[0], &pairCol[0]) )
+        {
+            throw SystemError(SystemError::MATRIX_SOLVER_NOT_OPENED);
+        }
+        loopSolver->setStats(&network->solverStats);
+    }
+    built = true;
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds the resistance of each edge, its head drop and its flow at the
+//  current solution.
+
+void NullSpaceSolver::setEdgeValues()
+{
+    int edgeCount = (int)edgeType.size();
+    for (int e = 0; e < edgeCount; e++)
+    {
+        if ( edgeType[e] == LINK_EDGE )
+        {
+            Link* link = network->link(edgeRef[e]);
+            resist[e] = link->hGrad;
+            drop[e] = link->hLoss;
+            flow[e] = link->flow;
+        }
+
+        // ... the edge of a tank whose level varies carries its outflow,
+        //     drops its head and has the inverse of the outflow's gradient
+        //     as its resistance
+
+        else
+        {
+            Node* node = network->node(edgeRef[e]);
+            double outflow, gradient;
+            findOutflow(node, outflow, gradient);
+            if ( !node->fixedGrade && !node->isolated && gradient > 0.0 )
+            {
+                edgeType[e] = TANK_EDGE;
+                resist[e] = 1.0 / gradient;
+                flow[e] = outflow;
+            }
+
+            // ... a fixed grade node's edge drops its head with no resistance
+
+            else
+            {
+                edgeType[e] = FIXED_EDGE;
+                resist[e] = 0.0;
+                flow[e] = 0.0;
+            }
+            drop[e] = node->head;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds flows through the tree edges that satisfy continuity at each node
+//  when the other edges keep their current flows, along with the heads they
+//  produce.
+
+void NullSpaceSolver::findTreeFlows()
+{
+    // ... find each node's flow imbalance the same way GGASolver does
+
+    memset(&xQ[0], 0, nodeCount*sizeof(double));
+    for (Link* link : network->links)
+    {
+        if ( link->hGrad == 0.0 || link->isIsolated() ) continue;
+        xQ[link->fromNode->index] -= link->flow;
+        xQ[link->toNode->index] += link->flow;
+    }
+
+    // ... nodes without an edge to ground must discharge their outflow,
+    //     which changes with their head at the rate demandGrad
+
+    for (int i = 0; i < nodeCount; i++)
+    {
+        demand[i] = 0.0;
+        demandGrad[i] = 0.0;
+        if ( signature[i] ) continue;
+        Node* node = network->node(i);
+        findOutflow(node, demand[i], demandGrad[i]);
+        xQ[i] -= demand[i];
+    }
+
+    // ... the upstream node of an active PRV (or downstream node of an
+    //     active PSV) supplies the net outflow of the valve's other node
+
+    for (Link* link : network->links)
+    {
+        if ( link->hGrad > 0.0 || link->isIsolated() ) continue;
+        if ( link->isPRV() ) demand[link->fromNode->index] -= xQ[link->toNode->index];
+        if ( link->isPSV() ) demand[link->toNode->index] -= xQ[link->fromNode->index];
+    }
+
+    // ... start with the flows of the edges not in the tree
+
+    int edgeCount = (int)edgeType.size();
+    netInflow.assign(nodeCount + 1, 0.0);
+    for (int e = 0; e < edgeCount; e++)
+    {
+        if ( treeEdge[e] ) continue;
+        newFlow[e] = flow[e];
+        netInflow[edgeFrom[e]] -= flow[e];
+        netInflow[edgeTo[e]] += flow[e];
+    }
+
+    // ... work from the outermost nodes in, expressing the flow each node
+    //     draws from its parent (to balance its other flows) as a linear
+    //     function of the change in the parent's head: with a change dh_p
+    //     in the parent's head the node's head changes by
+    //     dh = dh_p + e - r * f where e holds the terms fixed by the current
+    //     solution, and the node draws f = need + grad * dh
+
+    for (int m = nodeCount; m > 0; m--)
+    {
+        int i = treeOrder[m];
+        int t = parentEdge[i];
+        if ( edgeType[t] == FIXED_EDGE ) continue;
+        int p = edgeFrom[t] == i ? edgeTo[t] : edgeFrom[t];
+        double s = edgeFrom[t] == p ? 1.0 : -1.0;
+        double hp = p == groundNode ? 0.0 : network->node(p)->head;
+        double e = hp - network->node(i)->head - s * (drop[t] - resist[t] * flow[t]);
+        double need = demand[i] - netInflow[i];
+        double grad = demandGrad[i];
+        double d = 1.0 + grad * resist[t];
+        parentFlow[i] = (need + grad * e) / d;
+        parentGrad[i] = grad / d;
+        netInflow[p] -= parentFlow[i];
+        demandGrad[p] += parentGrad[i];
+    }
+
+    // ... then work outward from the ground node setting the flow in each
+    //     node's parent edge and the head it produces
+
+    newHead[groundNode] = 0.0;
+    for (int m = 1; m <= nodeCount; m++)
+    {
+        int i = treeOrder[m];
+        int t = parentEdge[i];
+        if ( edgeType[t] == FIXED_EDGE )
+        {
+            newFlow[t] = 0.0;
+            newHead[i] = drop[t];
+            continue;
+        }
+        int p = edgeFrom[t] == i ? edgeTo[t] : edgeFrom[t];
+        double s = edgeFrom[t] == p ? 1.0 : -1.0;
+        double dhp = p == groundNode ? 0.0 : newHead[p] - network->node(p)->head;
+        newFlow[t] = s * (parentFlow[i] + parentGrad[i] * dhp);
+        newHead[i] = newHead[p] - s * (drop[t] + resist[t] * (newFlow[t] - flow[t]));
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Solves the linearized head loss equations around each loop for the loop
+//  flow corrections and adds them to the edge flows. Returns the index of a
+//  node on the loop where the equations were ill-conditioned, or -1.
+
+int NullSpaceSolver::findLoopFlows()
+{
+    if ( loopCount == 0 ) return -1;
+
+    network->solverStats.startTimer(SolverStats::ASSEMBLY);
+    if ( loopSolver ) loopSolver->reset();
+    int errorCode = -1;
+    for (int l = 0; l < loopCount; l++)
+    {
+        double a = 0.0;
+        double b = 0.0;
+        for (int m = loopBeg[l]; m < loopBeg[l + 1]; m++)
+        {
+            int e = loopEdges[m];
+            a += resist[e];
+            b -= loopSigns[m] * (drop[e] + resist[e] * (newFlow[e] - flow[e]));
+        }
+        if ( loopSolver )
+        {
+            loopSolver->setDiag(l, a);
+            loopSolver->setRhs(l, b);
+        }
+        else if ( a > 0.0 ) loopFlow[l] = b / a;
+        else if ( errorCode < 0 ) errorCode = l;
+    }
+    int nTerms = (int)pairTerms.size();
+    for (int m = 0; m < nTerms; m++)
+    {
+        loopSolver->addToOffDiag(pairTerms[m], pairSigns[m] * resist[pairEdges[m]]);
+    }
+    network->solverStats.stopTimer(SolverStats::ASSEMBLY);
+
+    if ( loopSolver ) errorCode = loopSolver->solve(loopCount, &loopFlow[0]);
+    if ( errorCode >= 0 ) return edgeFrom[loopEdges[loopBeg[errorCode]]];
+
+    for (int l = 0; l < loopCount; l++)
+    {
+        for (int m = loopBeg[l]; m < loopBeg[l + 1]; m++)
+        {
+            newFlow[loopEdges[m]] += loopSigns[m] * loopFlow[l];
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds new heads by working outward from the ground node along the tree.
+
+void NullSpaceSolver::findTreeHeads()
+{
+    newHead[groundNode] = 0.0;
+    for (int m = 1; m <= nodeCount; m++)
+    {
+        int i = treeOrder[m];
+        int t = parentEdge[i];
+        double h = drop[t] + resist[t] * (newFlow[t] - flow[t]);
+        if ( edgeFrom[t] == i ) newHead[i] = newHead[edgeTo[t]] + h;
+        else                    newHead[i] = newHead[edgeFrom[t]] - h;
+    }
+}
@@ -0,0 +1,106 @@
+/* EPANET 3.1.1 Pressure Management Extension
+ *
+ * Copyright (c) 2016 Open Water Analytics
+ * Licensed under the terms of the MIT License (see the LICENSE file for details).
+ *
+ */
+
+//! \file nullspacesolver.h
+//! \brief Describes the NullSpaceSolver class.
+
+#ifndef NULLSPACESOLVER_H_
+#define NULLSPACESOLVER_H_
+
+#include "Solvers/ggasolver.h"
+
+#include <vector>
+
+class MatrixSolver;
+class Node;
+
+//! \class NullSpaceSolver
+//! \brief A hydraulic solver that finds each Newton step of the Global
+//!        Gradient Algorithm in terms of loop flows.
+//!
+//! The network's nodes are joined to a ground node by an edge for each fixed
+//! grade node and each tank (which has a resistance equal to the inverse of
+//! its outflow's gradient once its level varies with time weighting). A
+//! spanning tree of this graph is found with the Graph class. Flows that
+//! satisfy continuity are then found by accumulating node outflows inward
+//! along the tree, where the outflow of a junction that depends on its head
+//! (emitters, leakage or pressure dependent demands) is carried as a linear
+//! function of the head change, and heads by a sweep outward. The flow
+//! corrections around the loops formed by each link not in the tree are
+//! found by solving a sparse system whose size is the number of loops rather
+//! than the number of nodes, and the heads then follow from a second sweep.
+//! The trial loop, step sizing and status checks are inherited from
+//! GGASolver. Without head dependent outflows the step is the same as
+//! GGASolver's; with them the loop corrections leave out the outflows'
+//! response, which later trials make up for. The tree, the loops and the
+//! symbolic factorization of the loop matrix are only rebuilt when the set
+//! of fixed grade nodes, isolated nodes or active pressure regulating valves
+//! changes.
+
+class NullSpaceSolver : public GGASolver
+{
+  public:
+
+    NullSpaceSolver(Network* nw, MatrixSolver* ms);
+    ~NullSpaceSolver();
+
+  protected:
+
+    int    findHeadChanges();
+    void   findFlowChanges();
+
+  private:
+
+    enum EdgeType {LINK_EDGE, TANK_EDGE, FIXED_EDGE};
+
+    MatrixSolver*       loopSolver;   // solver for the loop flow equations
+    int                 groundNode;   // index of the ground node
+    int                 loopCount;    // number of independent loops
+    bool                built;        // true once the loops have been built
+    std::vector<char>   signature;    // edge structure the loops were built for
+
+    // Edges of the graph
+    std::vector<int>    edgeType;     // type of each edge
+    std::vector<int>    edgeRef;      // link or node each edge represents
+    std::vector<int>    edgeFrom;     // start node of each edge
+    std::vector<int>    edgeTo;       // end node of each edge
+    std::vector<int>    linkEdge;     // edge representing each link (or -1)
+
+    // Spanning tree and loops
+    std::vector<int>    treeOrder;    // nodes in breadth-first order
+    std::vector<int>    parentEdge;   // edge joining each node to its parent
+    std::vector<char>   treeEdge;     // true for the edges in the tree
+    std::vector<int>    loopBeg;      // start of each loop's edges in loopEdges
+    std::vector<int>    loopEdges;    // edges around each loop
+    std::vector<int>    loopSigns;    // direction of each edge around its loop
+    std::vector<int>    pairTerms;    // off-diag. each shared edge contributes to
+    std::vector<int>    pairEdges;    // edge shared by a pair of loops
+    std::vector<int>    pairSigns;    // product of its directions in the two loops
+
+    // Work arrays
+    std::vector<double> resist;       // resistance of each edge
+    std::vector<double> drop;         // head drop across each edge at current flow
+    std::vector<double> flow;         // current flow through each edge
+    std::vector<double> newFlow;      // new flow through each edge
+    std::vector<double> demand;       // outflow each node must discharge
+    std::vector<double> demandGrad;   // gradient of that outflow w.r.t. head
+    std::vector<double> netInflow;    // net inflow of each node from known flows
+    std::vector<double> parentFlow;   // flow drawn from each node's parent ...
+    std::vector<double> parentGrad;   // ... and its gradient w.r.t. parent's head
+    std::vector<double> newHead;      // new head of each node
+    std::vector<double> loopFlow;     // flow correction around each loop
+
+    void   findOutflow(Node* node, double& outflow, double& gradient);
+    bool   structureChanged();
+    int    buildLoops();
+    void   setEdgeValues();
+    void   findTreeFlows();
+    int    findLoopFlows();
+    void   findTreeHeads();
+};
+
+#endif
@@ -16,6 +16,7 @@
 
 class Network;
 class Link;
+class SimState;
 
 //! \class QualSolver
 //! \brief Abstract class from which a specific water quality solver is derived.
@@ -35,6 +36,8 @@ class QualSolver
     virtual void   init() { }
     virtual void   reverseFlow(int linkIndex) { }
     virtual int    solve(int* sortedLinks, int timeStep) = 0;
+    virtual void   saveState(SimState& state) { }
+    virtual void   restoreState(SimState& state) { }
 
   protected:
     Network*     network;
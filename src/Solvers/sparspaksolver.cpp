@@ -7,6 +7,7 @@
 
 #include "sparspaksolver.h"
 #include "sparspak.h"
+#include "Core/solverstats.h"
 
 #include <cstring>
 #include <limits>
@@ -180,7 +181,13 @@ int SparspakSolver::solve(int n, double x[])
 *********************************************/
 
     int flag;
+    if ( stats ) stats->startTimer(SolverStats::FACTORIZATION);
     sp_numfct(nrows, xlnz, lnz, xnzsub, nzsub, diag, link, first, temp, flag);
+    if ( stats )
+    {
+        stats->stopTimer(SolverStats::FACTORIZATION);
+        stats->count(SolverStats::FACTORIZATIONS);
+    }
 
     // if the matrix was ill-conditioned, return the problematic row
     if ( flag )
@@ -192,7 +199,9 @@ int SparspakSolver::solve(int n, double x[])
     }
 
     // call sp_solve() to solve the system LDL'x = b
+    if ( stats ) stats->startTimer(SolverStats::BACK_SUBSTITUTION);
     sp_solve(nrows, xlnz, lnz, xnzsub, nzsub, diag, rhs);
+    if ( stats ) stats->stopTimer(SolverStats::BACK_SUBSTITUTION);
 
     // transfer results from rhs to x (recognizing that rhs
     // arrays are offset by 1)
@@ -25,7 +25,7 @@ using namespace std;
 
 //  Constructor/Destructor
 
-Graph::Graph()
+Graph::Graph() : searchCount(0)
 {
 }
 
@@ -36,19 +36,37 @@ Graph::~Graph()
 //-----------------------------------------------------------------------------
 
 void Graph::createAdjLists(Network* nw)
+{
+    int nodeCount = nw->count(Element::NODE);
+    int linkCount = nw->count(Element::LINK);
+    vector<int> node1(linkCount);
+    vector<int> node2(linkCount);
+    for (int k = 0; k < linkCount; k++)
+    {
+        node1[k] = nw->link(k)->fromNode->index;
+        node2[k] = nw->link(k)->toNode->index;
+    }
+    createAdjLists(nodeCount, linkCount, &node1[0], &node2[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Creates adjacency lists from the start and end node indexes of each link.
+
+void Graph::createAdjLists(int nodeCount, int linkCount, int node1[], int node2[])
 {
     try
     {
-        int nodeCount = nw->count(Element::NODE);
-        int linkCount = nw->count(Element::LINK);
-        adjLists.resize(2*linkCount, -1);
-        adjListBeg.resize(nodeCount+1, 0);
+        fromNodes.assign(node1, node1 + linkCount);
+        toNodes.assign(node2, node2 + linkCount);
+        adjLists.assign(2*linkCount, -1);
+        adjListBeg.assign(nodeCount+1, 0);
 
         vector<int> degree(nodeCount, 0);
-        for (Link* link : nw->links)
+        for (int k = 0; k < linkCount; k++)
         {
-            degree[link->fromNode->index]++;
-            degree[link->toNode->index]++;
+            degree[node1[k]]++;
+            degree[node2[k]]++;
         }
         adjListBeg[0] = 0;
         for (int i = 0; i < nodeCount; i++)
@@ -60,11 +78,11 @@ void Graph::createAdjLists(Network* nw)
         int m;
         for (int k = 0; k < linkCount; k++)
         {
-            int i = nw->link(k)->fromNode->index;
+            int i = node1[k];
             m = adjListBeg[i] + degree[i];
             adjLists[m] = k;
             degree[i]++;
-            int j = nw->link(k)->toNode->index;
+            int j = node2[k];
             m = adjListBeg[j] + degree[j];
             adjLists[m] = k;
             degree[j]++;
@@ -75,3 +93,303 @@ void Graph::createAdjLists(Network* nw)
         throw;
     }
 }
+
+//-----------------------------------------------------------------------------
+
+//  Finds an order in which nodes with no more than maxDegree neighbours can
+//  be eliminated from the graph. With a maxDegree of 1 this removes the
+//  forest (tree-shaped) part of the graph leaf by leaf; with a maxDegree
+//  of 2 it also removes the interior nodes of chains of links in series,
+//  joining the two ends of each chain with a single reduced link. A
+//  component that can be removed entirely keeps its last node, so what
+//  remains is the looped core plus one root node for each such component.
+
+void Graph::findReduction(int maxDegree, GraphReduction& r)
+{
+    int nodeCount = (int)adjListBeg.size() - 1;
+    int linkCount = (int)fromNodes.size();
+    r.linkMap.assign(linkCount, -1);
+    r.linkNode1.clear();
+    r.linkNode2.clear();
+    r.nodes.clear();
+    r.link1.clear();
+    r.link2.clear();
+    r.fill.clear();
+    if ( nodeCount <= 0 ) return;
+
+    // ... each node's list of (neighbour, reduced link) pairs, with
+    //     parallel links merged; nodes on a self-loop are never eliminated
+
+    vector< vector< pair<int,int> > > nbrs(nodeCount);
+    vector<char> pinned(nodeCount, 0);
+    for (int k = 0; k < linkCount; k++)
+    {
+        int i = fromNodes[k];
+        int j = toNodes[k];
+        if ( i == j )
+        {
+            pinned[i] = 1;
+            continue;
+        }
+        int m = findNeighbour(nbrs[i], j);
+        if ( m < 0 )
+        {
+            m = (int)r.linkNode1.size();
+            r.linkNode1.push_back(i);
+            r.linkNode2.push_back(j);
+            nbrs[i].push_back(make_pair(j, m));
+            nbrs[j].push_back(make_pair(i, m));
+        }
+        r.linkMap[k] = m;
+    }
+
+    // ... start with the nodes that can be eliminated from the original graph
+
+    vector<char> eliminated(nodeCount, 0);
+    vector<int> stack;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        int degree = (int)nbrs[i].size();
+        if ( degree > 0 && degree <= maxDegree ) stack.push_back(i);
+    }
+
+    while ( !stack.empty() )
+    {
+        int i = stack.back();
+        stack.pop_back();
+        int degree = (int)nbrs[i].size();
+        if ( eliminated[i] || pinned[i] || degree == 0 || degree > maxDegree )
+        {
+            continue;
+        }
+        eliminated[i] = 1;
+
+        // ... detach the node from its neighbours
+
+        int p = nbrs[i][0].first;
+        removeNeighbour(nbrs[p], i);
+        r.nodes.push_back(i);
+        r.link1.push_back(nbrs[i][0].second);
+        r.link2.push_back(-1);
+        r.fill.push_back(-1);
+        if ( degree == 2 )
+        {
+            int q = nbrs[i][1].first;
+            removeNeighbour(nbrs[q], i);
+            r.link2.back() = nbrs[i][1].second;
+
+            // ... join the neighbours, merging with any link between them
+
+            int m = findNeighbour(nbrs[p], q);
+            if ( m < 0 )
+            {
+                m = (int)r.linkNode1.size();
+                r.linkNode1.push_back(p);
+                r.linkNode2.push_back(q);
+                nbrs[p].push_back(make_pair(q, m));
+                nbrs[q].push_back(make_pair(p, m));
+            }
+            r.fill.back() = m;
+            if ( (int)nbrs[q].size() <= maxDegree ) stack.push_back(q);
+        }
+        nbrs[i].clear();
+        if ( (int)nbrs[p].size() <= maxDegree ) stack.push_back(p);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Finds a breadth-first spanning tree of the nodes reachable from a root
+//  node. The nodes are returned in order of their distance from the root,
+//  along with the link joining each one to its parent in the tree (which is
+//  -1 for the root and for nodes that can't be reached).
+
+void Graph::findSpanningTree(int root, vector<int>& order, vector<int>& parentLink)
+{
+    int nodeCount = (int)adjListBeg.size() - 1;
+    order.clear();
+    parentLink.assign(nodeCount, -1);
+    if ( root < 0 || root >= nodeCount ) return;
+
+    vector<char> visited(nodeCount, 0);
+    visited[root] = 1;
+    order.push_back(root);
+    for (size_t m = 0; m < order.size(); m++)
+    {
+        int i = order[m];
+        for (int n = adjListBeg[i]; n < adjListBeg[i+1]; n++)
+        {
+            int k = adjLists[n];
+            int j = fromNodes[k] == i ? toNodes[k] : fromNodes[k];
+            if ( visited[j] ) continue;
+            visited[j] = 1;
+            parentLink[j] = k;
+            order.push_back(j);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Labels the connected components of the graph formed by the open links.
+
+void Graph::findComponents(const vector<char>& open)
+{
+    int nodeCount = (int)adjListBeg.size() - 1;
+    linkOpen = open;
+    components.assign(nodeCount, -1);
+    componentSize.clear();
+    freeLabels.clear();
+    visitMark.assign(nodeCount, 0);
+    searchCount = 0;
+    for (int i = 0; i < nodeCount; i++)
+    {
+        if ( components[i] < 0 ) relabel(i, newLabel());
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Opens link k, merging the components of its end nodes by relabeling the
+//  smaller of the two.
+
+void Graph::openLink(int k)
+{
+    if ( linkOpen[k] ) return;
+    linkOpen[k] = 1;
+    int c1 = components[fromNodes[k]];
+    int c2 = components[toNodes[k]];
+    if ( c1 == c2 ) return;
+    if ( componentSize[c1] < componentSize[c2] ) relabel(fromNodes[k], c2);
+    else relabel(toNodes[k], c1);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Closes link k. The open links are searched outward from both of its end
+//  nodes in step with each other until the searches meet, in which case the
+//  component is still connected, or until one of them runs out of nodes,
+//  which then form a new component. The work done is proportional to the
+//  size of the smaller part.
+
+void Graph::closeLink(int k)
+{
+    if ( !linkOpen[k] ) return;
+    linkOpen[k] = 0;
+    int a = fromNodes[k];
+    int b = toNodes[k];
+    if ( a == b ) return;
+
+    searchCount += 2;
+    int mark[2] = {searchCount - 1, searchCount};
+    vector<int> queue[2];
+    size_t next[2] = {0, 0};
+    queue[0].push_back(a);
+    queue[1].push_back(b);
+    visitMark[a] = mark[0];
+    visitMark[b] = mark[1];
+
+    for (int side = 0; ; side = 1 - side)
+    {
+        // ... this side's search is exhausted, so its nodes are split off
+
+        if ( next[side] == queue[side].size() )
+        {
+            int oldLabel = components[a];
+            int label = newLabel();
+            int size = (int)queue[side].size();
+            for (int i : queue[side]) components[i] = label;
+            componentSize[label] = size;
+            componentSize[oldLabel] -= size;
+            return;
+        }
+
+        // ... visit the neighbours of the next node in this side's queue
+
+        int i = queue[side][next[side]++];
+        for (int n = adjListBeg[i]; n < adjListBeg[i+1]; n++)
+        {
+            int m = adjLists[n];
+            if ( !linkOpen[m] ) continue;
+            int j = fromNodes[m] == i ? toNodes[m] : fromNodes[m];
+            if ( visitMark[j] == mark[side] ) continue;
+            if ( visitMark[j] == mark[1 - side] ) return;
+            visitMark[j] = mark[side];
+            queue[side].push_back(j);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Returns an unused component label.
+
+int Graph::newLabel()
+{
+    if ( freeLabels.empty() )
+    {
+        componentSize.push_back(0);
+        return (int)componentSize.size() - 1;
+    }
+    int label = freeLabels.back();
+    freeLabels.pop_back();
+    return label;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Gives a new label to all nodes joined to a start node by open links,
+//  freeing their old label once it is no longer used.
+
+void Graph::relabel(int start, int label)
+{
+    int oldLabel = components[start];
+    vector<int> queue(1, start);
+    components[start] = label;
+    for (size_t m = 0; m < queue.size(); m++)
+    {
+        int i = queue[m];
+        for (int n = adjListBeg[i]; n < adjListBeg[i+1]; n++)
+        {
+            int k = adjLists[n];
+            if ( !linkOpen[k] ) continue;
+            int j = fromNodes[k] == i ? toNodes[k] : fromNodes[k];
+            if ( components[j] == label ) continue;
+            components[j] = label;
+            queue.push_back(j);
+        }
+    }
+    componentSize[label] += (int)queue.size();
+    if ( oldLabel >= 0 )
+    {
+        componentSize[oldLabel] -= (int)queue.size();
+        if ( componentSize[oldLabel] == 0 ) freeLabels.push_back(oldLabel);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+//  Returns the reduced link joining a node to neighbour j in its list of
+//  (neighbour, reduced link) pairs, or -1 if there is none.
+
+int Graph::findNeighbour(vector< pair<int,int> >& nbrList, int j)
+{
+    for (pair<int,int>& nbr : nbrList)
+    {
+        if ( nbr.first == j ) return nbr.second;
+    }
+    return -1;
+}
+
+void Graph::removeNeighbour(vector< pair<int,int> >& nbrList, int j)
+{
+    for (size_t m = 0; m < nbrList.size(); m++)
+    {
+        if ( nbrList[m].first == j )
+        {
+            nbrList[m] = nbrList.back();
+            nbrList.pop_back();
+            return;
+        }
+    }
+}
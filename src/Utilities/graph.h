@@ -19,9 +19,29 @@
 //! a pipe network.
 
 #include <vector>
+#include <utility>
 
 class Network;
 
+//! \struct GraphReduction
+//! \brief Records the order in which Graph::findReduction eliminates nodes.
+//!
+//! Links joining the same pair of nodes are merged into a single reduced
+//! link. Each eliminated node is joined to at most two remaining neighbours
+//! and, when it has two, eliminating it joins them through a fill link
+//! (an existing reduced link between them or a new one).
+
+struct GraphReduction
+{
+    std::vector<int> linkMap;      //!< reduced link of each original link
+    std::vector<int> linkNode1;    //!< start node of each reduced link
+    std::vector<int> linkNode2;    //!< end node of each reduced link
+    std::vector<int> nodes;        //!< eliminated nodes in order
+    std::vector<int> link1;        //!< reduced link to first neighbour (or -1)
+    std::vector<int> link2;        //!< reduced link to second neighbour (or -1)
+    std::vector<int> fill;         //!< reduced link joining the neighbours (or -1)
+};
+
 class Graph
 {
   public:
@@ -30,10 +50,38 @@ class Graph
     ~Graph();
 
     void    createAdjLists(Network* nw);
+    void    createAdjLists(int nodeCount, int linkCount, int node1[], int node2[]);
+    void    findReduction(int maxDegree, GraphReduction& r);
+    void    findSpanningTree(int root, std::vector<int>& order,
+                             std::vector<int>& parentLink);
+
+    // Connected components of the open links, kept up to date as
+    // individual links are opened or closed
+    void    findComponents(const std::vector<char>& linkOpen);
+    void    openLink(int k);
+    void    closeLink(int k);
+    bool    isOpen(int k) { return linkOpen[k] != 0; }
+    int     component(int i) { return components[i]; }
+    int     componentLimit() { return (int)componentSize.size(); }
+    bool    hasComponents() { return !components.empty(); }
 
   private:
     std::vector<int> adjLists;        // packed nodal adjacency lists
     std::vector<int> adjListBeg;      // starting index of each node's list
+    std::vector<int> fromNodes;       // start node of each link
+    std::vector<int> toNodes;         // end node of each link
+
+    std::vector<char> linkOpen;       // true if a link joins its end nodes
+    std::vector<int> components;      // component label of each node
+    std::vector<int> componentSize;   // number of nodes with each label
+    std::vector<int> freeLabels;      // labels not in use
+    std::vector<int> visitMark;       // search in which a node was visited
+    int              searchCount;     // number of searches made
+
+    int     findNeighbour(std::vector< std::pair<int,int> >& nbrList, int j);
+    void    removeNeighbour(std::vector< std::pair<int,int> >& nbrList, int j);
+    int     newLabel();
+    void    relabel(int start, int label);
 };
 
 #endif // GRAPH_H_
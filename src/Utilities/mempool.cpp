@@ -5,133 +5,205 @@
  *
  */
 
-/*
-**  This code is based on "A simple fast memory allocation package"
-**  by Steve Hill in Graphics Gems III, David Kirk (ed.),
-**  Academic Press, Boston, MA, 1992
-*/
-
 #include "mempool.h"
 
-/*
-**  ALLOC_BLOCK_SIZE - adjust this size to suit your installation - it
-**  should be reasonably large otherwise you will be mallocing a lot.
-*/
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+//  Size of a standard block and of a block backed by huge pages
 
-#define ALLOC_BLOCK_SIZE   64000       /*(62*1024)*/
+static const size_t BLOCK_SIZE = 64 * 1024;
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
 
 struct MemBlock
 {
-    struct MemBlock *next;   /* Next Block          */
-    char            *block,  /* Start of block      */
-                    *free,   /* Next free in block  */
-                    *end;    /* block + block size  */
+    MemBlock* next;     // next block
+    char*     raw;      // memory allocated for the block
+    char*     block;    // start of block (cache line aligned)
+    char*     free;     // next free byte in block
+    char*     end;      // block + block size
+    bool      huge;     // true if backed by huge pages
 };
 
-static struct MemBlock* createMemBlock()
+//-----------------------------------------------------------------------------
+
+//  Size classes are 16, 32 and 64 bytes followed by multiples of 64 bytes.
+
+static size_t sizeClass(size_t size)
 {
-    struct MemBlock* memBlock = new struct MemBlock;
-    if (memBlock)
-    {
-        memBlock->block = new char[ALLOC_BLOCK_SIZE];
-        if (memBlock->block == nullptr)
-        {
-            delete memBlock;
-            return nullptr;
-        }
-        memBlock->free = memBlock->block;
-        memBlock->next = nullptr;
-        memBlock->end = memBlock->block + ALLOC_BLOCK_SIZE;
-    }
-    return memBlock;
+    if ( size <= 16 ) return 0;
+    if ( size <= 32 ) return 1;
+    return (size + MemPool::ALIGNMENT - 1) / MemPool::ALIGNMENT + 1;
 }
 
-static void deleteMemBlock(struct MemBlock* memBlock)
+static size_t classSize(size_t c)
 {
-    delete [] memBlock->block;
-    delete memBlock;
+    if ( c < 2 ) return 16 << c;
+    return (c - 1) * MemPool::ALIGNMENT;
+}
+
+static char* alignUp(char* p, size_t align)
+{
+    uintptr_t a = (uintptr_t)p;
+    a = (a + align - 1) & ~(uintptr_t)(align - 1);
+    return (char*)a;
 }
 
+//-----------------------------------------------------------------------------
 
-// MemPool Constructor
+//  Constructor/Destructor
 
-MemPool::MemPool()
+MemPool::MemPool(bool hugePages_) :
+    first(nullptr),
+    current(nullptr),
+    hugePages(hugePages_),
+    blockSize(hugePages_ ? HUGE_PAGE_SIZE : BLOCK_SIZE)
 {
-    first = createMemBlock();
+    poolStats.bytesLive = 0;
+    poolStats.bytesPeak = 0;
+    poolStats.bytesReserved = 0;
+    poolStats.blockCount = 0;
+    first = createBlock(blockSize);
     current = first;
 }
 
-
-// MemPool Destructor
-
 MemPool::~MemPool()
 {
     while (first)
     {
         current = first->next;
-        deleteMemBlock(first);
+        deleteBlock(first);
         first = current;
     }
 }
 
-/*
-**  alloc()
-**
-**  Use as a direct replacement for malloc().  Allocates
-**  memory from the current pool.
-*/
-char* MemPool::alloc(std::size_t size)
-{
-    /*
-    **  Align to 4 byte boundary - should be ok for most machines.
-    **  Change this if your machine has weird alignment requirements.
-    */
-    size = (size + 3) & 0xfffffffc;
+//-----------------------------------------------------------------------------
+
+//  Allocates memory for an object of a given size, reusing a released
+//  object of the same size class if there is one.
 
-    if (!current) return nullptr;
-    char* ptr = current->free;
-    current->free += size;
+char* MemPool::alloc(size_t size)
+{
+    size_t c = sizeClass(size);
+    size = classSize(c);
+    char* ptr;
 
-    /* Check if the current block is exhausted. */
+    // ... reuse a released object
 
-    if (current->free >= current->end)
+    if ( c < freeLists.size() && freeLists[c] )
     {
-        /* Is the next block already allocated? */
+        ptr = (char*)freeLists[c];
+        freeLists[c] = *(void**)ptr;
+    }
 
-        if (current->next)
-        {
-            /* re-use block */
-            current->next->free = current->next->block;
-            current = current->next;
-        }
-        else
+    // ... otherwise carve a new one from the current block, moving on to
+    //     the next block (re-using one left over from a reset or adding a
+    //     new one) if it won't fit
+
+    else
+    {
+        if ( !current ) return nullptr;
+        size_t align = size < ALIGNMENT ? size : ALIGNMENT;
+        ptr = alignUp(current->free, align);
+        while ( ptr + size > current->end )
         {
-            /* extend the pool with a new block */
-            current->next = createMemBlock();
-            if (!current->next) return nullptr;
-            current = current->next;
+            if ( current->next )
+            {
+                current = current->next;
+                current->free = current->block;
+            }
+            else
+            {
+                current->next = createBlock(max(size, blockSize));
+                if ( !current->next ) return nullptr;
+                current = current->next;
+            }
+            ptr = current->block;
         }
-
-        /* set ptr to the first location in the next block */
-
-        ptr = current->free;
-        current->free += size;
+        current->free = ptr + size;
     }
 
-    /* Return pointer to allocated memory. */
+    // ... update statistics
 
+    poolStats.bytesLive += size;
+    poolStats.bytesPeak = max(poolStats.bytesPeak, poolStats.bytesLive);
     return ptr;
 }
 
-/*
-**  reset()
-**
-**  Reset the current pool for re-use.  No memory is freed,
-**  so this is very fast.
-*/
+//-----------------------------------------------------------------------------
+
+//  Returns an object of a given size to the free list of its size class.
+
+void MemPool::release(void* ptr, size_t size)
+{
+    if ( !ptr ) return;
+    size_t c = sizeClass(size);
+    if ( c >= freeLists.size() ) freeLists.resize(c + 1, nullptr);
+    *(void**)ptr = freeLists[c];
+    freeLists[c] = ptr;
+    poolStats.bytesLive -= classSize(c);
+}
+
+//-----------------------------------------------------------------------------
+
+//  Resets the pool for re-use. No memory is freed, so this is very fast.
 
-void  MemPool::reset()
+void MemPool::reset()
 {
     current = first;
-    current->free = current->block;
+    if ( current ) current->free = current->block;
+    freeLists.assign(freeLists.size(), nullptr);
+    poolStats.bytesLive = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+//  Creates a block of a given size whose start is cache line aligned.
+
+MemBlock* MemPool::createBlock(size_t size)
+{
+    MemBlock* memBlock = new MemBlock;
+    memBlock->next = nullptr;
+    memBlock->raw = nullptr;
+    memBlock->huge = false;
+
+#ifdef __linux__
+    if ( hugePages )
+    {
+        size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* p = nullptr;
+        if ( posix_memalign(&p, HUGE_PAGE_SIZE, size) == 0 )
+        {
+            madvise(p, size, MADV_HUGEPAGE);
+            memBlock->raw = (char*)p;
+            memBlock->block = memBlock->raw;
+            memBlock->huge = true;
+        }
+    }
+#endif
+
+    if ( !memBlock->raw )
+    {
+        memBlock->raw = new char[size + ALIGNMENT];
+        memBlock->block = alignUp(memBlock->raw, ALIGNMENT);
+    }
+    memBlock->free = memBlock->block;
+    memBlock->end = memBlock->block + size;
+    poolStats.bytesReserved += size;
+    poolStats.blockCount++;
+    return memBlock;
+}
+
+void MemPool::deleteBlock(MemBlock* memBlock)
+{
+    if ( memBlock->huge ) std::free(memBlock->raw);
+    else delete [] memBlock->raw;
+    delete memBlock;
 }
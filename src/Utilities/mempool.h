@@ -12,23 +12,56 @@
 #define MEMPOOL_H_
 
 #include <cstddef>
+#include <vector>
 
 struct MemBlock;
 
 //! \class MemPool
-//! \brief A simple pooled memory allocator.
+//! \brief A pooled memory allocator with cache line aligned size classes.
+//!
+//! Memory is carved in creation order from large blocks whose start is
+//! aligned to a cache line, so objects created one after another (such as
+//! the junctions read from an input file) lie next to each other in index
+//! order. Requests are rounded up to a size class: 16, 32 or 64 bytes for
+//! small objects, so that none of them straddles a cache line, and a whole
+//! number of cache lines for larger ones, which then start on a cache line.
+//! Objects handed back with release() are kept on a free list for their
+//! size class and reused before new memory is carved. Blocks can optionally
+//! be backed by huge pages where the operating system supports them (see
+//! EN_setHugePages).
 
 class MemPool
 {
   public:
-    MemPool();
+
+    static const std::size_t ALIGNMENT = 64;   //!< cache line size (bytes)
+
+    struct Stats
+    {
+        std::size_t bytesLive;      //!< bytes in objects not yet released
+        std::size_t bytesPeak;      //!< largest value bytesLive has reached
+        std::size_t bytesReserved;  //!< bytes in all blocks
+        int         blockCount;     //!< number of blocks
+    };
+
+    MemPool(bool hugePages = false);
     ~MemPool();
-    char* alloc(std::size_t size);
-    void  reset();
+    char*        alloc(std::size_t size);
+    void         release(void* ptr, std::size_t size);
+    void         reset();
+    bool         usesHugePages() { return hugePages; }
+    const Stats& stats() { return poolStats; }
 
   private:
-    MemBlock* first;
-    MemBlock* current;
+    MemBlock*          first;       // first block in the pool
+    MemBlock*          current;     // block being carved
+    bool               hugePages;   // true if blocks use huge pages
+    std::size_t        blockSize;   // size of a standard block (bytes)
+    std::vector<void*> freeLists;   // first released object of each size class
+    Stats              poolStats;   // allocation statistics
+
+    MemBlock*   createBlock(std::size_t size);
+    void        deleteBlock(MemBlock* block);
 };
 
 #endif
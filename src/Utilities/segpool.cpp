@@ -9,61 +9,50 @@
 #include "Utilities/mempool.h"
 
 #include <iostream>
+#include <cstring>
 
 using namespace std;
 
 //-----------------------------------------------------------------------------
 
-SegPool::SegPool()
+SegPool::SegPool(bool hugePages) :
+    segWidth(1),
+    segSize(SegConcOffset + sizeof(double))
 {
-    memPool = new MemPool();
-    freeSeg = nullptr;
-    segCount = 0;
+    memPool = new MemPool(hugePages);
 }
 
 //-----------------------------------------------------------------------------
 
 SegPool::~SegPool()
 {
-//    cout << "\n segCount = " << segCount << "\n";
-
     delete memPool;
 }
 
 //-----------------------------------------------------------------------------
 
-void SegPool::init()
+//  Empties the pool and sets the number of quantities in its segments.
+
+void SegPool::init(int width)
 {
-    segCount = 0;
     memPool->reset();
-    freeSeg = nullptr;
+    segWidth = width < 1 ? 1 : width;
+    segSize = SegConcOffset + segWidth * sizeof(double);
 }
 
 //-----------------------------------------------------------------------------
 
-Segment* SegPool::getSegment(double v, double c)
+Segment* SegPool::getSegment(double v, const double* c)
 {
-    // ... if there's a free segment available then use it
-    Segment* seg;
-    if ( freeSeg )
-    {
-       seg = freeSeg;
-       freeSeg = seg->next;
-    }
-
-    // ... otherwise create a new one from the memory pool
-    else
-    {
-        seg = (Segment *) memPool->alloc(sizeof(Segment));
-        segCount++;
-    }
+    // ... the memory pool re-uses a freed segment if there is one
+    Segment* seg = (Segment *) memPool->alloc(segSize);
 
     // ... assign segment's volume and quality
     if ( seg )
     {
         seg->v = v;
-        seg->c = c;
         seg->next = nullptr;
+        memcpy(seg->conc(), c, segWidth * sizeof(double));
     }
     return seg;
 }
@@ -72,6 +61,5 @@ Segment* SegPool::getSegment(double v, double c)
 
 void SegPool::freeSegment(Segment* seg)
 {
-    seg->next = freeSeg;
-    freeSeg = seg;
+    memPool->release(seg, segSize);
 }
@@ -11,28 +11,55 @@
 #ifndef SEGPOOL_H_
 #define SEGPOOL_H_
 
-class MemPool;
+#include "Utilities/mempool.h"
+
+#include <cstddef>
 
 struct  Segment              //!< Volume segment
 {
    double  v;                //!< volume (ft3)
-   double  c;                //!< constituent concentration (mass/ft3)
    struct  Segment* next;    //!< next upstream volume segment
+
+   //! Concentrations (mass/ft3) of all the quantities carried by the
+   //! segment. They are stored in the segment's allocation right after
+   //! the volume and link, starting with the quality model's constituent.
+   double* conc();
+
+   //! Concentration of the quality model's constituent.
+   double& c() { return conc()[0]; }
 };
 
+//! Offset of a segment's concentrations from its start (bytes).
+const std::size_t SegConcOffset =
+    (sizeof(Segment) + alignof(double) - 1) / alignof(double) * alignof(double);
+
+inline double* Segment::conc()
+{
+    return reinterpret_cast<double*>(reinterpret_cast<char*>(this) + SegConcOffset);
+}
+
+//! \class SegPool
+//! \brief Allocates the volume segments used by the Lagrangian quality
+//!        solver and the tank mixing models from a MemPool, which also
+//!        recycles the segments they free.
+//!
+//! Every segment carries the same number (the pool's width) of quantities.
+
 class SegPool
 {
   public:
-    SegPool();
+    SegPool(bool hugePages = false);
     ~SegPool();
-    void init();
-    Segment* getSegment(double v, double c);
+    void init(int width = 1);
+    int  width() { return segWidth; }
+    Segment* getSegment(double v, const double* c);
     void     freeSegment(Segment* seg);
+    const MemPool::Stats& stats() { return memPool->stats(); }
 
   private:
-	int        segCount;     // number of volume segments allocated
-	Segment*   freeSeg;      // first unused segment
-	MemPool*   memPool;      // memory pool for volume segments
+	MemPool*    memPool;      // memory pool for volume segments
+	int         segWidth;     // number of quantities in a segment
+	std::size_t segSize;      // size of a segment (bytes)
 };
 
 #endif // SEGPOOL_H_
@@ -65,7 +65,15 @@ enum LinkParams {
     EN_LINKQUAL,     //14
     EN_LEAKCOEFF1,   //15
     EN_LEAKCOEFF2,   //16
-    EN_LEAKAGE};     //17
+    EN_LEAKAGE,      //17
+    EN_PMTYPE,       //18
+    EN_PMFIXEDPRES,  //19
+    EN_PMDAYPRES,    //20
+    EN_PMNIGHTPRES,  //21
+    EN_PMCOEFFA,     //22
+    EN_PMCOEFFB,     //23
+    EN_PMCOEFFC,     //24
+    EN_PMREMOTEPRES};//25
 
 enum TimeParams {
     EN_DURATION,     //0
@@ -88,7 +96,46 @@ enum ElementCounts {
     EN_CURVECOUNT,   //4
     EN_CONTROLCOUNT, //5
     EN_RULECOUNT,    //6
-    EN_RESVCOUNT};   //7
+    EN_RESVCOUNT,    //7
+    EN_ZONECOUNT,    //8
+    EN_SPECIESCOUNT};//9
+
+enum ZoneParams {
+    EN_SUPPLYVOL,    //0
+    EN_TRANSFERVOL,  //1
+    EN_DEMANDVOL,    //2
+    EN_EMITTERVOL,   //3
+    EN_LEAKAGEVOL,   //4
+    EN_STORAGEVOL,   //5
+    EN_SUPPLYRATE,   //6
+    EN_TRANSFERRATE, //7
+    EN_DEMANDRATE,   //8
+    EN_EMITTERRATE,  //9
+    EN_LEAKAGERATE,  //10
+    EN_STORAGERATE}; //11
+
+enum SolverStatTypes {
+    EN_ASSEMBLYTIME,     //0
+    EN_FACTORTIME,       //1
+    EN_SOLVETIME,        //2
+    EN_HEADLOSSTIME,     //3
+    EN_ERRORNORMTIME,    //4
+    EN_CONTROLTIME,      //5
+    EN_QUALITYTIME,      //6
+    EN_OUTPUTTIME,       //7
+    EN_HYDPERIODS,       //8
+    EN_TOTALTRIALS,      //9
+    EN_MAXTRIALS,        //10
+    EN_STEPSIZEEVALS,    //11
+    EN_ERRORNORMEVALS,   //12
+    EN_STATUSCHANGES,    //13
+    EN_FACTORIZATIONS,   //14
+    EN_NETBYTESLIVE,     //15
+    EN_NETBYTESPEAK,     //16
+    EN_NETBLOCKS,        //17
+    EN_SEGBYTESLIVE,     //18
+    EN_SEGBYTESPEAK,     //19
+    EN_SEGBLOCKS};       //20
 
 enum NodeTypes {
     EN_JUNCTION,     //0
@@ -166,6 +213,45 @@ enum InitFlowTypes {
     EN_NOINITFLOW,   //0
     EN_INITFLOW};    //1
 
+enum OutputNodeVars {
+    EN_OUT_HEAD,     //0
+    EN_OUT_PRESSURE, //1
+    EN_OUT_DEMAND,   //2
+    EN_OUT_DEFICIT,  //3
+    EN_OUT_OUTFLOW,  //4
+    EN_OUT_NODEQUAL};//5
+
+enum OutputLinkVars {
+    EN_OUT_FLOW,     //0
+    EN_OUT_LEAKAGE,  //1
+    EN_OUT_VELOCITY, //2
+    EN_OUT_HEADLOSS, //3
+    EN_OUT_STATUS,   //4
+    EN_OUT_SETTING,  //5
+    EN_OUT_LINKQUAL};//6
+
+enum HydFileModes {
+    EN_SCRATCH,        //0
+    EN_USE,            //1
+    EN_SAVE};          //2
+
+enum ResultStatVars {
+    EN_STAT_PRESSURE,  //0
+    EN_STAT_QUALITY,   //1
+    EN_STAT_FLOW,      //2
+    EN_STAT_VELOCITY,  //3
+    EN_STAT_LEAKAGE};  //4
+
+enum ResultStatValues {
+    EN_STATCOUNT,      //0
+    EN_STATMIN,        //1
+    EN_STATMAX,        //2
+    EN_STATMEAN,       //3
+    EN_STATSTDDEV,     //4
+    EN_STATTIMEBELOW,  //5
+    EN_STATTIMEABOVE,  //6
+    EN_STATQUANTILE};  //7 (+k for the k-th quantile)
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -186,9 +272,24 @@ int        EN_clearProject(EN_Project p);
 int        EN_initSolver(int initFlows, EN_Project p);
 int        EN_runSolver(int* t, EN_Project p);
 int        EN_advanceSolver(int* dt, EN_Project p);
+int        EN_saveState(EN_Project p);
+int        EN_restoreState(EN_Project p);
+
+int        EN_createScenario(const char* name, int* index, EN_Project p);
+int        EN_setScenarioLinkValue(int scenario, int link, int param,
+                                   double value, EN_Project p);
+int        EN_selectScenario(int scenario, EN_Project p);
+int        EN_openScenarioOutputFile(int scenario, const char* fname,
+                                     EN_Project p);
 
+int        EN_setHydFile(const char* fname, int mode, EN_Project p);
 int        EN_openOutputFile(const char* fname, EN_Project p);
 int        EN_saveOutput(EN_Project p);
+int        EN_recordNode(int index, EN_Project p);
+int        EN_recordLink(int index, EN_Project p);
+int        EN_recordNodeVariable(int var, int interval, EN_Project p);
+int        EN_recordLinkVariable(int var, int interval, EN_Project p);
+int        EN_clearRecordPlan(EN_Project p);
 
 int        EN_openReportFile(const char* fname, EN_Project p);
 int        EN_writeReport(EN_Project p);
@@ -209,6 +310,24 @@ int        EN_getLinkNodes(int, int *, int *, EN_Project);
 int        EN_getLinkValue(int, int, double *, EN_Project);
 int		   EN_setLinkValue(int, int, double, EN_Project);
 
+int        EN_getZoneIndex(char *, int *, EN_Project);
+int        EN_getZoneId(int, char *, EN_Project);
+int        EN_getZoneValue(int, int, double *, EN_Project);
+
+int        EN_getSpeciesIndex(char *, int *, EN_Project);
+int        EN_getSpeciesId(int, char *, EN_Project);
+int        EN_getNodeSpecies(int, int, double *, EN_Project);
+int        EN_getLinkSpecies(int, int, double *, EN_Project);
+
+int        EN_getStatistics(int, double *, EN_Project);
+int        EN_setHugePages(int enabled, EN_Project p);
+
+int        EN_setResultStats(int enabled, EN_Project p);
+int        EN_setStatQuantiles(int count, double* fractions, EN_Project p);
+int        EN_setStatLimits(int var, double lower, double upper, EN_Project p);
+int        EN_getStatValue(int var, int index, int stat, double* value,
+                           EN_Project p);
+
 
 //==================================================================================
 /*        TO BE ADDED
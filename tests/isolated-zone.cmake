@@ -0,0 +1,40 @@
+# Checks the report of tests/isolated-zone.inp: while valve V1 is closed
+# (hours 0 and 1) junctions J2-J4 must have no head or pressure and pipes
+# P2-P4 no flow; once it opens (hours 2 on) their heads must be reported.
+#
+# Usage: cmake -DREPORT=<report file> -P isolated-zone.cmake
+
+file(STRINGS ${REPORT} lines)
+set(hour "")
+set(checked 0)
+foreach(line IN LISTS lines)
+    if(line MATCHES "(Node|Link) Results at ([0-9]+):")
+        set(hour ${CMAKE_MATCH_2})
+    elseif(hour STREQUAL "")
+        continue()
+    elseif(line MATCHES "^  (J[2-4]) ")
+        set(node ${CMAKE_MATCH_1})
+        # ... demand, deficit and outflow are the only fields of an
+        #     isolated node
+        if(line MATCHES "^  J[2-4] +[-0-9.]+ +[-0-9.]+ +[-0-9.]+$")
+            set(isolated TRUE)
+        else()
+            set(isolated FALSE)
+        endif()
+        if(hour LESS 2 AND NOT isolated)
+            message(FATAL_ERROR "${node} has a head at hour ${hour}: ${line}")
+        elseif(NOT hour LESS 2 AND isolated)
+            message(FATAL_ERROR "${node} has no head at hour ${hour}: ${line}")
+        endif()
+        math(EXPR checked "${checked} + 1")
+    elseif(line MATCHES "^  (P[2-4]) +([-0-9.]+) ")
+        if(hour LESS 2 AND NOT CMAKE_MATCH_2 STREQUAL "0.000")
+            message(FATAL_ERROR "${CMAKE_MATCH_1} has flow at hour ${hour}: ${line}")
+        endif()
+        math(EXPR checked "${checked} + 1")
+    endif()
+endforeach()
+
+if(checked EQUAL 0)
+    message(FATAL_ERROR "No node or link results found in ${REPORT}")
+endif()